@@ -72,6 +72,7 @@ ifeq ($(strip $(AUDIO_ENABLE)), yes)
     SRC += $(PLATFORM_PATH)/$(PLATFORM_KEY)/$(DRIVER_DIR)/audio_$(strip $(AUDIO_DRIVER)).c
     SRC += $(QUANTUM_DIR)/audio/voices.c
     SRC += $(QUANTUM_DIR)/audio/luts.c
+    SRC += $(QUANTUM_DIR)/audio/synth.c
 endif
 
 ifeq ($(strip $(SEQUENCER_ENABLE)), yes)
@@ -156,7 +157,7 @@ ifeq ($(filter $(EEPROM_DRIVER),$(VALID_EEPROM_DRIVER_TYPES)),)
 else
   OPT_DEFS += -DEEPROM_ENABLE
   ifeq ($(strip $(EEPROM_DRIVER)), custom)
-    # Custom EEPROM implementation -- only needs to implement init/erase/read_block/write_block
+    # Custom EEPROM implementation -- only needs to implement init/erase/driver_read_block/driver_write_block
     OPT_DEFS += -DEEPROM_DRIVER -DEEPROM_CUSTOM
     COMMON_VPATH += $(DRIVER_PATH)/eeprom
     SRC += eeprom_driver.c
@@ -219,6 +220,15 @@ else
   endif
 endif
 
+EEPROM_WRITE_CACHE_ENABLE ?= no
+ifeq ($(strip $(EEPROM_WRITE_CACHE_ENABLE)), yes)
+  # RAM write-back cache, only available in front of the eeprom_driver.c based implementations
+  ifneq ($(filter -DEEPROM_DRIVER,$(OPT_DEFS)),)
+    OPT_DEFS += -DEEPROM_WRITE_CACHE_ENABLE
+    DEFERRED_EXEC_ENABLE := yes
+  endif
+endif
+
 VALID_FLASH_DRIVER_TYPES := spi
 FLASH_DRIVER ?= no
 ifneq ($(strip $(FLASH_DRIVER)), no)
@@ -302,6 +312,7 @@ endif
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3742A -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
         SRC += is31flcommon.c
+        SRC += is31fl_queue.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
 
@@ -309,6 +320,7 @@ endif
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3743A -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
         SRC += is31flcommon.c
+        SRC += is31fl_queue.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
 
@@ -316,6 +328,7 @@ endif
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3745 -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
         SRC += is31flcommon.c
+        SRC += is31fl_queue.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
 
@@ -323,6 +336,7 @@ endif
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3746A -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
         SRC += is31flcommon.c
+        SRC += is31fl_queue.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
 
@@ -368,6 +382,7 @@ endif
         OPT_DEFS += -DIS31FL3733 -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
         SRC += is31fl3733.c
+        SRC += is31fl_queue.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
 
@@ -389,6 +404,7 @@ endif
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3742A -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
         SRC += is31flcommon.c
+        SRC += is31fl_queue.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
 
@@ -396,6 +412,7 @@ endif
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3743A -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
         SRC += is31flcommon.c
+        SRC += is31fl_queue.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
 
@@ -403,6 +420,7 @@ endif
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3745 -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
         SRC += is31flcommon.c
+        SRC += is31fl_queue.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
 
@@ -410,6 +428,7 @@ endif
         OPT_DEFS += -DIS31FLCOMMON -DIS31FL3746A -DSTM32_I2C -DHAL_USE_I2C=TRUE
         COMMON_VPATH += $(DRIVER_PATH)/led/issi
         SRC += is31flcommon.c
+        SRC += is31fl_queue.c
         QUANTUM_LIB_SRC += i2c_master.c
     endif
 
@@ -495,7 +514,7 @@ ifeq ($(strip $(BACKLIGHT_ENABLE)), yes)
     endif
 endif
 
-VALID_WS2812_DRIVER_TYPES := bitbang pwm spi i2c
+VALID_WS2812_DRIVER_TYPES := bitbang gpio_dma pwm spi i2c
 
 WS2812_DRIVER ?= bitbang
 ifeq ($(strip $(WS2812_DRIVER_REQUIRED)), yes)
@@ -511,7 +530,7 @@ ifeq ($(strip $(WS2812_DRIVER_REQUIRED)), yes)
         SRC += ws2812_$(strip $(WS2812_DRIVER)).c
 
         ifeq ($(strip $(PLATFORM)), CHIBIOS)
-            ifeq ($(strip $(WS2812_DRIVER)), pwm)
+            ifneq ($(filter $(strip $(WS2812_DRIVER)),pwm gpio_dma),)
                 OPT_DEFS += -DSTM32_DMA_REQUIRED=TRUE
             endif
         endif
@@ -621,6 +640,12 @@ ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
         else
             QUANTUM_LIB_SRC += serial_$(strip $(SERIAL_DRIVER)).c
         endif
+        ifeq ($(strip $(SERIAL_DRIVER)), usart)
+            QUANTUM_LIB_SRC += serial_usart_link.c
+        endif
+        ifneq ($(filter usart usart_duplex,$(strip $(SERIAL_DRIVER))),)
+            QUANTUM_LIB_SRC += serial_usart_init.c
+        endif
     endif
     COMMON_VPATH += $(QUANTUM_PATH)/split_common
 endif
@@ -628,6 +653,10 @@ endif
 ifeq ($(strip $(CRC_ENABLE)), yes)
     OPT_DEFS += -DCRC_ENABLE
     SRC += crc.c
+    ifeq ($(PLATFORM),CHIBIOS)
+        # Hardware CRC unit, falls back to crc.c where not available
+        SRC += crc_stm32.c
+    endif
 endif
 
 ifeq ($(strip $(HAPTIC_ENABLE)),yes)
@@ -663,6 +692,7 @@ ifeq ($(strip $(OLED_ENABLE)), yes)
         ifeq ($(strip $(OLED_DRIVER)), SSD1306)
             SRC += ssd1306_sh1106.c
             QUANTUM_LIB_SRC += i2c_master.c
+            MONO_SURFACE_REQUIRED := yes
         endif
     endif
 endif
@@ -673,6 +703,11 @@ ifeq ($(strip $(ST7565_ENABLE)), yes)
     COMMON_VPATH += $(DRIVER_PATH)/lcd
     QUANTUM_LIB_SRC += spi_master.c
     SRC += st7565.c
+    MONO_SURFACE_REQUIRED := yes
+endif
+
+ifeq ($(strip $(MONO_SURFACE_REQUIRED)), yes)
+    SRC += mono_surface.c mono_rle.c
 endif
 
 ifeq ($(strip $(UCIS_ENABLE)), yes)
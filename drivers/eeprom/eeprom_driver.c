@@ -15,9 +15,268 @@
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 
 #include "eeprom_driver.h"
+#if defined(EEPROM_WRITE_CACHE_ENABLE)
+#    include "timer.h"
+#    include "deferred_exec.h"
+#endif
+
+/* Background housekeeping, for drivers which need it */
+__attribute__((weak)) void eeprom_driver_backend_task(void) {}
+
+#if defined(EEPROM_CUSTOM)
+/*
+ * Custom drivers written before the eeprom_driver_* hooks existed implement
+ * eeprom_read_block() and eeprom_write_block() themselves. Those replace the
+ * weak versions below, and the hooks fall back onto them without caching.
+ * Deprecated, to be removed with the next breaking changes cycle.
+ */
+__attribute__((weak)) void eeprom_driver_read_block(void *buf, const void *addr, size_t len) {
+    eeprom_read_block(buf, addr, len);
+}
+
+__attribute__((weak)) void eeprom_driver_write_block(const void *buf, void *addr, size_t len) {
+    eeprom_write_block(buf, addr, len);
+}
+
+#    define EEPROM_LEGACY_HOOK __attribute__((weak))
+#else
+#    define EEPROM_LEGACY_HOOK
+#endif
+
+#if defined(EEPROM_WRITE_CACHE_ENABLE)
+/*
+ * Write-back cache in front of the driver. Writes only land in RAM, dirty lines
+ * are written out once no write happened for EEPROM_WRITE_CACHE_TIMEOUT ms, but
+ * no later than EEPROM_WRITE_CACHE_MAX_DELAY ms after the first unflushed write.
+ * Only the dirty span of each line is passed on to the driver.
+ */
+#    ifndef EEPROM_WRITE_CACHE_LINES
+#        define EEPROM_WRITE_CACHE_LINES 8
+#    endif
+#    ifndef EEPROM_WRITE_CACHE_LINE_SIZE
+#        define EEPROM_WRITE_CACHE_LINE_SIZE 32
+#    endif
+#    ifndef EEPROM_WRITE_CACHE_TIMEOUT
+#        define EEPROM_WRITE_CACHE_TIMEOUT 1000
+#    endif
+#    ifndef EEPROM_WRITE_CACHE_MAX_DELAY
+#        define EEPROM_WRITE_CACHE_MAX_DELAY 5000
+#    endif
+
+#    if (EEPROM_WRITE_CACHE_LINE_SIZE & (EEPROM_WRITE_CACHE_LINE_SIZE - 1)) != 0 || EEPROM_WRITE_CACHE_LINE_SIZE > 256
+#        error EEPROM_WRITE_CACHE_LINE_SIZE must be a power of two, up to 256
+#    endif
+
+typedef struct {
+    uintptr_t base;
+    uint32_t  last_used;
+    uint16_t  dirty_first;
+    uint16_t  dirty_last;
+    bool      valid;
+    uint8_t   data[EEPROM_WRITE_CACHE_LINE_SIZE];
+} eeprom_cache_line_t;
+
+#    define CACHE_LINE_CLEAN EEPROM_WRITE_CACHE_LINE_SIZE
+
+static eeprom_cache_line_t  cache_lines[EEPROM_WRITE_CACHE_LINES];
+static eeprom_cache_stats_t cache_stats;
+static uint32_t             cache_clock;
+
+static deferred_executor_t cache_executors[1];
+static uint32_t            cache_last_exec;
+static deferred_token      cache_flush_token = INVALID_DEFERRED_TOKEN;
+static uint32_t            cache_dirty_since;
+
+static eeprom_cache_line_t *cache_find(uintptr_t base) {
+    for (uint8_t i = 0; i < EEPROM_WRITE_CACHE_LINES; i++) {
+        if (cache_lines[i].valid && cache_lines[i].base == base) {
+            cache_lines[i].last_used = ++cache_clock;
+            return &cache_lines[i];
+        }
+    }
+    return NULL;
+}
+
+static void cache_flush_line(eeprom_cache_line_t *line) {
+    if (line->dirty_first == CACHE_LINE_CLEAN) {
+        return;
+    }
+    eeprom_driver_write_block(&line->data[line->dirty_first], (void *)(line->base + line->dirty_first), line->dirty_last - line->dirty_first + 1);
+    cache_stats.driver_writes++;
+    line->dirty_first = CACHE_LINE_CLEAN;
+}
+
+/* Take over the least recently used line, filling it unless the caller overwrites all of it */
+static eeprom_cache_line_t *cache_allocate(uintptr_t base, bool fill) {
+    eeprom_cache_line_t *line = &cache_lines[0];
+    for (uint8_t i = 0; i < EEPROM_WRITE_CACHE_LINES; i++) {
+        if (!cache_lines[i].valid) {
+            line = &cache_lines[i];
+            break;
+        }
+        if (cache_lines[i].last_used < line->last_used) {
+            line = &cache_lines[i];
+        }
+    }
+
+    if (line->valid) {
+        cache_flush_line(line);
+        cache_stats.evictions++;
+    }
+
+    line->base        = base;
+    line->valid       = true;
+    line->dirty_first = CACHE_LINE_CLEAN;
+    line->last_used   = ++cache_clock;
+    if (fill) {
+        eeprom_driver_read_block(line->data, (const void *)base, EEPROM_WRITE_CACHE_LINE_SIZE);
+    }
+    return line;
+}
+
+static uint32_t cache_flush_callback(uint32_t trigger_time, void *cb_arg) {
+    cache_flush_token = INVALID_DEFERRED_TOKEN;
+    eeprom_driver_flush();
+    return 0;
+}
+
+static void cache_schedule_flush(void) {
+    if (cache_flush_token == INVALID_DEFERRED_TOKEN) {
+        cache_dirty_since = timer_read32();
+        cache_flush_token = defer_exec_advanced(cache_executors, 1, EEPROM_WRITE_CACHE_TIMEOUT, cache_flush_callback, NULL);
+        if (cache_flush_token == INVALID_DEFERRED_TOKEN) {
+            /* Can't defer, degrade to write-through */
+            eeprom_driver_flush();
+        }
+    } else if (timer_elapsed32(cache_dirty_since) + EEPROM_WRITE_CACHE_TIMEOUT < EEPROM_WRITE_CACHE_MAX_DELAY) {
+        extend_deferred_exec_advanced(cache_executors, 1, cache_flush_token, EEPROM_WRITE_CACHE_TIMEOUT);
+    }
+}
+
+void eeprom_driver_flush(void) {
+    bool dirty = false;
+    for (uint8_t i = 0; i < EEPROM_WRITE_CACHE_LINES; i++) {
+        if (cache_lines[i].valid && cache_lines[i].dirty_first != CACHE_LINE_CLEAN) {
+            cache_flush_line(&cache_lines[i]);
+            dirty = true;
+        }
+    }
+    if (dirty) {
+        cache_stats.flushes++;
+    }
+    if (cache_flush_token != INVALID_DEFERRED_TOKEN) {
+        cancel_deferred_exec_advanced(cache_executors, 1, cache_flush_token);
+        cache_flush_token = INVALID_DEFERRED_TOKEN;
+    }
+}
+
+/* Drop all cached contents without writing them, e.g. before the driver erases everything */
+void eeprom_driver_discard(void) {
+    memset(cache_lines, 0, sizeof(cache_lines));
+    if (cache_flush_token != INVALID_DEFERRED_TOKEN) {
+        cancel_deferred_exec_advanced(cache_executors, 1, cache_flush_token);
+        cache_flush_token = INVALID_DEFERRED_TOKEN;
+    }
+}
+
+void eeprom_driver_get_cache_stats(eeprom_cache_stats_t *stats) {
+    *stats = cache_stats;
+}
+
+EEPROM_LEGACY_HOOK void eeprom_read_block(void *buf, const void *addr, size_t len) {
+    uint8_t * dest   = (uint8_t *)buf;
+    uintptr_t offset = (uintptr_t)addr;
+
+    while (len) {
+        uintptr_t base  = offset & ~(uintptr_t)(EEPROM_WRITE_CACHE_LINE_SIZE - 1);
+        size_t    start = offset - base;
+        size_t    chunk = EEPROM_WRITE_CACHE_LINE_SIZE - start;
+        if (chunk > len) {
+            chunk = len;
+        }
+
+        eeprom_cache_line_t *line = cache_find(base);
+        if (line) {
+            memcpy(dest, &line->data[start], chunk);
+            cache_stats.read_hits++;
+        } else {
+            eeprom_driver_read_block(dest, (const void *)offset, chunk);
+            cache_stats.read_misses++;
+        }
+
+        dest += chunk;
+        offset += chunk;
+        len -= chunk;
+    }
+}
+
+EEPROM_LEGACY_HOOK void eeprom_write_block(const void *buf, void *addr, size_t len) {
+    const uint8_t *src     = (const uint8_t *)buf;
+    uintptr_t      offset  = (uintptr_t)addr;
+    bool           changed = false;
+
+    cache_stats.writes++;
+    while (len) {
+        uintptr_t base  = offset & ~(uintptr_t)(EEPROM_WRITE_CACHE_LINE_SIZE - 1);
+        size_t    start = offset - base;
+        size_t    chunk = EEPROM_WRITE_CACHE_LINE_SIZE - start;
+        if (chunk > len) {
+            chunk = len;
+        }
+
+        eeprom_cache_line_t *line = cache_find(base);
+        if (!line) {
+            line = cache_allocate(base, chunk != EEPROM_WRITE_CACHE_LINE_SIZE);
+        }
+        if (memcmp(&line->data[start], src, chunk) != 0) {
+            memcpy(&line->data[start], src, chunk);
+            if (line->dirty_first == CACHE_LINE_CLEAN) {
+                line->dirty_first = start;
+                line->dirty_last  = start + chunk - 1;
+            } else {
+                if (start < line->dirty_first) {
+                    line->dirty_first = start;
+                }
+                if (start + chunk - 1 > line->dirty_last) {
+                    line->dirty_last = start + chunk - 1;
+                }
+            }
+            changed = true;
+        }
+
+        src += chunk;
+        offset += chunk;
+        len -= chunk;
+    }
+
+    if (changed) {
+        cache_schedule_flush();
+    } else {
+        cache_stats.unchanged++;
+    }
+}
+
+void eeprom_driver_task(void) {
+    deferred_exec_advanced_task(cache_executors, 1, &cache_last_exec);
+    eeprom_driver_backend_task();
+}
+#else
+EEPROM_LEGACY_HOOK void eeprom_read_block(void *buf, const void *addr, size_t len) {
+    eeprom_driver_read_block(buf, addr, len);
+}
+
+EEPROM_LEGACY_HOOK void eeprom_write_block(const void *buf, void *addr, size_t len) {
+    eeprom_driver_write_block(buf, addr, len);
+}
+
+void eeprom_driver_task(void) {
+    eeprom_driver_backend_task();
+}
+#endif
 
 uint8_t eeprom_read_byte(const uint8_t *addr) {
     uint8_t ret = 0;
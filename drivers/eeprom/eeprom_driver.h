@@ -16,7 +16,34 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <stddef.h>
 #include "eeprom.h"
 
+/* Implemented by the driver, eeprom_read_block() and eeprom_write_block() are provided on top of them by eeprom_driver.c */
 void eeprom_driver_init(void);
 void eeprom_driver_erase(void);
+void eeprom_driver_read_block(void *buf, const void *addr, size_t len);
+void eeprom_driver_write_block(const void *buf, void *addr, size_t len);
+void eeprom_driver_backend_task(void);
+
+void eeprom_driver_task(void);
+
+#if defined(EEPROM_WRITE_CACHE_ENABLE)
+typedef struct {
+    uint32_t writes;       // Blocks passed to eeprom_write_block()
+    uint32_t unchanged;    // Writes which didn't change any cached byte
+    uint32_t read_hits;    // Lines served from the cache
+    uint32_t read_misses;  // Lines read from the driver
+    uint32_t evictions;    // Lines dropped to make room, dirty ones are flushed first
+    uint32_t flushes;      // Flush passes with at least one dirty line
+    uint32_t driver_writes; // Block writes issued to the driver
+} eeprom_cache_stats_t;
+
+void eeprom_driver_flush(void);
+void eeprom_driver_discard(void);
+void eeprom_driver_get_cache_stats(eeprom_cache_stats_t *stats);
+#else
+static inline void eeprom_driver_flush(void) {}
+static inline void eeprom_driver_discard(void) {}
+#endif
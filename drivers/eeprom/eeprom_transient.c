@@ -38,7 +38,7 @@ void eeprom_driver_erase(void) {
     memset(transientBuffer, 0x00, TRANSIENT_EEPROM_SIZE);
 }
 
-void eeprom_read_block(void *buf, const void *addr, size_t len) {
+void eeprom_driver_read_block(void *buf, const void *addr, size_t len) {
     intptr_t offset = (intptr_t)addr;
     memset(buf, 0x00, len);
     len = clamp_length(offset, len);
@@ -47,7 +47,7 @@ void eeprom_read_block(void *buf, const void *addr, size_t len) {
     }
 }
 
-void eeprom_write_block(const void *buf, void *addr, size_t len) {
+void eeprom_driver_write_block(const void *buf, void *addr, size_t len) {
     intptr_t offset = (intptr_t)addr;
     len             = clamp_length(offset, len);
     if (len > 0) {
@@ -62,14 +62,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define ST7565_ALL_BLOCKS_MASK (((((ST7565_BLOCK_TYPE)1 << (ST7565_BLOCK_COUNT - 1)) - 1) << 1) | 1)
 
+#define ST7565_PAGE_COUNT (ST7565_DISPLAY_HEIGHT / 8)
+
 #define HAS_FLAGS(bits, flags) ((bits & flags) == flags)
 
 // Display buffer's is the same as the display memory layout
 // this is so we don't end up with rounding errors with
 // parts of the display unusable or don't get cleared correctly
 // and also allows for drawing & inverting
+// st7565_dirty only tells whether changes are waiting to be sent,
+// st7565_surface keeps track of which ones
 uint8_t            st7565_buffer[ST7565_MATRIX_SIZE];
-uint8_t *          st7565_cursor;
 ST7565_BLOCK_TYPE  st7565_dirty       = 0;
 bool               st7565_initialized = false;
 bool               st7565_active      = false;
@@ -82,12 +85,32 @@ uint32_t st7565_timeout;
 uint16_t st7565_update_timeout;
 #endif
 
-// Flips the rendering bits for a character at the current cursor position
-static void InvertCharacter(uint8_t *cursor) {
-    const uint8_t *end = cursor + ST7565_FONT_WIDTH;
-    while (cursor < end) {
-        *cursor = ~(*cursor);
-        cursor++;
+#ifndef ST7565_FONT_RLE
+_Static_assert(sizeof(font) >= ((ST7565_FONT_END + 1 - ST7565_FONT_START) * ST7565_FONT_WIDTH), "ST7565_FONT_END references outside array");
+#endif
+
+static uint8_t st7565_span_start[ST7565_PAGE_COUNT];
+static uint8_t st7565_span_end[ST7565_PAGE_COUNT];
+
+// Cursor, text and drawing on st7565_buffer
+static mono_surface_t st7565_surface = {
+    .buffer     = st7565_buffer,
+    .span_start = st7565_span_start,
+    .span_end   = st7565_span_end,
+    .font       = font,
+    .width      = ST7565_DISPLAY_WIDTH,
+    .pages      = ST7565_PAGE_COUNT,
+    .font_width = ST7565_FONT_WIDTH,
+    .font_start = ST7565_FONT_START,
+    .font_end   = ST7565_FONT_END,
+#ifdef ST7565_FONT_RLE
+    .font_rle   = true,
+#endif
+};
+
+static inline void st7565_changed(bool changed) {
+    if (changed) {
+        st7565_dirty = ST7565_ALL_BLOCKS_MASK;
     }
 }
 
@@ -143,152 +166,68 @@ __attribute__((weak)) display_rotation_t st7565_init_user(display_rotation_t rot
 }
 
 void st7565_clear(void) {
-    memset(st7565_buffer, 0, sizeof(st7565_buffer));
-    st7565_cursor = &st7565_buffer[0];
-    st7565_dirty  = ST7565_ALL_BLOCKS_MASK;
+    mono_surface_clear(&st7565_surface);
+    st7565_changed(true);
 }
 
-uint8_t crot(uint8_t a, int8_t n) {
-    const uint8_t mask = 0x7;
-    n &= mask;
-    return a << n | a >> (-n & mask);
+mono_surface_t *st7565_get_surface(void) {
+    return &st7565_surface;
 }
 
-void st7565_render(void) {
-    if (!st7565_initialized) {
-        return;
-    }
-
-    // Do we have work to do?
-    st7565_dirty &= ST7565_ALL_BLOCKS_MASK;
-    if (!st7565_dirty) {
-        return;
-    }
-
-    // Find first dirty block
-    uint8_t update_start = 0;
-    while (!(st7565_dirty & ((ST7565_BLOCK_TYPE)1 << update_start))) {
-        ++update_start;
-    }
-
-    // Calculate commands to set memory addressing bounds.
-    uint8_t start_page   = ST7565_BLOCK_SIZE * update_start / ST7565_DISPLAY_WIDTH;
-    uint8_t start_column = ST7565_BLOCK_SIZE * update_start % ST7565_DISPLAY_WIDTH;
+static bool st7565_send_window(const mono_surface_t *surface, const mono_window_t *window) {
     // IC has 132 segment drivers, for panels with less width we need to offset the starting column
+    uint8_t start_column = window->start;
     if (HAS_FLAGS(st7565_rotation, DISPLAY_ROTATION_180)) {
         start_column += (132 - ST7565_DISPLAY_WIDTH);
     }
 
-    spi_start(ST7565_SS_PIN, false, 0, ST7565_SPI_CLK_DIVISOR);
+    if (!spi_start(ST7565_SS_PIN, false, 0, ST7565_SPI_CLK_DIVISOR)) {
+        return false;
+    }
 
-    st7565_send_cmd(PAM_PAGE_ADDR | start_page);
+    st7565_send_cmd(PAM_PAGE_ADDR | window->first_page);
     st7565_send_cmd(PAM_SETCOLUMN_LSB | ((ST7565_COLUMN_OFFSET + start_column) & 0x0f));
     st7565_send_cmd(PAM_SETCOLUMN_MSB | ((ST7565_COLUMN_OFFSET + start_column) >> 4 & 0x0f));
 
-    st7565_send_data(&st7565_buffer[ST7565_BLOCK_SIZE * update_start], ST7565_BLOCK_SIZE);
+    st7565_send_data(&surface->buffer[window->first_page * surface->width + window->start], window->end - window->start);
+
+    spi_stop();
 
     // Turn on display if it is off
     st7565_on();
-
-    // Clear dirty flag
-    st7565_dirty &= ~((ST7565_BLOCK_TYPE)1 << update_start);
+    return true;
 }
 
-void st7565_set_cursor(uint8_t col, uint8_t line) {
-    uint16_t index = line * ST7565_DISPLAY_WIDTH + col * ST7565_FONT_WIDTH;
+// Page Addressing Mode only, so every window stays on its page
+static const mono_flush_driver_t st7565_flush_driver = {
+    .window_size = ST7565_BLOCK_SIZE,
+    .send        = st7565_send_window,
+};
 
-    // Out of bounds?
-    if (index >= ST7565_MATRIX_SIZE) {
-        index = 0;
+void st7565_render(void) {
+    if (!st7565_initialized) {
+        return;
     }
 
-    st7565_cursor = &st7565_buffer[index];
+    mono_surface_flush(&st7565_surface, &st7565_flush_driver);
+    st7565_dirty = mono_surface_is_dirty(&st7565_surface) ? ST7565_ALL_BLOCKS_MASK : 0;
 }
 
-void st7565_advance_page(bool clearPageRemainder) {
-    uint16_t index     = st7565_cursor - &st7565_buffer[0];
-    uint8_t  remaining = ST7565_DISPLAY_WIDTH - (index % ST7565_DISPLAY_WIDTH);
-
-    if (clearPageRemainder) {
-        // Remaining Char count
-        remaining = remaining / ST7565_FONT_WIDTH;
-
-        // Write empty character until next line
-        while (remaining--)
-            st7565_write_char(' ', false);
-    } else {
-        // Next page index out of bounds?
-        if (index + remaining >= ST7565_MATRIX_SIZE) {
-            index     = 0;
-            remaining = 0;
-        }
+void st7565_set_cursor(uint8_t col, uint8_t line) {
+    mono_surface_set_cursor(&st7565_surface, col, line);
+}
 
-        st7565_cursor = &st7565_buffer[index + remaining];
-    }
+void st7565_advance_page(bool clearPageRemainder) {
+    st7565_changed(mono_surface_advance_page(&st7565_surface, clearPageRemainder));
 }
 
 void st7565_advance_char(void) {
-    uint16_t nextIndex      = st7565_cursor - &st7565_buffer[0] + ST7565_FONT_WIDTH;
-    uint8_t  remainingSpace = ST7565_DISPLAY_WIDTH - (nextIndex % ST7565_DISPLAY_WIDTH);
-
-    // Do we have enough space on the current line for the next character
-    if (remainingSpace < ST7565_FONT_WIDTH) {
-        nextIndex += remainingSpace;
-    }
-
-    // Did we go out of bounds
-    if (nextIndex >= ST7565_MATRIX_SIZE) {
-        nextIndex = 0;
-    }
-
-    // Update cursor position
-    st7565_cursor = &st7565_buffer[nextIndex];
+    mono_surface_advance_char(&st7565_surface);
 }
 
 // Main handler that writes character data to the display buffer
 void st7565_write_char(const char data, bool invert) {
-    // Advance to the next line if newline
-    if (data == '\n') {
-        // Old source wrote ' ' until end of line...
-        st7565_advance_page(true);
-        return;
-    }
-
-    if (data == '\r') {
-        st7565_advance_page(false);
-        return;
-    }
-
-    // copy the current render buffer to check for dirty after
-    static uint8_t st7565_temp_buffer[ST7565_FONT_WIDTH];
-    memcpy(&st7565_temp_buffer, st7565_cursor, ST7565_FONT_WIDTH);
-
-    _Static_assert(sizeof(font) >= ((ST7565_FONT_END + 1 - ST7565_FONT_START) * ST7565_FONT_WIDTH), "ST7565_FONT_END references outside array");
-
-    // set the reder buffer data
-    uint8_t cast_data = (uint8_t)data; // font based on unsigned type for index
-    if (cast_data < ST7565_FONT_START || cast_data > ST7565_FONT_END) {
-        memset(st7565_cursor, 0x00, ST7565_FONT_WIDTH);
-    } else {
-        const uint8_t *glyph = &font[(cast_data - ST7565_FONT_START) * ST7565_FONT_WIDTH];
-        memcpy_P(st7565_cursor, glyph, ST7565_FONT_WIDTH);
-    }
-
-    // Invert if needed
-    if (invert) {
-        InvertCharacter(st7565_cursor);
-    }
-
-    // Dirty check
-    if (memcmp(&st7565_temp_buffer, st7565_cursor, ST7565_FONT_WIDTH)) {
-        uint16_t index = st7565_cursor - &st7565_buffer[0];
-        st7565_dirty |= ((ST7565_BLOCK_TYPE)1 << (index / ST7565_BLOCK_SIZE));
-        // Edgecase check if the written data spans the 2 chunks
-        st7565_dirty |= ((ST7565_BLOCK_TYPE)1 << ((index + ST7565_FONT_WIDTH - 1) / ST7565_BLOCK_SIZE));
-    }
-
-    // Finally move to the next char
-    st7565_advance_char();
+    st7565_changed(mono_surface_write_char(&st7565_surface, data, invert));
 }
 
 void st7565_write(const char *data, bool invert) {
@@ -305,21 +244,8 @@ void st7565_write_ln(const char *data, bool invert) {
 }
 
 void st7565_pan(bool left) {
-    uint16_t i = 0;
-    for (uint16_t y = 0; y < ST7565_DISPLAY_HEIGHT / 8; y++) {
-        if (left) {
-            for (uint16_t x = 0; x < ST7565_DISPLAY_WIDTH - 1; x++) {
-                i                = y * ST7565_DISPLAY_WIDTH + x;
-                st7565_buffer[i] = st7565_buffer[i + 1];
-            }
-        } else {
-            for (uint16_t x = ST7565_DISPLAY_WIDTH - 1; x > 0; x--) {
-                i                = y * ST7565_DISPLAY_WIDTH + x;
-                st7565_buffer[i] = st7565_buffer[i - 1];
-            }
-        }
-    }
-    st7565_dirty = ST7565_ALL_BLOCKS_MASK;
+    mono_surface_pan(&st7565_surface, left);
+    st7565_changed(true);
 }
 
 display_buffer_reader_t st7565_read_raw(uint16_t start_index) {
@@ -331,41 +257,19 @@ display_buffer_reader_t st7565_read_raw(uint16_t start_index) {
 }
 
 void st7565_write_raw_byte(const char data, uint16_t index) {
-    if (index > ST7565_MATRIX_SIZE) index = ST7565_MATRIX_SIZE;
-    if (st7565_buffer[index] == data) return;
-    st7565_buffer[index] = data;
-    st7565_dirty |= ((ST7565_BLOCK_TYPE)1 << (index / ST7565_BLOCK_SIZE));
+    st7565_changed(mono_surface_write_raw_byte(&st7565_surface, data, index));
 }
 
 void st7565_write_raw(const char *data, uint16_t size) {
-    uint16_t cursor_start_index = st7565_cursor - &st7565_buffer[0];
-    if ((size + cursor_start_index) > ST7565_MATRIX_SIZE) size = ST7565_MATRIX_SIZE - cursor_start_index;
-    for (uint16_t i = cursor_start_index; i < cursor_start_index + size; i++) {
-        uint8_t c = *data++;
-        if (st7565_buffer[i] == c) continue;
-        st7565_buffer[i] = c;
-        st7565_dirty |= ((ST7565_BLOCK_TYPE)1 << (i / ST7565_BLOCK_SIZE));
-    }
+    st7565_changed(mono_surface_write_raw(&st7565_surface, (const uint8_t *)data, size));
 }
 
 void st7565_write_pixel(uint8_t x, uint8_t y, bool on) {
-    if (x >= ST7565_DISPLAY_WIDTH) {
-        return;
-    }
-    uint16_t index = x + (y / 8) * ST7565_DISPLAY_WIDTH;
-    if (index >= ST7565_MATRIX_SIZE) {
-        return;
-    }
-    uint8_t data = st7565_buffer[index];
-    if (on) {
-        data |= (1 << (y % 8));
-    } else {
-        data &= ~(1 << (y % 8));
-    }
-    if (st7565_buffer[index] != data) {
-        st7565_buffer[index] = data;
-        st7565_dirty |= ((ST7565_BLOCK_TYPE)1 << (index / ST7565_BLOCK_SIZE));
-    }
+    st7565_changed(mono_surface_write_pixel(&st7565_surface, x, y, on));
+}
+
+void st7565_write_rle(const char *image, uint16_t frame) {
+    st7565_changed(mono_surface_write_rle(&st7565_surface, (const uint8_t *)image, frame));
 }
 
 #if defined(__AVR__)
@@ -383,14 +287,7 @@ void st7565_write_ln_P(const char *data, bool invert) {
 }
 
 void st7565_write_raw_P(const char *data, uint16_t size) {
-    uint16_t cursor_start_index = st7565_cursor - &st7565_buffer[0];
-    if ((size + cursor_start_index) > ST7565_MATRIX_SIZE) size = ST7565_MATRIX_SIZE - cursor_start_index;
-    for (uint16_t i = cursor_start_index; i < cursor_start_index + size; i++) {
-        uint8_t c = pgm_read_byte(data++);
-        if (st7565_buffer[i] == c) continue;
-        st7565_buffer[i] = c;
-        st7565_dirty |= ((ST7565_BLOCK_TYPE)1 << (i / ST7565_BLOCK_SIZE));
-    }
+    st7565_changed(mono_surface_write_raw_P(&st7565_surface, (const uint8_t *)data, size));
 }
 #endif // defined(__AVR__)
 
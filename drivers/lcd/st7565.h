@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdbool.h>
 
 #include "spi_master.h"
+#include "mono_surface.h"
 
 #ifndef ST7565_DISPLAY_WIDTH
 #    define ST7565_DISPLAY_WIDTH 128
@@ -156,6 +157,14 @@ void st7565_write_raw_byte(const char data, uint16_t index);
 // Coordinates start at top-left and go right and down for positive x and y
 void st7565_write_pixel(uint8_t x, uint8_t y, bool on);
 
+// Writes a frame of a compressed PROGMEM image (see `qmk generate-mono-rle`) to the buffer at current cursor position
+// Takes the place of st7565_write_raw_P for logos and animations
+void st7565_write_rle(const char *image, uint16_t frame);
+
+// Returns the surface behind the buffer, for the mono_surface_* drawing functions
+// (rectangles, bitmaps, sprites and text at any pixel position)
+mono_surface_t *st7565_get_surface(void);
+
 #if defined(__AVR__)
 // Writes a PROGMEM string to the buffer at current cursor position
 // Advances the cursor while writing, inverts the pixels if true
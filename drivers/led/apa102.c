@@ -76,6 +76,14 @@ void rgblight_call_driver(LED_TYPE *start_led, uint8_t num_leds) {
     apa102_setleds(start_led, num_leds);
 }
 
+// Each APA102 latches its own frame, so the LEDs past a changed span keep their color without being resent.
+// The frames before the span can't be skipped though, so this always sends from the first LED on.
+void rgblight_call_driver_span(LED_TYPE *start_led, uint8_t num_leds, uint8_t span_start, uint8_t span_end) {
+    (void)num_leds;
+    (void)span_start;
+    apa102_setleds(start_led, span_end);
+}
+
 void static apa102_init(void) {
     setPinOutput(RGB_DI_PIN);
     setPinOutput(RGB_CI_PIN);
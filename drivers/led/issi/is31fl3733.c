@@ -19,6 +19,7 @@
 
 #include "is31fl3733.h"
 #include "i2c_master.h"
+#include "is31fl_queue.h"
 #include "wait.h"
 
 // This is a 7-bit address, that gets left-shifted and bit 0
@@ -79,7 +80,9 @@ uint8_t g_twi_transfer_buffer[20];
 // buffers and the transfers in IS31FL3733_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
 uint8_t g_pwm_buffer[DRIVER_COUNT][192];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
+// One bit per 16 byte block of g_pwm_buffer, i.e. per I2C transfer.
+// Only blocks holding changed LEDs are sent on the next update.
+uint32_t g_pwm_buffer_dirty[DRIVER_COUNT] = {0};
 
 uint8_t g_led_control_registers[DRIVER_COUNT][24]             = {0};
 bool    g_led_control_registers_update_required[DRIVER_COUNT] = {false};
@@ -103,33 +106,41 @@ bool IS31FL3733_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
     return true;
 }
 
-bool IS31FL3733_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+static bool IS31FL3733_write_pwm_block(uint8_t addr, uint8_t *pwm_buffer, uint8_t block) {
     // Assumes PG1 is already selected.
-    // If any of the transactions fails function returns false.
-    // Transmit PWM registers in 12 transfers of 16 bytes.
-    // g_twi_transfer_buffer[] is 20 bytes
-
-    // Iterate over the pwm_buffer contents at 16 byte intervals.
-    for (int i = 0; i < 192; i += 16) {
-        g_twi_transfer_buffer[0] = i;
-        // Copy the data from i to i+15.
-        // Device will auto-increment register for data after the first byte
-        // Thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer.
-        for (int j = 0; j < 16; j++) {
-            g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
-        }
+    uint8_t i = block * 16;
+
+    g_twi_transfer_buffer[0] = i;
+    // Copy the data from i to i+15.
+    // Device will auto-increment register for data after the first byte
+    // Thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer.
+    for (int j = 0; j < 16; j++) {
+        g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
+    }
 
 #if ISSI_PERSISTENCE > 0
-        for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) != 0) {
-                return false;
-            }
-        }
-#else
+    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
         if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) != 0) {
             return false;
         }
+    }
+#else
+    if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) != 0) {
+        return false;
+    }
 #endif
+    return true;
+}
+
+bool IS31FL3733_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    // Assumes PG1 is already selected.
+    // If any of the transactions fails function returns false.
+    // Transmit PWM registers in 12 transfers of 16 bytes.
+    // g_twi_transfer_buffer[] is 20 bytes
+    for (uint8_t block = 0; block < 12; block++) {
+        if (!IS31FL3733_write_pwm_block(addr, pwm_buffer, block)) {
+            return false;
+        }
     }
     return true;
 }
@@ -180,15 +191,22 @@ void IS31FL3733_init(uint8_t addr, uint8_t sync) {
     wait_ms(10);
 }
 
+// Only mark the block dirty if the value actually changes
+static inline void IS31FL3733_set_pwm(uint8_t driver, uint8_t reg, uint8_t value) {
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        g_pwm_buffer_dirty[driver] |= 1 << (reg / 16);
+    }
+}
+
 void IS31FL3733_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     is31_led led;
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         memcpy_P(&led, (&g_is31_leds[index]), sizeof(led));
 
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL3733_set_pwm(led.driver, led.r, red);
+        IS31FL3733_set_pwm(led.driver, led.g, green);
+        IS31FL3733_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -229,20 +247,69 @@ void IS31FL3733_set_led_control_register(uint8_t index, bool red, bool green, bo
 }
 
 void IS31FL3733_update_pwm_buffers(uint8_t addr, uint8_t index) {
-    if (g_pwm_buffer_update_required[index]) {
+    if (g_pwm_buffer_dirty[index]) {
         // Firstly we need to unlock the command register and select PG1.
         IS31FL3733_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
         IS31FL3733_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM);
 
+        // Only send the changed blocks, a failed block is retried on the next update.
+        for (uint8_t block = 0; block < 12; block++) {
+            if (g_pwm_buffer_dirty[index] & (1 << block)) {
+                if (IS31FL3733_write_pwm_block(addr, g_pwm_buffer[index], block)) {
+                    g_pwm_buffer_dirty[index] &= ~(1 << block);
+                } else {
+                    // If any of the transactions fail we risk writing dirty PG0,
+                    // refresh page 0 just in case.
+                    g_led_control_registers_update_required[index] = true;
+                }
+            }
+        }
+    }
+}
+
+#ifdef I2C_ASYNC_SUPPORTED
+// Queued updates are sent from copies of the changed blocks, as g_pwm_buffer
+// may change while they are on the bus. Each driver adds its page selection
+// and its blocks, so one queue can refresh all of them in the background.
+static uint8_t           g_pwm_transfer_buffer[DRIVER_COUNT][12][17];
+static uint8_t           g_command_unlock[2]     = {ISSI_COMMANDREGISTER_WRITELOCK, 0xC5};
+static uint8_t           g_command_select_pwm[2] = {ISSI_COMMANDREGISTER, ISSI_PAGE_PWM};
+static i2c_transaction_t g_pwm_transactions[DRIVER_COUNT * (2 + 12)];
+static uint32_t          g_pwm_buffer_queued[DRIVER_COUNT] = {0};
+static is31fl_queue_t    g_pwm_queue                       = IS31FL_QUEUE(g_pwm_transactions, g_pwm_buffer_dirty, g_pwm_buffer_queued);
+
+void IS31FL3733_queue_pwm_buffers(uint8_t addr, uint8_t index) {
+    if (is31fl_queue_begin(&g_pwm_queue)) {
         // If any of the transactions fail we risk writing dirty PG0,
         // refresh page 0 just in case.
-        if (!IS31FL3733_write_pwm_buffer(addr, g_pwm_buffer[index])) {
-            g_led_control_registers_update_required[index] = true;
+        for (uint8_t i = 0; i < DRIVER_COUNT; i++) {
+            g_led_control_registers_update_required[i] = true;
+        }
+    }
+
+    uint32_t blocks = is31fl_queue_take(&g_pwm_queue, index);
+    if (!blocks) {
+        return;
+    }
+    is31fl_queue_add(&g_pwm_queue, addr, g_command_unlock, sizeof(g_command_unlock));
+    is31fl_queue_add(&g_pwm_queue, addr, g_command_select_pwm, sizeof(g_command_select_pwm));
+    for (uint8_t block = 0; block < 12; block++) {
+        if (blocks & (1 << block)) {
+            uint8_t *packet = g_pwm_transfer_buffer[index][block];
+            packet[0]       = block * 16;
+            for (int j = 0; j < 16; j++) {
+                packet[1 + j] = g_pwm_buffer[index][block * 16 + j];
+            }
+            is31fl_queue_add(&g_pwm_queue, addr, packet, 17);
         }
     }
-    g_pwm_buffer_update_required[index] = false;
 }
 
+void IS31FL3733_send_queue(void) {
+    is31fl_queue_send(&g_pwm_queue, ISSI_TIMEOUT);
+}
+#endif
+
 void IS31FL3733_update_led_control_registers(uint8_t addr, uint8_t index) {
     if (g_led_control_registers_update_required[index]) {
         // Firstly we need to unlock the command register and select PG0
@@ -48,6 +48,12 @@ void IS31FL3733_set_led_control_register(uint8_t index, bool red, bool green, bo
 void IS31FL3733_update_pwm_buffers(uint8_t addr, uint8_t index);
 void IS31FL3733_update_led_control_registers(uint8_t addr, uint8_t index);
 
+// Where I2C_ASYNC_SUPPORTED, the same without blocking: queue the changes of
+// each driver, then send them all in the background. Queuing waits for the
+// last queue to arrive first, so no changes are left behind.
+void IS31FL3733_queue_pwm_buffers(uint8_t addr, uint8_t index);
+void IS31FL3733_send_queue(void);
+
 #define PUR_0R 0x00   // No PUR resistor
 #define PUR_05KR 0x02 // 0.5k Ohm resistor in t_NOL
 #define PUR_3KR 0x03  // 3.0k Ohm resistor on all the time
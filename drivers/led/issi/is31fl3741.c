@@ -81,9 +81,13 @@ uint8_t g_twi_transfer_buffer[20] = {0xFF};
 // buffers and the transfers in IS31FL3741_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
 uint8_t g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT]        = {false};
 bool    g_scaling_registers_update_required[DRIVER_COUNT] = {false};
 
+// One bit per 18 byte block of g_pwm_buffer, i.e. per I2C transfer.
+// Only blocks holding changed LEDs are sent on the next update.
+#define ISSI_PWM_BLOCK_COUNT 20
+uint32_t g_pwm_buffer_dirty[DRIVER_COUNT] = {0};
+
 uint8_t g_scaling_registers[DRIVER_COUNT][ISSI_MAX_LEDS];
 
 void IS31FL3741_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
@@ -99,49 +103,44 @@ void IS31FL3741_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 #endif
 }
 
-bool IS31FL3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
-    // unlock the command register and select PG2
-    IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
-    IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM0);
-
-    for (int i = 0; i < 342; i += 18) {
-        if (i == 180) {
-            // unlock the command register and select PG2
-            IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
-            IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM1);
-        }
+// Blocks 0-9 live in PG0, blocks 10-19 in PG1, the last block is only 9 bytes
+// cause the total number is 351. The page has to be selected by the caller.
+static bool IS31FL3741_write_pwm_block(uint8_t addr, uint8_t *pwm_buffer, uint8_t block) {
+    uint16_t i    = block * 18;
+    uint8_t  size = (i + 18 > 351) ? 351 - i : 18;
 
-        g_twi_transfer_buffer[0] = i % 180;
-        memcpy(g_twi_transfer_buffer + 1, pwm_buffer + i, 18);
-
-#if ISSI_PERSISTENCE > 0
-        for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 19, ISSI_TIMEOUT) != 0) {
-                return false;
-            }
-        }
-#else
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 19, ISSI_TIMEOUT) != 0) {
-            return false;
-        }
-#endif
-    }
-
-    // transfer the left cause the total number is 351
-    g_twi_transfer_buffer[0] = 162;
-    memcpy(g_twi_transfer_buffer + 1, pwm_buffer + 342, 9);
+    g_twi_transfer_buffer[0] = i % 180;
+    memcpy(g_twi_transfer_buffer + 1, pwm_buffer + i, size);
 
 #if ISSI_PERSISTENCE > 0
     for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 10, ISSI_TIMEOUT) != 0) {
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, size + 1, ISSI_TIMEOUT) != 0) {
             return false;
         }
     }
 #else
-    if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 10, ISSI_TIMEOUT) != 0) {
+    if (i2c_transmit(addr << 1, g_twi_transfer_buffer, size + 1, ISSI_TIMEOUT) != 0) {
         return false;
     }
 #endif
+    return true;
+}
+
+static void IS31FL3741_select_pwm_page(uint8_t addr, uint8_t block) {
+    // unlock the command register and select PG0 or PG1
+    IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
+    IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, block < 10 ? ISSI_PAGE_PWM0 : ISSI_PAGE_PWM1);
+}
+
+bool IS31FL3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    for (uint8_t block = 0; block < ISSI_PWM_BLOCK_COUNT; block++) {
+        if (block == 0 || block == 10) {
+            IS31FL3741_select_pwm_page(addr, block);
+        }
+        if (!IS31FL3741_write_pwm_block(addr, pwm_buffer, block)) {
+            return false;
+        }
+    }
 
     return true;
 }
@@ -173,15 +172,22 @@ void IS31FL3741_init(uint8_t addr) {
     wait_ms(10);
 }
 
+// Only mark the block dirty if the value actually changes
+static inline void IS31FL3741_set_pwm(uint8_t driver, uint16_t reg, uint8_t value) {
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        g_pwm_buffer_dirty[driver] |= (uint32_t)1 << (reg / 18);
+    }
+}
+
 void IS31FL3741_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     is31_led led;
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         memcpy_P(&led, (&g_is31_leds[index]), sizeof(led));
 
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL3741_set_pwm(led.driver, led.r, red);
+        IS31FL3741_set_pwm(led.driver, led.g, green);
+        IS31FL3741_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -217,19 +223,25 @@ void IS31FL3741_set_led_control_register(uint8_t index, bool red, bool green, bo
 }
 
 void IS31FL3741_update_pwm_buffers(uint8_t addr, uint8_t index) {
-    if (g_pwm_buffer_update_required[index]) {
-        IS31FL3741_write_pwm_buffer(addr, g_pwm_buffer[index]);
+    // Only send the changed blocks, a failed block is retried on the next update
+    uint8_t page = 0xFF;
+    for (uint8_t block = 0; block < ISSI_PWM_BLOCK_COUNT; block++) {
+        if (g_pwm_buffer_dirty[index] & ((uint32_t)1 << block)) {
+            if (page != block / 10) {
+                page = block / 10;
+                IS31FL3741_select_pwm_page(addr, block);
+            }
+            if (IS31FL3741_write_pwm_block(addr, g_pwm_buffer[index], block)) {
+                g_pwm_buffer_dirty[index] &= ~((uint32_t)1 << block);
+            }
+        }
     }
-
-    g_pwm_buffer_update_required[index] = false;
 }
 
 void IS31FL3741_set_pwm_buffer(const is31_led *pled, uint8_t red, uint8_t green, uint8_t blue) {
-    g_pwm_buffer[pled->driver][pled->r] = red;
-    g_pwm_buffer[pled->driver][pled->g] = green;
-    g_pwm_buffer[pled->driver][pled->b] = blue;
-
-    g_pwm_buffer_update_required[pled->driver] = true;
+    IS31FL3741_set_pwm(pled->driver, pled->r, red);
+    IS31FL3741_set_pwm(pled->driver, pled->g, green);
+    IS31FL3741_set_pwm(pled->driver, pled->b, blue);
 }
 
 void IS31FL3741_update_led_control_registers(uint8_t addr, uint8_t index) {
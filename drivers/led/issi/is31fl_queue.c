@@ -0,0 +1,81 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "is31fl_queue.h"
+#include "wait.h"
+
+#ifdef I2C_ASYNC_SUPPORTED
+
+// The completion callback has no context, there is only ever one queue on the bus
+static is31fl_queue_t *is31fl_queue_in_flight;
+
+static void is31fl_queue_sent(i2c_status_t status) {
+    is31fl_queue_in_flight->failed = status != I2C_STATUS_SUCCESS;
+    is31fl_queue_in_flight->busy   = false;
+}
+
+bool is31fl_queue_begin(is31fl_queue_t *queue) {
+    // Waiting here keeps the last refresh from being dropped, e.g. before a suspend
+    while (queue->busy) {
+        wait_ms(1);
+    }
+    if (!queue->sent) {
+        return false;
+    }
+
+    bool failed = queue->failed;
+    for (uint8_t i = 0; i < queue->driver_count; i++) {
+        if (failed) {
+            queue->dirty[i] |= queue->queued[i];
+        }
+        queue->queued[i] = 0;
+    }
+    queue->sent = false;
+    return failed;
+}
+
+uint32_t is31fl_queue_take(is31fl_queue_t *queue, uint8_t index) {
+    if (queue->queued[index]) {
+        // The new changes wait for the next refresh
+        return 0;
+    }
+    queue->queued[index] = queue->dirty[index];
+    queue->dirty[index]  = 0;
+    return queue->queued[index];
+}
+
+void is31fl_queue_add(is31fl_queue_t *queue, uint8_t addr, const uint8_t *data, uint16_t length) {
+    if (queue->length < queue->size) {
+        queue->transactions[queue->length++] = (i2c_transaction_t){addr << 1, data, length};
+    }
+}
+
+void is31fl_queue_send(is31fl_queue_t *queue, uint16_t timeout) {
+    if (queue->length == 0) {
+        return;
+    }
+
+    queue->busy            = true;
+    queue->sent            = true;
+    is31fl_queue_in_flight = queue;
+    // Another driver may be using the bus, e.g. the OLED
+    while (i2c_transmit_queue_async(queue->transactions, queue->length, timeout, is31fl_queue_sent) == I2C_STATUS_BUSY) {
+        wait_ms(1);
+    }
+    queue->length = 0;
+}
+
+#endif
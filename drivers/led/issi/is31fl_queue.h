@@ -0,0 +1,66 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "i2c_master.h"
+
+#ifdef I2C_ASYNC_SUPPORTED
+
+/* Background refresh of several ISSI drivers in one queue of I2C writes,
+ * for platforms with I2C_ASYNC_SUPPORTED.
+ *
+ * Each driver keeps a dirty mask with a bit per register block. Taking a
+ * driver into the queue moves its dirty blocks to its queued mask, and the
+ * driver adds the writes for them. Should the queue fail, the blocks are
+ * marked dirty again once the next refresh begins.
+ */
+typedef struct {
+    i2c_transaction_t *transactions; // room for the writes of all drivers
+    uint8_t            size;
+    uint8_t            length;
+    uint8_t            driver_count;
+    uint32_t          *dirty;  // per driver, blocks waiting to be sent
+    uint32_t          *queued; // per driver, blocks in the last queue
+    bool               sent;
+    volatile bool      busy;
+    volatile bool      failed;
+} is31fl_queue_t;
+
+#define IS31FL_QUEUE(transactions, dirty, queued) \
+    { transactions, sizeof(transactions) / sizeof(transactions[0]), 0, sizeof(dirty) / sizeof(dirty[0]), dirty, queued, false, false, false }
+
+/**
+ * @brief Waits for the last queue to arrive, before the next one is built
+ * @return true if the last queue failed, its blocks are dirty again
+ */
+bool is31fl_queue_begin(is31fl_queue_t *queue);
+
+/**
+ * @brief Moves the dirty blocks of a driver into the queue
+ * @return the blocks to add writes for, none if the driver is already queued
+ */
+uint32_t is31fl_queue_take(is31fl_queue_t *queue, uint8_t index);
+
+// The data has to stay untouched until the next is31fl_queue_begin
+void is31fl_queue_add(is31fl_queue_t *queue, uint8_t addr, const uint8_t *data, uint16_t length);
+
+// Sends the queue in the background, once the bus is free
+void is31fl_queue_send(is31fl_queue_t *queue, uint16_t timeout);
+
+#endif
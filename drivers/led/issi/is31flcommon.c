@@ -20,6 +20,7 @@
 
 #include "is31flcommon.h"
 #include "i2c_master.h"
+#include "is31fl_queue.h"
 #include "wait.h"
 #include <string.h>
 
@@ -37,7 +38,12 @@ uint8_t g_twi_transfer_buffer[20];
 // These buffers match the PWM & scaling registers.
 // Storing them like this is optimal for I2C transfers to the registers.
 uint8_t g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
+
+// One bit per ISSI_PWM_TRF_SIZE block of g_pwm_buffer, i.e. per I2C transfer.
+// Only blocks holding changed LEDs are sent on the next update.
+#define ISSI_PWM_BLOCK_COUNT ((ISSI_MAX_LEDS + ISSI_PWM_TRF_SIZE - 1) / ISSI_PWM_TRF_SIZE)
+_Static_assert(ISSI_PWM_BLOCK_COUNT <= 32, "Too many PWM transfer blocks for the dirty bitmap");
+uint32_t g_pwm_buffer_dirty[DRIVER_COUNT] = {0};
 
 uint8_t g_scaling_buffer[DRIVER_COUNT][ISSI_SCALING_SIZE];
 bool    g_scaling_buffer_update_required[DRIVER_COUNT] = {false};
@@ -121,13 +127,70 @@ void IS31FL_common_init(uint8_t addr, uint8_t ssr) {
 }
 
 void IS31FL_common_update_pwm_register(uint8_t addr, uint8_t index) {
-    if (g_pwm_buffer_update_required[index]) {
+    if (g_pwm_buffer_dirty[index]) {
         // Queue up the correct page
         IS31FL_unlock_register(addr, ISSI_PAGE_PWM);
-        // Hand off the update to IS31FL_write_multi_registers
-        IS31FL_write_multi_registers(addr, g_pwm_buffer[index], ISSI_MAX_LEDS, ISSI_PWM_TRF_SIZE, ISSI_PWM_REG_1ST);
-        // Update flags that pwm_buffer has been updated
-        g_pwm_buffer_update_required[index] = false;
+        // Send each changed block on its own, a failed block stays dirty and is retried on the next update
+        for (uint8_t block = 0; block < ISSI_PWM_BLOCK_COUNT; block++) {
+            if (g_pwm_buffer_dirty[index] & ((uint32_t)1 << block)) {
+                uint8_t start = block * ISSI_PWM_TRF_SIZE;
+                uint8_t size  = ISSI_MAX_LEDS - start < ISSI_PWM_TRF_SIZE ? ISSI_MAX_LEDS - start : ISSI_PWM_TRF_SIZE;
+                if (IS31FL_write_multi_registers(addr, g_pwm_buffer[index] + start, size, size, ISSI_PWM_REG_1ST + start)) {
+                    g_pwm_buffer_dirty[index] &= ~((uint32_t)1 << block);
+                }
+            }
+        }
+    }
+}
+
+#ifdef I2C_ASYNC_SUPPORTED
+// Queued updates are sent from copies of the changed blocks, as g_pwm_buffer
+// may change while they are on the bus. Each driver adds its page selection
+// and its blocks, so one queue can refresh all of them in the background.
+static uint8_t           g_pwm_transfer_buffer[DRIVER_COUNT][ISSI_PWM_BLOCK_COUNT][ISSI_PWM_TRF_SIZE + 1];
+static uint8_t           g_command_unlock[2]     = {ISSI_COMMANDREGISTER_WRITELOCK, ISSI_REGISTER_UNLOCK};
+static uint8_t           g_command_select_pwm[2] = {ISSI_COMMANDREGISTER, ISSI_PAGE_PWM};
+static i2c_transaction_t g_pwm_transactions[DRIVER_COUNT * (2 + ISSI_PWM_BLOCK_COUNT)];
+static uint32_t          g_pwm_buffer_queued[DRIVER_COUNT] = {0};
+static is31fl_queue_t    g_pwm_queue                       = IS31FL_QUEUE(g_pwm_transactions, g_pwm_buffer_dirty, g_pwm_buffer_queued);
+
+void IS31FL_common_queue_pwm_register(uint8_t addr, uint8_t index) {
+    if (is31fl_queue_begin(&g_pwm_queue)) {
+        // If the page selection failed the blocks may have landed on the
+        // scaling page, refresh it just in case.
+        for (uint8_t i = 0; i < DRIVER_COUNT; i++) {
+            g_scaling_buffer_update_required[i] = true;
+        }
+    }
+
+    uint32_t blocks = is31fl_queue_take(&g_pwm_queue, index);
+    if (!blocks) {
+        return;
+    }
+    is31fl_queue_add(&g_pwm_queue, addr, g_command_unlock, sizeof(g_command_unlock));
+    is31fl_queue_add(&g_pwm_queue, addr, g_command_select_pwm, sizeof(g_command_select_pwm));
+    for (uint8_t block = 0; block < ISSI_PWM_BLOCK_COUNT; block++) {
+        if (blocks & ((uint32_t)1 << block)) {
+            uint8_t  start  = block * ISSI_PWM_TRF_SIZE;
+            uint8_t  size   = ISSI_MAX_LEDS - start < ISSI_PWM_TRF_SIZE ? ISSI_MAX_LEDS - start : ISSI_PWM_TRF_SIZE;
+            uint8_t *packet = g_pwm_transfer_buffer[index][block];
+            packet[0]       = ISSI_PWM_REG_1ST + start;
+            memcpy(packet + 1, g_pwm_buffer[index] + start, size);
+            is31fl_queue_add(&g_pwm_queue, addr, packet, size + 1);
+        }
+    }
+}
+
+void IS31FL_common_send_queue(void) {
+    is31fl_queue_send(&g_pwm_queue, ISSI_TIMEOUT);
+}
+#endif
+
+// Only mark the block dirty if the value actually changes
+static inline void IS31FL_set_pwm(uint8_t driver, uint8_t reg, uint8_t value) {
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        g_pwm_buffer_dirty[driver] |= (uint32_t)1 << (reg / ISSI_PWM_TRF_SIZE);
     }
 }
 
@@ -168,10 +231,9 @@ void IS31FL_RGB_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL_set_pwm(led.driver, led.r, red);
+        IS31FL_set_pwm(led.driver, led.g, green);
+        IS31FL_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -217,8 +279,7 @@ void IS31FL_simple_set_scaling_buffer(uint8_t index, bool value) {
 void IS31FL_simple_set_brightness(int index, uint8_t value) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
-        g_pwm_buffer[led.driver][led.v] = value;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL_set_pwm(led.driver, led.v, value);
     }
 }
 
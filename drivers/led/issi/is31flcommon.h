@@ -65,6 +65,12 @@ void IS31FL_common_init(uint8_t addr, uint8_t ssr);
 void IS31FL_common_update_pwm_register(uint8_t addr, uint8_t index);
 void IS31FL_common_update_scaling_register(uint8_t addr, uint8_t index);
 
+// Where I2C_ASYNC_SUPPORTED, the same without blocking: queue the changes of
+// each driver, then send them all in the background. Queuing waits for the
+// last queue to arrive first, so no changes are left behind.
+void IS31FL_common_queue_pwm_register(uint8_t addr, uint8_t index);
+void IS31FL_common_send_queue(void);
+
 #ifdef RGB_MATRIX_ENABLE
 // RGB Matrix Specific scripts
 void IS31FL_RGB_set_color(int index, uint8_t red, uint8_t green, uint8_t blue);
@@ -0,0 +1,100 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mono_rle.h"
+
+#include <string.h>
+
+// Read byte by byte, as the header and offsets are not aligned
+static inline uint16_t read_u16(const uint8_t *data) {
+    return pgm_read_byte(&data[0]) | pgm_read_byte(&data[1]) << 8;
+}
+
+uint8_t mono_rle_width(const uint8_t *image) {
+    return pgm_read_byte(&image[0]);
+}
+
+uint8_t mono_rle_height(const uint8_t *image) {
+    return pgm_read_byte(&image[1]);
+}
+
+uint16_t mono_rle_frame_count(const uint8_t *image) {
+    return read_u16(&image[2]);
+}
+
+uint16_t mono_rle_frame_size(const uint8_t *image) {
+    return (uint16_t)mono_rle_width(image) * ((mono_rle_height(image) + 7) / 8);
+}
+
+bool mono_rle_open(mono_rle_reader_t *reader, const uint8_t *image, uint16_t frame) {
+    uint16_t frames    = mono_rle_frame_count(image);
+    uint8_t  per_block = pgm_read_byte(&image[4]);
+    if (frame >= frames || !per_block) {
+        return false;
+    }
+
+    uint16_t       blocks = (frames + per_block - 1) / per_block;
+    const uint8_t *offset = &image[MONO_RLE_HEADER_SIZE + frame / per_block * 2];
+    reader->data          = &image[MONO_RLE_HEADER_SIZE + blocks * 2 + read_u16(offset)];
+    reader->count         = 0;
+    reader->run           = false;
+    mono_rle_skip(reader, frame % per_block * mono_rle_frame_size(image));
+    return true;
+}
+
+void mono_rle_next_token(mono_rle_reader_t *reader) {
+    uint8_t token = pgm_read_byte(reader->data++);
+    if (token & 0x80) {
+        reader->run   = true;
+        reader->count = (token & 0x7F) + 2;
+        reader->value = pgm_read_byte(reader->data++);
+    } else {
+        reader->run   = false;
+        reader->count = token + 1;
+    }
+}
+
+void mono_rle_skip(mono_rle_reader_t *reader, uint16_t count) {
+    while (count) {
+        if (!reader->count) {
+            mono_rle_next_token(reader);
+        }
+        uint8_t length = count < reader->count ? count : reader->count;
+        if (!reader->run) {
+            reader->data += length;
+        }
+        reader->count -= length;
+        count -= length;
+    }
+}
+
+void mono_rle_decode(mono_rle_reader_t *reader, uint8_t *dest, uint16_t count) {
+    while (count) {
+        if (!reader->count) {
+            mono_rle_next_token(reader);
+        }
+        uint8_t length = count < reader->count ? count : reader->count;
+        if (reader->run) {
+            memset(dest, reader->value, length);
+        } else {
+            memcpy_P(dest, reader->data, length);
+            reader->data += length;
+        }
+        reader->count -= length;
+        count -= length;
+        dest += length;
+    }
+}
@@ -0,0 +1,69 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "progmem.h"
+
+// Run-length compressed monochrome images and fonts in PROGMEM, as written by `qmk generate-mono-rle`.
+//
+// An image holds one or more frames (the glyphs of a font, the steps of an animation) in the buffer
+// layout of mono_surface: (height + 7) / 8 pages of width bytes.
+//
+//   byte 0      width of a frame
+//   byte 1      height of a frame, in pixels
+//   bytes 2, 3  number of frames, little endian
+//   byte 4      frames per block
+//   then        offset of each block in the token stream, 16 bit little endian
+//   then        token stream, the frames one after the other
+//
+// A token 0x00-0x7F is followed by token + 1 bytes that are copied, a token 0x80-0xFF by one byte
+// that is repeated token - 0x80 + 2 times. Blocks start with a new token, so any frame is found by
+// skipping over the frames before it in its block.
+
+#define MONO_RLE_HEADER_SIZE 5
+
+typedef struct {
+    const uint8_t *data;  // next byte of the token stream
+    uint8_t        count; // bytes left of the current token
+    uint8_t        value; // repeated byte of a run
+    bool           run;
+} mono_rle_reader_t;
+
+uint8_t  mono_rle_width(const uint8_t *image);
+uint8_t  mono_rle_height(const uint8_t *image);
+uint16_t mono_rle_frame_count(const uint8_t *image);
+uint16_t mono_rle_frame_size(const uint8_t *image);
+
+// Positions the reader at the first byte of a frame
+// Returns false if the image has no such frame
+bool mono_rle_open(mono_rle_reader_t *reader, const uint8_t *image, uint16_t frame);
+
+void mono_rle_next_token(mono_rle_reader_t *reader);
+void mono_rle_skip(mono_rle_reader_t *reader, uint16_t count);
+void mono_rle_decode(mono_rle_reader_t *reader, uint8_t *dest, uint16_t count);
+
+// Next decoded byte, reading past the end of the image is not checked
+static inline uint8_t mono_rle_read(mono_rle_reader_t *reader) {
+    if (!reader->count) {
+        mono_rle_next_token(reader);
+    }
+    reader->count--;
+    return reader->run ? reader->value : pgm_read_byte(reader->data++);
+}
@@ -0,0 +1,848 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mono_surface.h"
+
+#include <string.h>
+
+#include "progmem.h"
+
+#define SURFACE_SIZE(surface) ((uint16_t)(surface)->width * (surface)->pages)
+
+#ifdef MONO_SURFACE_ROTATION
+#    define IS_ROTATED(surface) ((surface)->rotated)
+#else
+#    define IS_ROTATED(surface) false
+#endif
+
+// Glyphs drawn by mono_surface_draw_glyphs are collected into runs of this many columns
+#ifndef MONO_SURFACE_GLYPH_RUN
+#    define MONO_SURFACE_GLYPH_RUN 32
+#endif
+
+// Neighbouring columns of a page, handled at once with word operations. The bytes keep
+// the order of the buffer, and no operation crosses from one byte into the next.
+#define LANE_COUNT 4
+#define LANES(value) ((uint32_t)(uint8_t)(value)*0x01010101UL)
+
+typedef union {
+    uint32_t word;
+    uint8_t  bytes[LANE_COUNT];
+} lanes_t;
+
+// Bitmap in the buffer layout, image is NULL for a filled rectangle
+typedef struct {
+    const uint8_t *image;
+    const uint8_t *mask;
+    uint8_t        width;
+    uint8_t        height;
+    bool           progmem;
+} bitmap_t;
+
+uint8_t mono_surface_width(const mono_surface_t *surface) {
+    return IS_ROTATED(surface) ? surface->pages * 8 : surface->width;
+}
+
+uint8_t mono_surface_height(const mono_surface_t *surface) {
+    return IS_ROTATED(surface) ? surface->width : surface->pages * 8;
+}
+
+static inline void mark_span(mono_surface_t *surface, uint8_t page, uint8_t start, uint8_t end) {
+    if (surface->span_start[page] > start) {
+        surface->span_start[page] = start;
+    }
+    if (surface->span_end[page] < end) {
+        surface->span_end[page] = end;
+    }
+}
+
+void mono_surface_mark_dirty(mono_surface_t *surface, uint16_t index, uint16_t length) {
+    uint8_t page   = index / surface->width;
+    uint8_t column = index % surface->width;
+    while (length && page < surface->pages) {
+        uint8_t end = length < surface->width - column ? column + length : surface->width;
+        mark_span(surface, page, column, end);
+        length -= end - column;
+        column = 0;
+        ++page;
+    }
+}
+
+void mono_surface_mark_all_dirty(mono_surface_t *surface) {
+    memset(surface->span_start, 0, surface->pages);
+    memset(surface->span_end, surface->width, surface->pages);
+}
+
+void mono_surface_mark_window(mono_surface_t *surface, const mono_window_t *window) {
+    for (uint8_t page = window->first_page; page <= window->last_page; ++page) {
+        mark_span(surface, page, window->start, window->end);
+    }
+}
+
+// Takes a sent run of columns out of the span of each page, a run in the middle of a span leaves it whole
+void mono_surface_mark_clean(mono_surface_t *surface, uint16_t index, uint16_t length) {
+    uint8_t page   = index / surface->width;
+    uint8_t column = index % surface->width;
+    while (length && page < surface->pages) {
+        uint8_t  end        = length < surface->width - column ? column + length : surface->width;
+        uint8_t *span_start = &surface->span_start[page];
+        uint8_t *span_end   = &surface->span_end[page];
+        if (column <= *span_start && end >= *span_end) {
+            *span_start = surface->width;
+            *span_end   = 0;
+        } else if (column <= *span_start && end > *span_start) {
+            *span_start = end;
+        } else if (end >= *span_end && column < *span_end) {
+            *span_end = column;
+        }
+        length -= end - column;
+        column = 0;
+        ++page;
+    }
+}
+
+bool mono_surface_is_dirty(const mono_surface_t *surface) {
+    for (uint8_t page = 0; page < surface->pages; ++page) {
+        if (surface->span_start[page] < surface->span_end[page]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool mono_surface_is_range_dirty(const mono_surface_t *surface, uint16_t index, uint16_t length) {
+    uint8_t page   = index / surface->width;
+    uint8_t column = index % surface->width;
+    while (length && page < surface->pages) {
+        uint8_t end        = length < surface->width - column ? column + length : surface->width;
+        uint8_t span_start = surface->span_start[page];
+        uint8_t span_end   = surface->span_end[page];
+        if (span_start < span_end && span_start < end && span_end > column) {
+            return true;
+        }
+        length -= end - column;
+        column = 0;
+        ++page;
+    }
+    return false;
+}
+
+uint16_t mono_surface_copy_window(const mono_surface_t *surface, const mono_window_t *window, uint8_t *dest) {
+    uint8_t  width  = window->end - window->start;
+    uint16_t length = 0;
+    for (uint8_t page = window->first_page; page <= window->last_page; ++page) {
+        memcpy(&dest[length], &surface->buffer[page * surface->width + window->start], width);
+        length += width;
+    }
+    return length;
+}
+
+// Picks the next part of the buffer to send: the first changed page, joined by the
+// pages below it as long as one window is cheaper than separate ones.
+static bool find_window(const mono_surface_t *surface, const mono_flush_driver_t *driver, mono_window_t *window) {
+    uint8_t page = 0;
+    while (page < surface->pages && surface->span_start[page] >= surface->span_end[page]) {
+        ++page;
+    }
+    if (page == surface->pages) {
+        return false;
+    }
+
+    window->first_page = page;
+    window->last_page  = page;
+    window->start      = surface->span_start[page];
+    window->end        = surface->span_end[page];
+    if (window->end - window->start > driver->window_size) {
+        window->end = window->start + driver->window_size;
+    }
+
+    if (!driver->join_pages) {
+        return true;
+    }
+
+    while (++page < surface->pages && surface->span_start[page] < surface->span_end[page]) {
+        uint8_t  start    = surface->span_start[page] < window->start ? surface->span_start[page] : window->start;
+        uint8_t  end      = surface->span_end[page] > window->end ? surface->span_end[page] : window->end;
+        uint8_t  pages    = page - window->first_page;
+        uint16_t merged   = (pages + 1) * (end - start);
+        uint16_t separate = pages * (window->end - window->start) + (surface->span_end[page] - surface->span_start[page]) + driver->window_overhead;
+        if (merged > driver->window_size || merged > separate) {
+            break;
+        }
+        window->last_page = page;
+        window->start     = start;
+        window->end       = end;
+    }
+    return true;
+}
+
+bool mono_surface_flush(mono_surface_t *surface, const mono_flush_driver_t *driver) {
+    mono_window_t window;
+    if (!find_window(surface, driver, &window) || !driver->send(surface, &window)) {
+        return false;
+    }
+
+    // Pages can only be partly covered when they are wider than the window size
+    for (uint8_t page = window.first_page; page <= window.last_page; ++page) {
+        mono_surface_mark_clean(surface, page * surface->width + window.start, window.end - window.start);
+    }
+    return true;
+}
+
+void mono_surface_clear(mono_surface_t *surface) {
+    memset(surface->buffer, 0, SURFACE_SIZE(surface));
+    surface->cursor = 0;
+    mono_surface_mark_all_dirty(surface);
+}
+
+#ifdef MONO_SURFACE_ROTATION
+// Spreads the bits of a nibble over the lowest bit of four bytes
+static const uint32_t PROGMEM nibble_spread[16] = {
+    0x00000000, 0x00000001, 0x00000100, 0x00000101, 0x00010000, 0x00010001, 0x00010100, 0x00010101,
+    0x01000000, 0x01000001, 0x01000100, 0x01000101, 0x01010000, 0x01010001, 0x01010100, 0x01010101,
+};
+
+// Stores count bytes of the rotated image, starting at index and all on the same line of it, in the
+// buffer. Rotated column x is buffer row pages * 8 - 1 - x, and the 8 bits of a byte end up in the
+// same row of 8 neighbouring buffer columns.
+static bool write_rotated(mono_surface_t *surface, uint16_t index, const uint8_t *data, uint8_t count) {
+    uint8_t height = surface->pages * 8;
+    uint8_t x      = index % height;
+    if (x + count > height) {
+        count = height - x;
+    }
+
+    // Transpose with the first byte in the top bit, bit i of each byte goes to rows[i] (little endian)
+    union {
+        uint32_t spread[2];
+        uint8_t  rows[8];
+    } transposed = {{0, 0}};
+    for (uint8_t i = 0; i < count; ++i) {
+        transposed.spread[0] = transposed.spread[0] << 1 | pgm_read_dword(&nibble_spread[data[i] & 0x0F]);
+        transposed.spread[1] = transposed.spread[1] << 1 | pgm_read_dword(&nibble_spread[data[i] >> 4]);
+    }
+
+    uint8_t  row     = height - x - count;
+    uint8_t  shift   = row % 8;
+    uint16_t mask    = ((1 << count) - 1) << shift;
+    uint16_t start   = row / 8 * surface->width + index / height * 8;
+    uint8_t *dest    = &surface->buffer[start];
+    uint8_t  changed = 0;
+    for (uint8_t i = 0; i < 8; ++i) {
+        uint8_t value = (dest[i] & ~mask) | transposed.rows[i] << shift;
+        changed |= dest[i] ^ value;
+        dest[i] = value;
+    }
+    if (changed) {
+        mono_surface_mark_dirty(surface, start, 8);
+    }
+
+    // Spills over into the next page
+    if (mask > 0xFF) {
+        uint8_t spilled = 0;
+        dest += surface->width;
+        for (uint8_t i = 0; i < 8; ++i) {
+            uint8_t value = (dest[i] & ~(mask >> 8)) | transposed.rows[i] >> (8 - shift);
+            spilled |= dest[i] ^ value;
+            dest[i] = value;
+        }
+        if (spilled) {
+            mono_surface_mark_dirty(surface, start + surface->width, 8);
+        }
+        changed |= spilled;
+    }
+    return changed;
+}
+
+// Panning the rotated image moves every buffer column up or down by a pixel
+static void pan_rotated(mono_surface_t *surface, bool left) {
+    uint8_t last = surface->pages - 1;
+    for (uint8_t x = 0; x < surface->width; x++) {
+        uint8_t *column = &surface->buffer[x];
+        if (left) {
+            for (uint8_t page = last; page > 0; page--) {
+                column[page * surface->width] = column[page * surface->width] << 1 | column[(page - 1) * surface->width] >> 7;
+            }
+            column[0] = column[0] << 1 | (column[0] & 0x01);
+        } else {
+            for (uint8_t page = 0; page < last; page++) {
+                column[page * surface->width] = column[page * surface->width] >> 1 | column[(page + 1) * surface->width] << 7;
+            }
+            column[last * surface->width] = column[last * surface->width] >> 1 | (column[last * surface->width] & 0x80);
+        }
+    }
+}
+#endif
+
+void mono_surface_set_cursor(mono_surface_t *surface, uint8_t col, uint8_t line) {
+    uint16_t index = line * mono_surface_width(surface) + col * surface->font_width;
+
+    // Out of bounds?
+    if (index >= SURFACE_SIZE(surface)) {
+        index = 0;
+    }
+
+    surface->cursor = index;
+}
+
+bool mono_surface_advance_page(mono_surface_t *surface, bool clearPageRemainder) {
+    uint8_t  line_width = mono_surface_width(surface);
+    uint16_t index      = surface->cursor;
+    uint8_t  remaining  = line_width - (index % line_width);
+
+    if (clearPageRemainder) {
+        // Remaining Char count
+        remaining = remaining / surface->font_width;
+
+        // Write empty character until next line
+        bool changed = false;
+        while (remaining--) {
+            changed |= mono_surface_write_char(surface, ' ', false);
+        }
+        return changed;
+    }
+
+    // Next page index out of bounds?
+    if (index + remaining >= SURFACE_SIZE(surface)) {
+        index     = 0;
+        remaining = 0;
+    }
+
+    surface->cursor = index + remaining;
+    return false;
+}
+
+void mono_surface_advance_char(mono_surface_t *surface) {
+    uint8_t  line_width     = mono_surface_width(surface);
+    uint16_t nextIndex      = surface->cursor + surface->font_width;
+    uint8_t  remainingSpace = line_width - (nextIndex % line_width);
+
+    // Do we have enough space on the current line for the next character
+    if (remainingSpace < surface->font_width) {
+        nextIndex += remainingSpace;
+    }
+
+    // Did we go out of bounds
+    if (nextIndex >= SURFACE_SIZE(surface)) {
+        nextIndex = 0;
+    }
+
+    // Update cursor position
+    surface->cursor = nextIndex;
+}
+
+// Reads the columns of a glyph one after the other, characters outside of the font are empty
+typedef struct {
+    const uint8_t *   data; // raw font columns, NULL for an empty glyph
+    mono_rle_reader_t rle;  // used instead of data for compressed fonts
+    bool              compressed;
+} glyph_t;
+
+static inline void find_glyph(const mono_surface_t *surface, uint8_t data, glyph_t *glyph) {
+    glyph->data       = NULL;
+    glyph->compressed = false;
+    if (data < surface->font_start || data > surface->font_end) {
+        return;
+    }
+    if (surface->font_rle) {
+        glyph->compressed = mono_rle_open(&glyph->rle, surface->font, data - surface->font_start);
+        return;
+    }
+    glyph->data = &surface->font[(data - surface->font_start) * surface->font_width];
+}
+
+static inline uint8_t glyph_column(glyph_t *glyph) {
+    if (glyph->compressed) {
+        return mono_rle_read(&glyph->rle);
+    }
+    return glyph->data ? pgm_read_byte(glyph->data++) : 0x00;
+}
+
+// Main handler that writes character data to the buffer
+bool mono_surface_write_char(mono_surface_t *surface, const char data, bool invert) {
+    // Advance to the next line if newline
+    if (data == '\n') {
+        // Old source wrote ' ' until end of line...
+        return mono_surface_advance_page(surface, true);
+    }
+
+    if (data == '\r') {
+        mono_surface_advance_page(surface, false);
+        return false;
+    }
+
+    glyph_t glyph;
+    uint8_t flip    = invert ? 0xFF : 0x00;
+    uint8_t changed = 0;
+    find_glyph(surface, (uint8_t)data, &glyph); // font based on unsigned type for index
+
+#ifdef MONO_SURFACE_ROTATION
+    if (surface->rotated) {
+        uint8_t columns[8];
+        uint8_t count = surface->font_width < sizeof(columns) ? surface->font_width : sizeof(columns);
+        for (uint8_t i = 0; i < count; ++i) {
+            columns[i] = glyph_column(&glyph) ^ flip;
+        }
+        changed = write_rotated(surface, surface->cursor, columns, count);
+        mono_surface_advance_char(surface);
+        return changed;
+    }
+#endif
+
+    // Compare while writing, so rewriting what is already on screen leaves it clean
+    uint8_t *dest  = &surface->buffer[surface->cursor];
+    uint8_t  count = surface->font_width;
+    if (surface->cursor + count > SURFACE_SIZE(surface)) {
+        count = SURFACE_SIZE(surface) - surface->cursor;
+    }
+    for (uint8_t i = 0; i < count; ++i) {
+        uint8_t value = glyph_column(&glyph) ^ flip;
+        changed |= dest[i] ^ value;
+        dest[i] = value;
+    }
+    if (changed) {
+        mono_surface_mark_dirty(surface, surface->cursor, count);
+    }
+
+    // Finally move to the next char
+    mono_surface_advance_char(surface);
+    return changed;
+}
+
+bool mono_surface_write_raw_byte(mono_surface_t *surface, uint8_t data, uint16_t index) {
+    if (index >= SURFACE_SIZE(surface)) {
+        return false;
+    }
+#ifdef MONO_SURFACE_ROTATION
+    if (surface->rotated) {
+        return write_rotated(surface, index, &data, 1);
+    }
+#endif
+    if (surface->buffer[index] == data) {
+        return false;
+    }
+    surface->buffer[index] = data;
+    mono_surface_mark_dirty(surface, index, 1);
+    return true;
+}
+
+static bool write_raw(mono_surface_t *surface, const uint8_t *data, uint16_t size, bool progmem) {
+    uint16_t start   = surface->cursor;
+    bool     changed = false;
+    if (size + start > SURFACE_SIZE(surface)) {
+        size = SURFACE_SIZE(surface) - start;
+    }
+    for (uint16_t i = start; i < start + size; i++) {
+        uint8_t c = progmem ? pgm_read_byte(data) : *data;
+        data++;
+        changed |= mono_surface_write_raw_byte(surface, c, i);
+    }
+    return changed;
+}
+
+bool mono_surface_write_raw(mono_surface_t *surface, const uint8_t *data, uint16_t size) {
+    return write_raw(surface, data, size, false);
+}
+
+bool mono_surface_write_pixel(mono_surface_t *surface, uint8_t x, uint8_t y, bool on) {
+    if (x >= mono_surface_width(surface) || y >= mono_surface_height(surface)) {
+        return false;
+    }
+#ifdef MONO_SURFACE_ROTATION
+    if (surface->rotated) {
+        uint8_t column = y;
+        y              = surface->pages * 8 - 1 - x;
+        x              = column;
+    }
+#endif
+    uint16_t index = x + (y / 8) * surface->width;
+    uint8_t  bit   = 1 << (y % 8);
+    uint8_t  data  = on ? surface->buffer[index] | bit : surface->buffer[index] & ~bit;
+    if (surface->buffer[index] == data) {
+        return false;
+    }
+    surface->buffer[index] = data;
+    mono_surface_mark_dirty(surface, index, 1);
+    return true;
+}
+
+void mono_surface_pan(mono_surface_t *surface, bool left) {
+#ifdef MONO_SURFACE_ROTATION
+    if (surface->rotated) {
+        pan_rotated(surface, left);
+        mono_surface_mark_all_dirty(surface);
+        return;
+    }
+#endif
+    for (uint8_t page = 0; page < surface->pages; page++) {
+        uint8_t *row = &surface->buffer[page * surface->width];
+        if (left) {
+            memmove(row, row + 1, surface->width - 1);
+        } else {
+            memmove(row + 1, row, surface->width - 1);
+        }
+    }
+    mono_surface_mark_all_dirty(surface);
+}
+
+// Loads count columns of a bitmap page, pages outside of the bitmap are empty
+static inline uint32_t load_page(const bitmap_t *bitmap, const uint8_t *data, uint8_t page, uint8_t column, uint8_t count) {
+    lanes_t lanes = {0};
+    if (page >= (bitmap->height + 7) / 8) {
+        return 0;
+    }
+    if (!data) {
+        return LANES(0xFF);
+    }
+    data += page * bitmap->width + column;
+    if (bitmap->progmem) {
+        memcpy_P(lanes.bytes, data, count);
+    } else {
+        memcpy(lanes.bytes, data, count);
+    }
+    return lanes.word;
+}
+
+// Bitmap page moved down by shift rows into a buffer page, which also gets the bottom of the page above it
+static inline uint32_t load_shifted(const bitmap_t *bitmap, const uint8_t *data, uint8_t page, uint8_t shift, uint8_t column, uint8_t count) {
+    uint32_t lanes = load_page(bitmap, data, page, column, count);
+    if (!shift) {
+        return lanes;
+    }
+    lanes = lanes << shift & LANES(0xFF << shift);
+    if (page > 0) {
+        lanes |= load_page(bitmap, data, page - 1, column, count) >> (8 - shift) & LANES(0xFF >> (8 - shift));
+    }
+    return lanes;
+}
+
+// Rows of a bitmap page that belong to the bitmap
+static inline uint8_t page_rows(const bitmap_t *bitmap, uint8_t page) {
+    uint8_t pages = (bitmap->height + 7) / 8;
+    if (page >= pages) {
+        return 0x00;
+    }
+    if (page == pages - 1 && bitmap->height % 8) {
+        return (1 << (bitmap->height % 8)) - 1;
+    }
+    return 0xFF;
+}
+
+// Combines a bitmap with the buffer, a word of columns at a time
+static bool blit_buffer(mono_surface_t *surface, uint8_t x, uint8_t y, const bitmap_t *bitmap, mono_blit_op_t op) {
+    uint8_t  shift     = y % 8;
+    uint8_t  top_page  = y / 8;
+    uint16_t last_row  = y + bitmap->height - 1;
+    uint8_t  last_page = last_row / 8 < surface->pages ? last_row / 8 : surface->pages - 1;
+    uint8_t  end       = bitmap->width < surface->width - x ? x + bitmap->width : surface->width;
+    bool     changed   = false;
+
+    for (uint8_t page = top_page; page <= last_page; ++page) {
+        uint8_t source = page - top_page;
+        uint8_t rows   = page_rows(bitmap, source) << shift;
+        if (shift && source > 0) {
+            rows |= page_rows(bitmap, source - 1) >> (8 - shift);
+        }
+        uint32_t cover = LANES(rows);
+
+        uint8_t *dest  = &surface->buffer[page * surface->width];
+        uint8_t  first = surface->width;
+        uint8_t  last  = 0;
+        for (uint16_t column = x; column < end; column += LANE_COUNT) {
+            uint8_t count = end - column < LANE_COUNT ? end - column : LANE_COUNT;
+            lanes_t old   = {0};
+            lanes_t new;
+            memcpy(old.bytes, &dest[column], count);
+
+            uint32_t image = load_shifted(bitmap, bitmap->image, source, shift, column - x, count) & cover;
+            if (bitmap->mask) {
+                uint32_t mask = load_shifted(bitmap, bitmap->mask, source, shift, column - x, count) & cover;
+                new.word      = (old.word & ~mask) | (image & mask);
+            } else {
+                switch (op) {
+                    case MONO_BLIT_SET:
+                        new.word = old.word | image;
+                        break;
+                    case MONO_BLIT_CLEAR:
+                        new.word = old.word & ~image;
+                        break;
+                    case MONO_BLIT_INVERT:
+                        new.word = old.word ^ image;
+                        break;
+                    default:
+                        new.word = (old.word & ~cover) | image;
+                        break;
+                }
+            }
+
+            if (new.word == old.word) {
+                continue;
+            }
+            memcpy(&dest[column], new.bytes, count);
+            for (uint8_t i = 0; i < count; ++i) {
+                if (new.bytes[i] != old.bytes[i]) {
+                    if (first > column + i) {
+                        first = column + i;
+                    }
+                    last = column + i;
+                }
+            }
+        }
+
+        if (first <= last) {
+            mark_span(surface, page, first, last + 1);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+#ifdef MONO_SURFACE_ROTATION
+static bool read_pixel(const mono_surface_t *surface, uint8_t x, uint8_t y) {
+    uint8_t row = surface->pages * 8 - 1 - x;
+    return surface->buffer[y + (row / 8) * surface->width] & (1 << (row % 8));
+}
+
+// Bitmaps don't line up with the buffer pages in the rotated image, so they are drawn pixel by pixel
+static bool blit_rotated(mono_surface_t *surface, uint8_t x, uint8_t y, const bitmap_t *bitmap, mono_blit_op_t op) {
+    uint8_t width   = mono_surface_width(surface) - x;
+    uint8_t height  = mono_surface_height(surface) - y;
+    bool    changed = false;
+    for (uint8_t column = 0; column < bitmap->width && column < width; ++column) {
+        for (uint8_t row = 0; row < bitmap->height && row < height; ++row) {
+            uint8_t bit   = 1 << (row % 8);
+            bool    pixel = load_page(bitmap, bitmap->image, row / 8, column, 1) & bit;
+            if (bitmap->mask) {
+                if (load_page(bitmap, bitmap->mask, row / 8, column, 1) & bit) {
+                    changed |= mono_surface_write_pixel(surface, x + column, y + row, pixel);
+                }
+                continue;
+            }
+            switch (op) {
+                case MONO_BLIT_SET:
+                    if (pixel) {
+                        changed |= mono_surface_write_pixel(surface, x + column, y + row, true);
+                    }
+                    break;
+                case MONO_BLIT_CLEAR:
+                    if (pixel) {
+                        changed |= mono_surface_write_pixel(surface, x + column, y + row, false);
+                    }
+                    break;
+                case MONO_BLIT_INVERT:
+                    if (pixel) {
+                        changed |= mono_surface_write_pixel(surface, x + column, y + row, !read_pixel(surface, x + column, y + row));
+                    }
+                    break;
+                default:
+                    changed |= mono_surface_write_pixel(surface, x + column, y + row, pixel);
+                    break;
+            }
+        }
+    }
+    return changed;
+}
+#endif
+
+static bool blit(mono_surface_t *surface, uint8_t x, uint8_t y, const bitmap_t *bitmap, mono_blit_op_t op) {
+    if (x >= mono_surface_width(surface) || y >= mono_surface_height(surface) || !bitmap->width || !bitmap->height) {
+        return false;
+    }
+#ifdef MONO_SURFACE_ROTATION
+    if (surface->rotated) {
+        return blit_rotated(surface, x, y, bitmap, op);
+    }
+#endif
+    return blit_buffer(surface, x, y, bitmap, op);
+}
+
+bool mono_surface_fill_rect(mono_surface_t *surface, uint8_t x, uint8_t y, uint8_t width, uint8_t height, bool on) {
+    uint8_t image_width  = mono_surface_width(surface);
+    uint8_t image_height = mono_surface_height(surface);
+    if (x >= image_width || y >= image_height) {
+        return false;
+    }
+    if (width > image_width - x) {
+        width = image_width - x;
+    }
+    if (height > image_height - y) {
+        height = image_height - y;
+    }
+
+#ifdef MONO_SURFACE_ROTATION
+    // A rectangle stays one in the buffer, only turned
+    if (surface->rotated) {
+        uint8_t column = y;
+        y              = image_width - x - width;
+        x              = column;
+        column         = width;
+        width          = height;
+        height         = column;
+    }
+#endif
+
+    bitmap_t bitmap = {.width = width, .height = height};
+    if (!width || !height) {
+        return false;
+    }
+    return blit_buffer(surface, x, y, &bitmap, on ? MONO_BLIT_SET : MONO_BLIT_CLEAR);
+}
+
+bool mono_surface_blit(mono_surface_t *surface, uint8_t x, uint8_t y, const uint8_t *bitmap, uint8_t width, uint8_t height, mono_blit_op_t op) {
+    bitmap_t source = {.image = bitmap, .width = width, .height = height};
+    return blit(surface, x, y, &source, op);
+}
+
+bool mono_surface_draw_sprite(mono_surface_t *surface, uint8_t x, uint8_t y, const uint8_t *image, const uint8_t *mask, uint8_t width, uint8_t height) {
+    bitmap_t source = {.image = image, .mask = mask, .width = width, .height = height};
+    return blit(surface, x, y, &source, MONO_BLIT_COPY);
+}
+
+bool mono_surface_draw_glyphs(mono_surface_t *surface, uint8_t x, uint8_t y, const char *data, bool invert) {
+    uint8_t run[MONO_SURFACE_GLYPH_RUN];
+    uint8_t flip        = invert ? 0xFF : 0x00;
+    uint8_t image_width = mono_surface_width(surface);
+    bool    changed     = false;
+
+    if (!surface->font_width || surface->font_width > sizeof(run)) {
+        return false;
+    }
+
+    // Glyphs are collected into a run, which is drawn as one bitmap
+    while (*data && x < image_width) {
+        uint8_t length = 0;
+        while (*data && length + surface->font_width <= sizeof(run)) {
+            glyph_t glyph;
+            find_glyph(surface, (uint8_t)*data++, &glyph);
+            for (uint8_t i = 0; i < surface->font_width; ++i) {
+                run[length++] = glyph_column(&glyph) ^ flip;
+            }
+        }
+
+        bitmap_t bitmap = {.image = run, .width = length, .height = 8};
+        changed |= blit(surface, x, y, &bitmap, MONO_BLIT_COPY);
+        if (length >= image_width - x) {
+            break;
+        }
+        x += length;
+    }
+    return changed;
+}
+
+bool mono_surface_write_rle(mono_surface_t *surface, const uint8_t *image, uint16_t frame) {
+    mono_rle_reader_t reader;
+    if (!mono_rle_open(&reader, image, frame)) {
+        return false;
+    }
+
+    uint16_t index   = surface->cursor;
+    uint16_t end     = index + mono_rle_frame_size(image);
+    bool     changed = false;
+    if (end > SURFACE_SIZE(surface)) {
+        end = SURFACE_SIZE(surface);
+    }
+
+#ifdef MONO_SURFACE_ROTATION
+    if (surface->rotated) {
+        // In pieces of up to 8 bytes on the same line of the rotated image
+        uint8_t height = surface->pages * 8;
+        while (index < end) {
+            uint8_t piece[8];
+            uint8_t count = height - index % height;
+            if (count > sizeof(piece)) {
+                count = sizeof(piece);
+            }
+            if (count > end - index) {
+                count = end - index;
+            }
+            mono_rle_decode(&reader, piece, count);
+            changed |= write_rotated(surface, index, piece, count);
+            index += count;
+        }
+        return changed;
+    }
+#endif
+
+    // Compare while decoding, page by page to mark only the columns that changed
+    while (index < end) {
+        uint8_t  page   = index / surface->width;
+        uint8_t *dest   = &surface->buffer[page * surface->width];
+        uint16_t column = index % surface->width;
+        uint16_t stop   = end - page * surface->width < surface->width ? end - page * surface->width : surface->width;
+        uint8_t  first  = surface->width;
+        uint8_t  last   = 0;
+        for (; column < stop; ++column) {
+            uint8_t value = mono_rle_read(&reader);
+            if (dest[column] != value) {
+                dest[column] = value;
+                if (first > column) {
+                    first = column;
+                }
+                last = column;
+            }
+        }
+        if (first <= last) {
+            mark_span(surface, page, first, last + 1);
+            changed = true;
+        }
+        index = (page + 1) * surface->width;
+    }
+    return changed;
+}
+
+bool mono_surface_draw_rle(mono_surface_t *surface, uint8_t x, uint8_t y, const uint8_t *image, uint16_t frame, mono_blit_op_t op) {
+    mono_rle_reader_t reader;
+    if (!mono_rle_open(&reader, image, frame)) {
+        return false;
+    }
+
+    // Decoded in pieces of a page, which are blitted one after the other
+    uint8_t width   = mono_rle_width(image);
+    uint8_t height  = mono_rle_height(image);
+    bool    changed = false;
+    for (uint8_t row = 0; row < height; row += 8) {
+        for (uint8_t column = 0; column < width;) {
+            uint8_t piece[MONO_SURFACE_GLYPH_RUN];
+            uint8_t count = width - column < MONO_SURFACE_GLYPH_RUN ? width - column : MONO_SURFACE_GLYPH_RUN;
+            mono_rle_decode(&reader, piece, count);
+            if (x + column < 256 && y + row < 256) {
+                bitmap_t bitmap = {.image = piece, .width = count, .height = height - row < 8 ? height - row : 8};
+                changed |= blit(surface, x + column, y + row, &bitmap, op);
+            }
+            column += count;
+        }
+        if (height - row <= 8) {
+            break;
+        }
+    }
+    return changed;
+}
+
+#if defined(__AVR__)
+bool mono_surface_write_raw_P(mono_surface_t *surface, const uint8_t *data, uint16_t size) {
+    return write_raw(surface, data, size, true);
+}
+
+bool mono_surface_blit_P(mono_surface_t *surface, uint8_t x, uint8_t y, const uint8_t *bitmap, uint8_t width, uint8_t height, mono_blit_op_t op) {
+    bitmap_t source = {.image = bitmap, .width = width, .height = height, .progmem = true};
+    return blit(surface, x, y, &source, op);
+}
+
+bool mono_surface_draw_sprite_P(mono_surface_t *surface, uint8_t x, uint8_t y, const uint8_t *image, const uint8_t *mask, uint8_t width, uint8_t height) {
+    bitmap_t source = {.image = image, .mask = mask, .width = width, .height = height, .progmem = true};
+    return blit(surface, x, y, &source, MONO_BLIT_COPY);
+}
+#endif // defined(__AVR__)
@@ -0,0 +1,139 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "mono_rle.h"
+
+// Framebuffer shared by the monochrome display drivers (SSD1306/SH1106 OLED, ST7565 LCD).
+//
+// The buffer has the memory layout of these panels: pages of 8 pixel rows, one byte per
+// column and page, with bit 0 of a byte being its top pixel. Changes are tracked as a span
+// of columns per page, which a panel driver sends as windows through mono_surface_flush.
+
+// Drawing in the image turned by 90 degrees, rotated right into the buffer on write
+#if defined(OLED_ROTATE_ON_WRITE) && !defined(MONO_SURFACE_ROTATION)
+#    define MONO_SURFACE_ROTATION
+#endif
+
+typedef struct {
+    uint8_t *      buffer;     // pages * width bytes
+    uint8_t *      span_start; // changed columns of each page, [start, end) is empty when clean
+    uint8_t *      span_end;
+    const uint8_t *font;       // PROGMEM, font_width bytes per glyph, or compressed with one frame per glyph
+    uint16_t       cursor;     // text cursor, index into the drawn image
+    uint8_t        width;      // in pixels, which is also the size of a page
+    uint8_t        pages;      // height in pixels / 8
+    uint8_t        font_width;
+    uint8_t        font_start;
+    uint8_t        font_end;
+    bool           font_rle;
+#ifdef MONO_SURFACE_ROTATION
+    bool rotated; // draw in the image turned by 90 degrees, which is pages * 8 wide and width high
+#endif
+} mono_surface_t;
+
+// Part of the buffer sent to the panel at once, the same columns of one or more pages
+typedef struct {
+    uint8_t first_page;
+    uint8_t last_page;
+    uint8_t start;
+    uint8_t end;
+} mono_window_t;
+
+// Sends windows of a surface to a panel
+typedef struct {
+    uint16_t window_size;     // Most data bytes sent at once
+    uint8_t  window_overhead; // Bytes a window costs besides its data, to decide on joining pages
+    bool     join_pages;      // Whether the panel continues on the next page after the last column of a window
+    // Returns true when the window was sent (or queued), the surface then marks it as clean
+    bool (*send)(const mono_surface_t *surface, const mono_window_t *window);
+} mono_flush_driver_t;
+
+// How a bitmap is combined with the pixels below it
+typedef enum {
+    MONO_BLIT_COPY,   // Replaces the covered area
+    MONO_BLIT_SET,    // Turns on the pixels set in the bitmap
+    MONO_BLIT_CLEAR,  // Turns off the pixels set in the bitmap
+    MONO_BLIT_INVERT, // Flips the pixels set in the bitmap
+} mono_blit_op_t;
+
+// Width and height of the drawn image, which differs from the buffer when rotated
+uint8_t mono_surface_width(const mono_surface_t *surface);
+uint8_t mono_surface_height(const mono_surface_t *surface);
+
+// Clears the buffer, resets the cursor and marks everything for sending
+void mono_surface_clear(mono_surface_t *surface);
+
+// Dirty tracking, index and length refer to the buffer
+void mono_surface_mark_dirty(mono_surface_t *surface, uint16_t index, uint16_t length);
+void mono_surface_mark_all_dirty(mono_surface_t *surface);
+void mono_surface_mark_window(mono_surface_t *surface, const mono_window_t *window);
+void mono_surface_mark_clean(mono_surface_t *surface, uint16_t index, uint16_t length);
+bool mono_surface_is_dirty(const mono_surface_t *surface);
+bool mono_surface_is_range_dirty(const mono_surface_t *surface, uint16_t index, uint16_t length);
+
+// Copies the data of a window page after page, returns the number of bytes
+uint16_t mono_surface_copy_window(const mono_surface_t *surface, const mono_window_t *window, uint8_t *dest);
+
+// Picks the next window to send and hands it to the driver
+// Returns true if a window was sent
+bool mono_surface_flush(mono_surface_t *surface, const mono_flush_driver_t *driver);
+
+// Text at the cursor, in cells of font_width columns and one page
+void mono_surface_set_cursor(mono_surface_t *surface, uint8_t col, uint8_t line);
+bool mono_surface_advance_page(mono_surface_t *surface, bool clearPageRemainder);
+void mono_surface_advance_char(mono_surface_t *surface);
+
+// The write functions return true if they changed the buffer
+bool mono_surface_write_char(mono_surface_t *surface, const char data, bool invert);
+bool mono_surface_write_raw_byte(mono_surface_t *surface, uint8_t data, uint16_t index);
+bool mono_surface_write_raw(mono_surface_t *surface, const uint8_t *data, uint16_t size);
+bool mono_surface_write_pixel(mono_surface_t *surface, uint8_t x, uint8_t y, bool on);
+void mono_surface_pan(mono_surface_t *surface, bool left);
+
+// Fills a rectangle of the drawn image, clipped at the right and bottom
+bool mono_surface_fill_rect(mono_surface_t *surface, uint8_t x, uint8_t y, uint8_t width, uint8_t height, bool on);
+
+// Draws a bitmap with the top left corner at x, y
+// Bitmaps have the buffer layout: (height + 7) / 8 pages of width bytes
+bool mono_surface_blit(mono_surface_t *surface, uint8_t x, uint8_t y, const uint8_t *bitmap, uint8_t width, uint8_t height, mono_blit_op_t op);
+
+// Draws a bitmap only where its mask is set, leaving the pixels around the shape alone
+bool mono_surface_draw_sprite(mono_surface_t *surface, uint8_t x, uint8_t y, const uint8_t *image, const uint8_t *mask, uint8_t width, uint8_t height);
+
+// Draws a string at any pixel position, independent of the cursor and the text cells
+bool mono_surface_draw_glyphs(mono_surface_t *surface, uint8_t x, uint8_t y, const char *data, bool invert);
+
+// Compressed images in PROGMEM, see mono_rle.h
+// Writes a frame at the cursor like mono_surface_write_raw_P, decoding straight into the buffer
+bool mono_surface_write_rle(mono_surface_t *surface, const uint8_t *image, uint16_t frame);
+// Draws a frame with the top left corner at x, y like mono_surface_blit
+bool mono_surface_draw_rle(mono_surface_t *surface, uint8_t x, uint8_t y, const uint8_t *image, uint16_t frame, mono_blit_op_t op);
+
+#if defined(__AVR__)
+// Same as above, for data in PROGMEM
+bool mono_surface_write_raw_P(mono_surface_t *surface, const uint8_t *data, uint16_t size);
+bool mono_surface_blit_P(mono_surface_t *surface, uint8_t x, uint8_t y, const uint8_t *bitmap, uint8_t width, uint8_t height, mono_blit_op_t op);
+bool mono_surface_draw_sprite_P(mono_surface_t *surface, uint8_t x, uint8_t y, const uint8_t *image, const uint8_t *mask, uint8_t width, uint8_t height);
+#else
+#    define mono_surface_write_raw_P(surface, data, size) mono_surface_write_raw(surface, data, size)
+#    define mono_surface_blit_P(surface, x, y, bitmap, width, height, op) mono_surface_blit(surface, x, y, bitmap, width, height, op)
+#    define mono_surface_draw_sprite_P(surface, x, y, image, mask, width, height) mono_surface_draw_sprite(surface, x, y, image, mask, width, height)
+#endif // defined(__AVR__)
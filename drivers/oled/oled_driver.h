@@ -19,6 +19,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "mono_surface.h"
+
 // an enumeration of the chips this driver supports
 #define OLED_IC_SSD1306 0
 #define OLED_IC_SH1106 1
@@ -244,6 +246,14 @@ void oled_write_raw_byte(const char data, uint16_t index);
 // Coordinates start at top-left and go right and down for positive x and y
 void oled_write_pixel(uint8_t x, uint8_t y, bool on);
 
+// Writes a frame of a compressed PROGMEM image (see `qmk generate-mono-rle`) to the buffer at current cursor position
+// Takes the place of oled_write_raw_P for logos and animations
+void oled_write_rle(const char *image, uint16_t frame);
+
+// Returns the surface behind the buffer, for the mono_surface_* drawing functions
+// (rectangles, bitmaps, sprites and text at any pixel position)
+mono_surface_t *oled_get_surface(void);
+
 #if defined(__AVR__)
 // Writes a PROGMEM string to the buffer at current cursor position
 // Advances the cursor while writing, inverts the pixels if true
@@ -92,6 +92,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define OLED_ALL_BLOCKS_MASK (((((OLED_BLOCK_TYPE)1 << (OLED_BLOCK_COUNT - 1)) - 1) << 1) | 1)
 
+#define OLED_PAGE_COUNT (OLED_DISPLAY_HEIGHT / 8)
+#ifdef OLED_ROTATE_ON_WRITE
+#    define OLED_SPAN_COUNT OLED_PAGE_COUNT
+#else
+// With 90 degree rotation the buffer holds the rotated image, which can have more pages
+#    define OLED_SPAN_COUNT ((OLED_DISPLAY_WIDTH > OLED_DISPLAY_HEIGHT ? OLED_DISPLAY_WIDTH : OLED_DISPLAY_HEIGHT) / 8)
+#endif
+#ifndef OLED_WINDOW_SIZE
+#    define OLED_WINDOW_SIZE OLED_BLOCK_SIZE
+#endif
+#define OLED_PACKET_SIZE ((OLED_WINDOW_SIZE > OLED_BLOCK_SIZE ? OLED_WINDOW_SIZE : OLED_BLOCK_SIZE) + 1)
+// Bytes a window costs besides its data: address & position commands, address & control byte of the data
+#define OLED_WINDOW_OVERHEAD 10
+
 // i2c defines
 #define I2C_CMD 0x00
 #define I2C_DATA 0x40
@@ -101,16 +115,28 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    define I2C_TRANSMIT_P(data) i2c_transmit((OLED_DISPLAY_ADDRESS << 1), &data[0], sizeof(data), OLED_I2C_TIMEOUT)
 #endif // defined(__AVR__)
 #define I2C_TRANSMIT(data) i2c_transmit((OLED_DISPLAY_ADDRESS << 1), &data[0], sizeof(data), OLED_I2C_TIMEOUT)
-#define I2C_WRITE_REG(mode, data, size) i2c_writeReg((OLED_DISPLAY_ADDRESS << 1), mode, data, size, OLED_I2C_TIMEOUT)
 
 #define HAS_FLAGS(bits, flags) ((bits & flags) == flags)
 
+// Whether oled_buffer holds the rotated image, which is only turned into the OLED memory layout on render
+#ifdef OLED_ROTATE_ON_WRITE
+#    define BUFFER_ROTATED false
+#else
+#    define BUFFER_ROTATED HAS_FLAGS(oled_rotation, OLED_ROTATION_90)
+#endif
+
+// Send blocks in the background if the platform supports it, unless the keyboard opts out
+#if defined(I2C_ASYNC_SUPPORTED) && !defined(OLED_NO_ASYNC_RENDER)
+#    define OLED_ASYNC_RENDER
+#endif
+
 // Display buffer's is the same as the OLED memory layout
 // this is so we don't end up with rounding errors with
 // parts of the display unusable or don't get cleared correctly
 // and also allows for drawing & inverting
+// oled_dirty only tells whether changes are waiting to be sent,
+// oled_surface keeps track of which ones
 uint8_t         oled_buffer[OLED_MATRIX_SIZE];
-uint8_t *       oled_cursor;
 OLED_BLOCK_TYPE oled_dirty          = 0;
 bool            oled_initialized    = false;
 bool            oled_active         = false;
@@ -132,6 +158,45 @@ uint32_t oled_scroll_timeout;
 uint16_t oled_update_timeout;
 #endif
 
+#ifndef OLED_FONT_RLE
+_Static_assert(sizeof(font) >= ((OLED_FONT_END + 1 - OLED_FONT_START) * OLED_FONT_WIDTH), "OLED_FONT_END references outside array");
+#endif
+#ifdef OLED_ROTATE_ON_WRITE
+_Static_assert(OLED_FONT_WIDTH <= 8, "OLED_ROTATE_ON_WRITE supports fonts up to 8 pixels wide");
+#endif
+
+static uint8_t oled_span_start[OLED_SPAN_COUNT];
+static uint8_t oled_span_end[OLED_SPAN_COUNT];
+
+// Cursor, text and drawing on oled_buffer, the geometry is set up by oled_init
+static mono_surface_t oled_surface = {
+    .buffer     = oled_buffer,
+    .span_start = oled_span_start,
+    .span_end   = oled_span_end,
+    .font       = font,
+    .width      = OLED_DISPLAY_WIDTH,
+    .pages      = OLED_PAGE_COUNT,
+    .font_width = OLED_FONT_WIDTH,
+    .font_start = OLED_FONT_START,
+    .font_end   = OLED_FONT_END,
+#ifdef OLED_FONT_RLE
+    .font_rle   = true,
+#endif
+};
+
+// Column & page position, followed by the control byte and a copy of the data, the buffer can change while it is sent
+static uint8_t       oled_render_position[] = {I2C_CMD, COLUMN_ADDR, 0, OLED_DISPLAY_WIDTH - 1, PAGE_ADDR, 0, OLED_DISPLAY_HEIGHT / 8 - 1};
+static uint8_t       oled_render_packet[OLED_PACKET_SIZE] = {I2C_DATA};
+static uint16_t      oled_render_length;
+static mono_window_t oled_render_window;
+#ifndef OLED_ROTATE_ON_WRITE
+static uint8_t oled_render_block;
+#endif
+#ifdef OLED_ASYNC_RENDER
+static volatile bool oled_render_busy   = false;
+static volatile bool oled_render_failed = false;
+#endif
+
 // Internal variables to reduce math instructions
 
 #if defined(__AVR__)
@@ -151,12 +216,9 @@ static i2c_status_t i2c_transmit_P(uint8_t address, const uint8_t *data, uint16_
 }
 #endif
 
-// Flips the rendering bits for a character at the current cursor position
-static void InvertCharacter(uint8_t *cursor) {
-    const uint8_t *end = cursor + OLED_FONT_WIDTH;
-    while (cursor < end) {
-        *cursor = ~(*cursor);
-        cursor++;
+static inline void oled_changed(bool changed) {
+    if (changed) {
+        oled_dirty = OLED_ALL_BLOCKS_MASK;
     }
 }
 
@@ -173,6 +235,13 @@ bool oled_init(oled_rotation_t rotation) {
     } else {
         oled_rotation_width = OLED_DISPLAY_HEIGHT;
     }
+#ifdef OLED_ROTATE_ON_WRITE
+    oled_surface.rotated = HAS_FLAGS(oled_rotation, OLED_ROTATION_90);
+#else
+    // Pages of the rotated image, which oled_render turns into the OLED memory layout block by block
+    oled_surface.width = oled_rotation_width;
+    oled_surface.pages = OLED_MATRIX_SIZE / oled_rotation_width;
+#endif
     i2c_init();
 
     static const uint8_t PROGMEM display_setup1[] = {
@@ -240,33 +309,35 @@ __attribute__((weak)) oled_rotation_t oled_init_user(oled_rotation_t rotation) {
 }
 
 void oled_clear(void) {
-    memset(oled_buffer, 0, sizeof(oled_buffer));
-    oled_cursor = &oled_buffer[0];
-    oled_dirty  = OLED_ALL_BLOCKS_MASK;
+    mono_surface_clear(&oled_surface);
+    oled_changed(true);
 }
 
-static void calc_bounds(uint8_t update_start, uint8_t *cmd_array) {
+mono_surface_t *oled_get_surface(void) {
+    return &oled_surface;
+}
+
+static void calc_bounds(const mono_window_t *window, uint8_t *cmd_array) {
     // Calculate commands to set memory addressing bounds.
-    uint8_t start_page   = OLED_BLOCK_SIZE * update_start / OLED_DISPLAY_WIDTH;
-    uint8_t start_column = OLED_BLOCK_SIZE * update_start % OLED_DISPLAY_WIDTH;
 #if (OLED_IC == OLED_IC_SH1106)
     // Commands for Page Addressing Mode. Sets starting page and column; has no end bound.
     // Column value must be split into high and low nybble and sent as two commands.
-    cmd_array[0] = PAM_PAGE_ADDR | start_page;
-    cmd_array[1] = PAM_SETCOLUMN_LSB | ((OLED_COLUMN_OFFSET + start_column) & 0x0f);
-    cmd_array[2] = PAM_SETCOLUMN_MSB | ((OLED_COLUMN_OFFSET + start_column) >> 4 & 0x0f);
+    cmd_array[0] = PAM_PAGE_ADDR | window->first_page;
+    cmd_array[1] = PAM_SETCOLUMN_LSB | ((OLED_COLUMN_OFFSET + window->start) & 0x0f);
+    cmd_array[2] = PAM_SETCOLUMN_MSB | ((OLED_COLUMN_OFFSET + window->start) >> 4 & 0x0f);
     cmd_array[3] = NOP;
     cmd_array[4] = NOP;
     cmd_array[5] = NOP;
 #else
     // Commands for use in Horizontal Addressing mode.
-    cmd_array[1] = start_column;
-    cmd_array[4] = start_page;
-    cmd_array[2] = (OLED_BLOCK_SIZE + OLED_DISPLAY_WIDTH - 1) % OLED_DISPLAY_WIDTH + cmd_array[1];
-    cmd_array[5] = (OLED_BLOCK_SIZE + OLED_DISPLAY_WIDTH - 1) / OLED_DISPLAY_WIDTH - 1;
+    cmd_array[1] = window->start;
+    cmd_array[2] = window->end - 1;
+    cmd_array[4] = window->first_page;
+    cmd_array[5] = window->last_page;
 #endif
 }
 
+#ifndef OLED_ROTATE_ON_WRITE
 static void calc_bounds_90(uint8_t update_start, uint8_t *cmd_array) {
     cmd_array[1] = OLED_BLOCK_SIZE * update_start / OLED_DISPLAY_HEIGHT * 8;
     cmd_array[4] = OLED_BLOCK_SIZE * update_start % OLED_DISPLAY_HEIGHT;
@@ -275,7 +346,7 @@ static void calc_bounds_90(uint8_t update_start, uint8_t *cmd_array) {
     cmd_array[5] = (OLED_BLOCK_SIZE + OLED_DISPLAY_HEIGHT - 1) % OLED_DISPLAY_HEIGHT / 8;
 }
 
-uint8_t crot(uint8_t a, int8_t n) {
+static uint8_t crot(uint8_t a, int8_t n) {
     const uint8_t mask = 0x7;
     n &= mask;
     return a << n | a >> (-n & mask);
@@ -290,163 +361,161 @@ static void rotate_90(const uint8_t *src, uint8_t *dest) {
     }
 }
 
-void oled_render(void) {
-    if (!oled_initialized) {
-        return;
+// Rotate the render chunks of a block
+static void rotate_block_90(uint8_t block, uint8_t *dest) {
+    const static uint8_t source_map[] = OLED_SOURCE_MAP;
+    const static uint8_t target_map[] = OLED_TARGET_MAP;
+
+    memset(dest, 0, OLED_BLOCK_SIZE);
+    for (uint8_t i = 0; i < sizeof(source_map); ++i) {
+        rotate_90(&oled_buffer[OLED_BLOCK_SIZE * block + source_map[i]], &dest[target_map[i]]);
     }
+}
+#endif
 
-    // Do we have work to do?
-    oled_dirty &= OLED_ALL_BLOCKS_MASK;
-    if (!oled_dirty || oled_scrolling) {
+#ifdef OLED_ASYNC_RENDER
+// Marks what the last oled_render call sent as changed again, after it failed to arrive
+static void oled_render_retry(void) {
+#ifndef OLED_ROTATE_ON_WRITE
+    if (BUFFER_ROTATED) {
+        mono_surface_mark_dirty(&oled_surface, OLED_BLOCK_SIZE * oled_render_block, OLED_BLOCK_SIZE);
         return;
     }
+#endif
+    mono_surface_mark_window(&oled_surface, &oled_render_window);
+}
 
-    // Find first dirty block
-    uint8_t update_start = 0;
-    while (!(oled_dirty & ((OLED_BLOCK_TYPE)1 << update_start))) {
-        ++update_start;
+// Failures keep oled_dirty set, so the next oled_render call sends the window again
+static void oled_render_data_sent(i2c_status_t status) {
+    if (status != I2C_STATUS_SUCCESS) {
+        oled_render_failed = true;
+        oled_dirty         = OLED_ALL_BLOCKS_MASK;
     }
+    oled_render_busy = false;
+}
 
-    // Set column & page position
-    static uint8_t display_start[] = {I2C_CMD, COLUMN_ADDR, 0, OLED_DISPLAY_WIDTH - 1, PAGE_ADDR, 0, OLED_DISPLAY_HEIGHT / 8 - 1};
-    if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
-        calc_bounds(update_start, &display_start[1]); // Offset from I2C_CMD byte at the start
-    } else {
-        calc_bounds_90(update_start, &display_start[1]); // Offset from I2C_CMD byte at the start
+// Runs on the I2C thread once the column & page position is sent, and chains the data right after it
+static void oled_render_position_sent(i2c_status_t status) {
+    if (status == I2C_STATUS_SUCCESS && i2c_transmit_async((OLED_DISPLAY_ADDRESS << 1), oled_render_packet, oled_render_length + 1, OLED_I2C_TIMEOUT, oled_render_data_sent) == I2C_STATUS_SUCCESS) {
+        return;
     }
+    oled_render_failed = true;
+    oled_dirty         = OLED_ALL_BLOCKS_MASK;
+    oled_render_busy   = false;
+}
+#endif
+
+// Sends the position and the packet, returns true once they are sent (or on their way)
+static bool oled_render_send(void) {
+#ifdef OLED_ASYNC_RENDER
+    // Turn on display if it is off, before the bus is taken
+    oled_on();
 
+    // Send column & page position, the data follows from the callback
+    oled_render_busy = true;
+    if (i2c_transmit_async((OLED_DISPLAY_ADDRESS << 1), oled_render_position, sizeof(oled_render_position), OLED_I2C_TIMEOUT, oled_render_position_sent) != I2C_STATUS_SUCCESS) {
+        // Bus is in use, try again next time
+        oled_render_busy = false;
+        return false;
+    }
+#else
     // Send column & page position
-    if (I2C_TRANSMIT(display_start) != I2C_STATUS_SUCCESS) {
+    if (I2C_TRANSMIT(oled_render_position) != I2C_STATUS_SUCCESS) {
         print("oled_render offset command failed\n");
-        return;
+        return false;
     }
 
-    if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
-        // Send render data chunk as is
-        if (I2C_WRITE_REG(I2C_DATA, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
-            print("oled_render data failed\n");
-            return;
-        }
-    } else {
-        // Rotate the render chunks
-        const static uint8_t source_map[] = OLED_SOURCE_MAP;
-        const static uint8_t target_map[] = OLED_TARGET_MAP;
-
-        static uint8_t temp_buffer[OLED_BLOCK_SIZE];
-        memset(temp_buffer, 0, sizeof(temp_buffer));
-        for (uint8_t i = 0; i < sizeof(source_map); ++i) {
-            rotate_90(&oled_buffer[OLED_BLOCK_SIZE * update_start + source_map[i]], &temp_buffer[target_map[i]]);
-        }
-
-        // Send render data chunk after rotating
-        if (I2C_WRITE_REG(I2C_DATA, &temp_buffer[0], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
-            print("oled_render90 data failed\n");
-            return;
-        }
+    // Send render data
+    if (i2c_transmit((OLED_DISPLAY_ADDRESS << 1), oled_render_packet, oled_render_length + 1, OLED_I2C_TIMEOUT) != I2C_STATUS_SUCCESS) {
+        print("oled_render data failed\n");
+        return false;
     }
 
     // Turn on display if it is off
     oled_on();
-
-    // Clear dirty flag
-    oled_dirty &= ~((OLED_BLOCK_TYPE)1 << update_start);
+#endif
+    return true;
 }
 
-void oled_set_cursor(uint8_t col, uint8_t line) {
-    uint16_t index = line * oled_rotation_width + col * OLED_FONT_WIDTH;
-
-    // Out of bounds?
-    if (index >= OLED_MATRIX_SIZE) {
-        index = 0;
-    }
-
-    oled_cursor = &oled_buffer[index];
+static bool oled_render_window_send(const mono_surface_t *surface, const mono_window_t *window) {
+    calc_bounds(window, &oled_render_position[1]); // Offset from I2C_CMD byte at the start
+    oled_render_length = mono_surface_copy_window(surface, window, &oled_render_packet[1]);
+    oled_render_window = *window;
+    return oled_render_send();
 }
 
-void oled_advance_page(bool clearPageRemainder) {
-    uint16_t index     = oled_cursor - &oled_buffer[0];
-    uint8_t  remaining = oled_rotation_width - (index % oled_rotation_width);
-
-    if (clearPageRemainder) {
-        // Remaining Char count
-        remaining = remaining / OLED_FONT_WIDTH;
-
-        // Write empty character until next line
-        while (remaining--)
-            oled_write_char(' ', false);
-    } else {
-        // Next page index out of bounds?
-        if (index + remaining >= OLED_MATRIX_SIZE) {
-            index     = 0;
-            remaining = 0;
-        }
+static const mono_flush_driver_t oled_flush_driver = {
+    .window_size     = OLED_WINDOW_SIZE,
+    .window_overhead = OLED_WINDOW_OVERHEAD,
+#if (OLED_IC != OLED_IC_SH1106)
+    // Page Addressing Mode on the SH1106 can't wrap into the next page
+    .join_pages = true,
+#endif
+    .send = oled_render_window_send,
+};
 
-        oled_cursor = &oled_buffer[index + remaining];
+void oled_render(void) {
+    if (!oled_initialized) {
+        return;
     }
-}
 
-void oled_advance_char(void) {
-    uint16_t nextIndex      = oled_cursor - &oled_buffer[0] + OLED_FONT_WIDTH;
-    uint8_t  remainingSpace = oled_rotation_width - (nextIndex % oled_rotation_width);
-
-    // Do we have enough space on the current line for the next character
-    if (remainingSpace < OLED_FONT_WIDTH) {
-        nextIndex += remainingSpace;
+#ifdef OLED_ASYNC_RENDER
+    // Still sending the last window
+    if (oled_render_busy) {
+        return;
     }
-
-    // Did we go out of bounds
-    if (nextIndex >= OLED_MATRIX_SIZE) {
-        nextIndex = 0;
+    if (oled_render_failed) {
+        print("oled_render failed\n");
+        oled_render_failed = false;
+        oled_render_retry();
     }
+#endif
 
-    // Update cursor position
-    oled_cursor = &oled_buffer[nextIndex];
-}
-
-// Main handler that writes character data to the display buffer
-void oled_write_char(const char data, bool invert) {
-    // Advance to the next line if newline
-    if (data == '\n') {
-        // Old source wrote ' ' until end of line...
-        oled_advance_page(true);
+    // Do we have work to do?
+    if (oled_scrolling) {
         return;
     }
 
-    if (data == '\r') {
-        oled_advance_page(false);
-        return;
+    if (!BUFFER_ROTATED) {
+        mono_surface_flush(&oled_surface, &oled_flush_driver);
     }
+#ifndef OLED_ROTATE_ON_WRITE
+    else {
+        // Find first dirty block
+        uint8_t update_start = 0;
+        while (update_start < OLED_BLOCK_COUNT && !mono_surface_is_range_dirty(&oled_surface, OLED_BLOCK_SIZE * update_start, OLED_BLOCK_SIZE)) {
+            ++update_start;
+        }
+        if (update_start < OLED_BLOCK_COUNT) {
+            calc_bounds_90(update_start, &oled_render_position[1]); // Offset from I2C_CMD byte at the start
+            rotate_block_90(update_start, &oled_render_packet[1]);
+            oled_render_block  = update_start;
+            oled_render_length = OLED_BLOCK_SIZE;
+            if (oled_render_send()) {
+                mono_surface_mark_clean(&oled_surface, OLED_BLOCK_SIZE * update_start, OLED_BLOCK_SIZE);
+            }
+        }
+    }
+#endif
 
-    // copy the current render buffer to check for dirty after
-    static uint8_t oled_temp_buffer[OLED_FONT_WIDTH];
-    memcpy(&oled_temp_buffer, oled_cursor, OLED_FONT_WIDTH);
-
-    _Static_assert(sizeof(font) >= ((OLED_FONT_END + 1 - OLED_FONT_START) * OLED_FONT_WIDTH), "OLED_FONT_END references outside array");
+    oled_dirty = mono_surface_is_dirty(&oled_surface) ? OLED_ALL_BLOCKS_MASK : 0;
+}
 
-    // set the reder buffer data
-    uint8_t cast_data = (uint8_t)data; // font based on unsigned type for index
-    if (cast_data < OLED_FONT_START || cast_data > OLED_FONT_END) {
-        memset(oled_cursor, 0x00, OLED_FONT_WIDTH);
-    } else {
-        const uint8_t *glyph = &font[(cast_data - OLED_FONT_START) * OLED_FONT_WIDTH];
-        memcpy_P(oled_cursor, glyph, OLED_FONT_WIDTH);
-    }
+void oled_set_cursor(uint8_t col, uint8_t line) {
+    mono_surface_set_cursor(&oled_surface, col, line);
+}
 
-    // Invert if needed
-    if (invert) {
-        InvertCharacter(oled_cursor);
-    }
+void oled_advance_page(bool clearPageRemainder) {
+    oled_changed(mono_surface_advance_page(&oled_surface, clearPageRemainder));
+}
 
-    // Dirty check
-    if (memcmp(&oled_temp_buffer, oled_cursor, OLED_FONT_WIDTH)) {
-        uint16_t index = oled_cursor - &oled_buffer[0];
-        oled_dirty |= ((OLED_BLOCK_TYPE)1 << (index / OLED_BLOCK_SIZE));
-        // Edgecase check if the written data spans the 2 chunks
-        oled_dirty |= ((OLED_BLOCK_TYPE)1 << ((index + OLED_FONT_WIDTH - 1) / OLED_BLOCK_SIZE));
-    }
+void oled_advance_char(void) {
+    mono_surface_advance_char(&oled_surface);
+}
 
-    // Finally move to the next char
-    oled_advance_char();
+// Main handler that writes character data to the display buffer
+void oled_write_char(const char data, bool invert) {
+    oled_changed(mono_surface_write_char(&oled_surface, data, invert));
 }
 
 void oled_write(const char *data, bool invert) {
@@ -463,21 +532,8 @@ void oled_write_ln(const char *data, bool invert) {
 }
 
 void oled_pan(bool left) {
-    uint16_t i = 0;
-    for (uint16_t y = 0; y < OLED_DISPLAY_HEIGHT / 8; y++) {
-        if (left) {
-            for (uint16_t x = 0; x < OLED_DISPLAY_WIDTH - 1; x++) {
-                i              = y * OLED_DISPLAY_WIDTH + x;
-                oled_buffer[i] = oled_buffer[i + 1];
-            }
-        } else {
-            for (uint16_t x = OLED_DISPLAY_WIDTH - 1; x > 0; x--) {
-                i              = y * OLED_DISPLAY_WIDTH + x;
-                oled_buffer[i] = oled_buffer[i - 1];
-            }
-        }
-    }
-    oled_dirty = OLED_ALL_BLOCKS_MASK;
+    mono_surface_pan(&oled_surface, left);
+    oled_changed(true);
 }
 
 oled_buffer_reader_t oled_read_raw(uint16_t start_index) {
@@ -489,41 +545,19 @@ oled_buffer_reader_t oled_read_raw(uint16_t start_index) {
 }
 
 void oled_write_raw_byte(const char data, uint16_t index) {
-    if (index > OLED_MATRIX_SIZE) index = OLED_MATRIX_SIZE;
-    if (oled_buffer[index] == data) return;
-    oled_buffer[index] = data;
-    oled_dirty |= ((OLED_BLOCK_TYPE)1 << (index / OLED_BLOCK_SIZE));
+    oled_changed(mono_surface_write_raw_byte(&oled_surface, data, index));
 }
 
 void oled_write_raw(const char *data, uint16_t size) {
-    uint16_t cursor_start_index = oled_cursor - &oled_buffer[0];
-    if ((size + cursor_start_index) > OLED_MATRIX_SIZE) size = OLED_MATRIX_SIZE - cursor_start_index;
-    for (uint16_t i = cursor_start_index; i < cursor_start_index + size; i++) {
-        uint8_t c = *data++;
-        if (oled_buffer[i] == c) continue;
-        oled_buffer[i] = c;
-        oled_dirty |= ((OLED_BLOCK_TYPE)1 << (i / OLED_BLOCK_SIZE));
-    }
+    oled_changed(mono_surface_write_raw(&oled_surface, (const uint8_t *)data, size));
 }
 
 void oled_write_pixel(uint8_t x, uint8_t y, bool on) {
-    if (x >= oled_rotation_width) {
-        return;
-    }
-    uint16_t index = x + (y / 8) * oled_rotation_width;
-    if (index >= OLED_MATRIX_SIZE) {
-        return;
-    }
-    uint8_t data = oled_buffer[index];
-    if (on) {
-        data |= (1 << (y % 8));
-    } else {
-        data &= ~(1 << (y % 8));
-    }
-    if (oled_buffer[index] != data) {
-        oled_buffer[index] = data;
-        oled_dirty |= ((OLED_BLOCK_TYPE)1 << (index / OLED_BLOCK_SIZE));
-    }
+    oled_changed(mono_surface_write_pixel(&oled_surface, x, y, on));
+}
+
+void oled_write_rle(const char *image, uint16_t frame) {
+    oled_changed(mono_surface_write_rle(&oled_surface, (const uint8_t *)image, frame));
 }
 
 #if defined(__AVR__)
@@ -541,14 +575,7 @@ void oled_write_ln_P(const char *data, bool invert) {
 }
 
 void oled_write_raw_P(const char *data, uint16_t size) {
-    uint16_t cursor_start_index = oled_cursor - &oled_buffer[0];
-    if ((size + cursor_start_index) > OLED_MATRIX_SIZE) size = OLED_MATRIX_SIZE - cursor_start_index;
-    for (uint16_t i = cursor_start_index; i < cursor_start_index + size; i++) {
-        uint8_t c = pgm_read_byte(data++);
-        if (oled_buffer[i] == c) continue;
-        oled_buffer[i] = c;
-        oled_dirty |= ((OLED_BLOCK_TYPE)1 << (i / OLED_BLOCK_SIZE));
-    }
+    oled_changed(mono_surface_write_raw_P(&oled_surface, (const uint8_t *)data, size));
 }
 #endif // defined(__AVR__)
 
@@ -656,7 +683,7 @@ bool oled_scroll_right(void) {
 
     // Dont enable scrolling if we need to update the display
     // This prevents scrolling of bad data from starting the scroll too early after init
-    if (!oled_dirty && !oled_scrolling) {
+    if (!mono_surface_is_dirty(&oled_surface) && !oled_scrolling) {
         uint8_t display_scroll_right[] = {I2C_CMD, SCROLL_RIGHT, 0x00, oled_scroll_start, oled_scroll_speed, oled_scroll_end, 0x00, 0xFF, ACTIVATE_SCROLL};
         if (I2C_TRANSMIT(display_scroll_right) != I2C_STATUS_SUCCESS) {
             print("oled_scroll_right cmd failed\n");
@@ -674,7 +701,7 @@ bool oled_scroll_left(void) {
 
     // Dont enable scrolling if we need to update the display
     // This prevents scrolling of bad data from starting the scroll too early after init
-    if (!oled_dirty && !oled_scrolling) {
+    if (!mono_surface_is_dirty(&oled_surface) && !oled_scrolling) {
         uint8_t display_scroll_left[] = {I2C_CMD, SCROLL_LEFT, 0x00, oled_scroll_start, oled_scroll_speed, oled_scroll_end, 0x00, 0xFF, ACTIVATE_SCROLL};
         if (I2C_TRANSMIT(display_scroll_left) != I2C_STATUS_SUCCESS) {
             print("oled_scroll_left cmd failed\n");
@@ -697,7 +724,8 @@ bool oled_scroll_off(void) {
             return oled_scrolling;
         }
         oled_scrolling = false;
-        oled_dirty     = OLED_ALL_BLOCKS_MASK;
+        mono_surface_mark_all_dirty(&oled_surface);
+        oled_changed(true);
     }
     return !oled_scrolling;
 }
@@ -761,7 +789,7 @@ void oled_task(void) {
 #endif
 
 #if OLED_SCROLL_TIMEOUT > 0
-    if (oled_dirty && oled_scrolling) {
+    if (oled_scrolling && mono_surface_is_dirty(&oled_surface)) {
         oled_scroll_timeout = timer_read32() + OLED_SCROLL_TIMEOUT;
         oled_scroll_off();
     }
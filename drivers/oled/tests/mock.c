@@ -0,0 +1,187 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Simulated SSD1306 in horizontal addressing mode, decodes the command
+ * stream sent by the OLED driver and keeps a copy of the display RAM.
+ */
+
+#include <string.h>
+
+#include "i2c_master.h"
+#include "mock.h"
+
+#define OLED_PAGES (OLED_DISPLAY_HEIGHT / 8)
+
+uint8_t  mock_oled_ram[OLED_PAGES][OLED_DISPLAY_WIDTH];
+uint32_t mock_i2c_transfers;
+uint32_t mock_i2c_bytes;
+uint32_t mock_i2c_data_bytes;
+
+static uint8_t column_start, column_end, column;
+static uint8_t page_start, page_end, page;
+
+static uint8_t command_arguments(uint8_t command) {
+    switch (command) {
+        case 0x20: // MEMORY_MODE
+        case 0x23: // FADE_BLINK
+        case 0x81: // CONTRAST
+        case 0x8D: // CHARGE_PUMP
+        case 0xA8: // MULTIPLEX_RATIO
+        case 0xD3: // DISPLAY_OFFSET
+        case 0xD5: // DISPLAY_CLOCK
+        case 0xD9: // PRE_CHARGE_PERIOD
+        case 0xDA: // COM_PINS
+        case 0xDB: // VCOM_DETECT
+            return 1;
+        case 0x21: // COLUMN_ADDR
+        case 0x22: // PAGE_ADDR
+            return 2;
+        case 0x26: // SCROLL_RIGHT
+        case 0x27: // SCROLL_LEFT
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+static void write_commands(const uint8_t *data, uint16_t length) {
+    while (length) {
+        uint8_t command   = *data;
+        uint8_t arguments = command_arguments(command);
+        if (length < arguments + 1) {
+            return;
+        }
+        if (command == 0x21) {
+            column_start = column = data[1];
+            column_end            = data[2];
+        } else if (command == 0x22) {
+            page_start = page = data[1];
+            page_end          = data[2];
+        }
+        data += arguments + 1;
+        length -= arguments + 1;
+    }
+}
+
+static void write_data(const uint8_t *data, uint16_t length) {
+    while (length--) {
+        if (page < OLED_PAGES && column < OLED_DISPLAY_WIDTH) {
+            mock_oled_ram[page][column] = *data;
+        }
+        data++;
+        mock_i2c_data_bytes++;
+
+        if (column++ == column_end) {
+            column = column_start;
+            if (page++ == page_end) {
+                page = page_start;
+            }
+        }
+    }
+}
+
+void mock_oled_reset(void) {
+    memset(mock_oled_ram, 0xAA, sizeof(mock_oled_ram));
+    column_start = column = 0;
+    column_end            = OLED_DISPLAY_WIDTH - 1;
+    page_start = page = 0;
+    page_end          = OLED_PAGES - 1;
+    mock_i2c_reset_stats();
+}
+
+void mock_i2c_reset_stats(void) {
+    mock_i2c_transfers  = 0;
+    mock_i2c_bytes      = 0;
+    mock_i2c_data_bytes = 0;
+}
+
+void i2c_init(void) {}
+
+i2c_status_t i2c_transmit(uint8_t address, const uint8_t *data, uint16_t length, uint16_t timeout) {
+#ifdef I2C_ASYNC_SUPPORTED
+    if (mock_i2c_in_flight()) {
+        return I2C_STATUS_TIMEOUT;
+    }
+#endif
+    if (address != (OLED_DISPLAY_ADDRESS << 1) || length == 0) {
+        return I2C_STATUS_ERROR;
+    }
+
+    mock_i2c_transfers++;
+    mock_i2c_bytes += length + 1;
+
+    // Control byte: Co = 0, D/C# selects data or commands for the rest of the transfer
+    if (data[0] == 0x40) {
+        write_data(&data[1], length - 1);
+    } else if (data[0] == 0x00) {
+        write_commands(&data[1], length - 1);
+    } else {
+        return I2C_STATUS_ERROR;
+    }
+    return I2C_STATUS_SUCCESS;
+}
+
+#ifdef I2C_ASYNC_SUPPORTED
+bool mock_i2c_bus_busy;
+
+static struct {
+    bool                 in_flight;
+    uint8_t              address;
+    const uint8_t       *data;
+    uint16_t             length;
+    i2c_async_callback_t callback;
+} transfer;
+
+bool mock_i2c_in_flight(void) {
+    return transfer.in_flight;
+}
+
+bool i2c_is_busy(void) {
+    return mock_i2c_bus_busy || transfer.in_flight;
+}
+
+i2c_status_t i2c_transmit_async(uint8_t address, const uint8_t *data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback) {
+    if (i2c_is_busy()) {
+        return I2C_STATUS_BUSY;
+    }
+
+    // The data is only read once the transfer completes, like DMA would
+    transfer.in_flight = true;
+    transfer.address   = address;
+    transfer.data      = data;
+    transfer.length    = length;
+    transfer.callback  = callback;
+    return I2C_STATUS_SUCCESS;
+}
+
+bool mock_i2c_complete(i2c_status_t status) {
+    if (!transfer.in_flight) {
+        return false;
+    }
+
+    // The bus is released before the callback, which may start the next transfer
+    transfer.in_flight = false;
+    if (status == I2C_STATUS_SUCCESS) {
+        status = i2c_transmit(transfer.address, transfer.data, transfer.length, 0);
+    }
+    if (transfer.callback) {
+        transfer.callback(status);
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,45 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "i2c_master.h"
+#include "oled_driver.h"
+
+/* Display RAM of the simulated SSD1306, laid out like oled_buffer */
+extern uint8_t mock_oled_ram[OLED_DISPLAY_HEIGHT / 8][OLED_DISPLAY_WIDTH];
+
+/* Traffic since the last mock_i2c_reset_stats(), every transfer also counts its address byte */
+extern uint32_t mock_i2c_transfers;
+extern uint32_t mock_i2c_bytes;
+extern uint32_t mock_i2c_data_bytes;
+
+void mock_oled_reset(void);
+void mock_i2c_reset_stats(void);
+
+#ifdef I2C_ASYNC_SUPPORTED
+/* Another device holds the bus, background transfers are refused with I2C_STATUS_BUSY */
+extern bool mock_i2c_bus_busy;
+
+/* Finishes the background transfer in flight with the given status and runs its callback,
+ * returns false if there was none */
+bool mock_i2c_complete(i2c_status_t status);
+bool mock_i2c_in_flight(void);
+#endif
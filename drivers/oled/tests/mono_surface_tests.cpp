@@ -0,0 +1,413 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "mono_surface.h"
+#include "progmem.h"
+#include "glcdfont.c"
+}
+
+#define WIDTH 128
+#define PAGES 4
+
+/* Display with the surface layout, every sent window is copied into it */
+static uint8_t                    panel[PAGES][WIDTH];
+static std::vector<mono_window_t> sent;
+
+static bool send_window(const mono_surface_t *surface, const mono_window_t *window) {
+    for (uint8_t page = window->first_page; page <= window->last_page; ++page) {
+        memcpy(&panel[page][window->start], &surface->buffer[page * surface->width + window->start], window->end - window->start);
+    }
+    sent.push_back(*window);
+    return true;
+}
+
+static const mono_flush_driver_t joining_driver  = {.window_size = WIDTH * PAGES, .window_overhead = 10, .join_pages = true, .send = send_window};
+static const mono_flush_driver_t per_page_driver = {.window_size = WIDTH, .send = send_window};
+
+/* Same encoding as `qmk generate-mono-rle`: runs of 3 or more, and of 2 outside of literals */
+static std::vector<uint8_t> encode(const uint8_t *data, uint8_t width, uint8_t height, uint16_t frames, uint8_t per_block) {
+    uint16_t             frame_size = width * ((height + 7) / 8);
+    uint16_t             blocks     = (frames + per_block - 1) / per_block;
+    std::vector<uint8_t> header     = {width, height, (uint8_t)frames, (uint8_t)(frames >> 8), per_block};
+    std::vector<uint8_t> stream;
+
+    for (uint16_t block = 0; block < blocks; ++block) {
+        header.push_back(stream.size());
+        header.push_back(stream.size() >> 8);
+
+        const uint8_t *begin   = &data[block * per_block * frame_size];
+        uint16_t       size    = std::min<uint16_t>(per_block, frames - block * per_block) * frame_size;
+        uint16_t       literal = 0;
+        for (uint16_t i = 0; i < size;) {
+            uint16_t run = 1;
+            while (i + run < size && run < 129 && begin[i + run] == begin[i]) {
+                ++run;
+            }
+            if (run >= 3 || (run == 2 && !literal)) {
+                stream.push_back(0x80 | (run - 2));
+                stream.push_back(begin[i]);
+                literal = 0;
+                i += run;
+                continue;
+            }
+            if (!literal) {
+                stream.push_back(0);
+                literal = stream.size();
+            } else {
+                ++stream[literal - 1];
+            }
+            stream.push_back(begin[i++]);
+            if (stream[literal - 1] == 0x7F) {
+                literal = 0;
+            }
+        }
+    }
+    header.insert(header.end(), stream.begin(), stream.end());
+    return header;
+}
+
+/* The QMK logo of glcdfont.c, three text lines of 21 glyphs on a 128x32 image */
+static void qmk_logo(uint8_t *image) {
+    memset(image, 0, WIDTH * PAGES);
+    for (uint8_t line = 0; line < 3; ++line) {
+        memcpy(&image[line * WIDTH], &font[(0x80 + line * 0x20) * 6], 21 * 6);
+    }
+}
+
+struct Surface {
+    uint8_t        buffer[WIDTH * PAGES];
+    uint8_t        span_start[PAGES];
+    uint8_t        span_end[PAGES];
+    mono_surface_t surface;
+
+    Surface() {
+        surface = {};
+        surface.buffer     = buffer;
+        surface.span_start = span_start;
+        surface.span_end   = span_end;
+        surface.font       = font;
+        surface.width      = WIDTH;
+        surface.pages      = PAGES;
+        surface.font_width = 6;
+        surface.font_start = 0;
+        surface.font_end   = 223;
+#ifdef MONO_SURFACE_ROTATION
+        surface.rotated = true;
+#endif
+        mono_surface_clear(&surface);
+    }
+
+    /* Pixel of the drawn image */
+    bool pixel(uint8_t x, uint8_t y) {
+#ifdef MONO_SURFACE_ROTATION
+        uint8_t column = y;
+        y              = PAGES * 8 - 1 - x;
+        x              = column;
+#endif
+        return buffer[y / 8 * WIDTH + x] & (1 << (y % 8));
+    }
+
+    void flush(const mono_flush_driver_t *driver) {
+        for (int i = 0; i < 100 && mono_surface_flush(&surface, driver); ++i) {
+        }
+        EXPECT_FALSE(mono_surface_is_dirty(&surface));
+    }
+};
+
+class MonoSurfaceTest : public testing::Test {
+   public:
+    MonoSurfaceTest() {}
+    ~MonoSurfaceTest() {}
+
+   protected:
+    Surface drawn, expected;
+
+    void SetUp() override {
+        srand(42);
+        drawn.flush(&joining_driver);
+        expected.flush(&joining_driver);
+        sent.clear();
+    }
+
+    uint8_t width(void) {
+        return mono_surface_width(&drawn.surface);
+    }
+
+    uint8_t height(void) {
+        return mono_surface_height(&drawn.surface);
+    }
+
+    void randomize(void) {
+        for (uint16_t i = 0; i < sizeof(drawn.buffer); ++i) {
+            drawn.buffer[i] = expected.buffer[i] = rand();
+        }
+        memcpy(panel, drawn.buffer, sizeof(panel));
+    }
+
+    /* The buffer matches the pixel by pixel reference, and sending the changes brings the panel up to date */
+    void expectDrawn(void) {
+        ASSERT_EQ(memcmp(drawn.buffer, expected.buffer, sizeof(drawn.buffer)), 0);
+        drawn.flush(&joining_driver);
+        EXPECT_EQ(memcmp(panel, drawn.buffer, sizeof(panel)), 0);
+    }
+
+    /* Bit of a bitmap in the buffer layout */
+    static bool bit(const uint8_t *bitmap, uint8_t width, uint8_t x, uint8_t y) {
+        return bitmap[y / 8 * width + x] & (1 << (y % 8));
+    }
+
+    void drawReference(uint8_t x, uint8_t y, const uint8_t *bitmap, const uint8_t *mask, uint8_t w, uint8_t h, mono_blit_op_t op) {
+        for (uint8_t column = 0; column < w && x + column < width(); ++column) {
+            for (uint8_t row = 0; row < h && y + row < height(); ++row) {
+                bool set = bit(bitmap, w, column, row);
+                bool on  = expected.pixel(x + column, y + row);
+                if (mask) {
+                    on = bit(mask, w, column, row) ? set : on;
+                } else if (op == MONO_BLIT_COPY) {
+                    on = set;
+                } else if (op == MONO_BLIT_SET) {
+                    on = on || set;
+                } else if (op == MONO_BLIT_CLEAR) {
+                    on = on && !set;
+                } else {
+                    on = on != set;
+                }
+                mono_surface_write_pixel(&expected.surface, x + column, y + row, on);
+            }
+        }
+    }
+};
+
+TEST_F(MonoSurfaceTest, TestFillRect) {
+    for (int i = 0; i < 200; ++i) {
+        randomize();
+        uint8_t x = rand() % width(), y = rand() % height();
+        uint8_t w = rand() % 40 + 1, h = rand() % 40 + 1;
+        bool    on = rand() & 1;
+
+        mono_surface_fill_rect(&drawn.surface, x, y, w, h, on);
+        for (uint8_t column = x; column < x + w && column < width(); ++column) {
+            for (uint8_t row = y; row < y + h && row < height(); ++row) {
+                mono_surface_write_pixel(&expected.surface, column, row, on);
+            }
+        }
+        expectDrawn();
+    }
+}
+
+TEST_F(MonoSurfaceTest, TestBlit) {
+    uint8_t bitmap[24 * 3];
+    for (int i = 0; i < 400; ++i) {
+        randomize();
+        for (uint8_t &b : bitmap) {
+            b = rand();
+        }
+        uint8_t        x = rand() % width(), y = rand() % height();
+        uint8_t        w = rand() % 24 + 1, h = rand() % 24 + 1;
+        mono_blit_op_t op = (mono_blit_op_t)(rand() % 4);
+
+        mono_surface_blit(&drawn.surface, x, y, bitmap, w, h, op);
+        drawReference(x, y, bitmap, NULL, w, h, op);
+        expectDrawn();
+    }
+}
+
+TEST_F(MonoSurfaceTest, TestSprite) {
+    uint8_t image[16 * 2], mask[16 * 2];
+    for (int i = 0; i < 200; ++i) {
+        randomize();
+        for (uint8_t j = 0; j < sizeof(image); ++j) {
+            image[j] = rand();
+            mask[j]  = rand();
+        }
+        uint8_t x = rand() % width(), y = rand() % height();
+        uint8_t w = rand() % 16 + 1, h = rand() % 16 + 1;
+
+        mono_surface_draw_sprite(&drawn.surface, x, y, image, mask, w, h);
+        drawReference(x, y, image, mask, w, h, MONO_BLIT_COPY);
+        expectDrawn();
+    }
+}
+
+TEST_F(MonoSurfaceTest, TestGlyphsMatchText) {
+    /* Glyphs on a text line look like text written at the cursor */
+    mono_surface_set_cursor(&expected.surface, 2, 1);
+    mono_surface_write_char(&expected.surface, 'Q', false);
+    mono_surface_write_char(&expected.surface, 'M', true);
+    mono_surface_write_char(&expected.surface, 'K', false);
+
+    mono_surface_draw_glyphs(&drawn.surface, 12, 8, "Q", false);
+    mono_surface_draw_glyphs(&drawn.surface, 18, 8, "M", true);
+    mono_surface_draw_glyphs(&drawn.surface, 24, 8, "K", false);
+    expectDrawn();
+}
+
+TEST_F(MonoSurfaceTest, TestGlyphRun) {
+    const char *text = "Layer: Lower, WPM 123";
+    uint8_t     glyphs[21 * 6];
+    for (uint8_t i = 0; i < 21; ++i) {
+        memcpy(&glyphs[i * 6], &font[text[i] * 6], 6);
+    }
+    randomize();
+
+    /* Long runs are split, and the last glyphs are cut off at the edge */
+    mono_surface_draw_glyphs(&drawn.surface, 3, 5, text, false);
+    drawReference(3, 5, glyphs, NULL, sizeof(glyphs), 8, MONO_BLIT_COPY);
+    expectDrawn();
+}
+
+TEST_F(MonoSurfaceTest, TestUnchangedDrawingStaysClean) {
+    static const uint8_t bitmap[] = {0x3C, 0x42, 0x81, 0x81, 0x42, 0x3C};
+
+    EXPECT_TRUE(mono_surface_blit(&drawn.surface, 10, 13, bitmap, sizeof(bitmap), 8, MONO_BLIT_COPY));
+    EXPECT_TRUE(mono_surface_fill_rect(&drawn.surface, 0, 0, 5, 20, true));
+    EXPECT_TRUE(mono_surface_draw_glyphs(&drawn.surface, 20, 9, "hi", false));
+    drawn.flush(&joining_driver);
+
+    EXPECT_FALSE(mono_surface_blit(&drawn.surface, 10, 13, bitmap, sizeof(bitmap), 8, MONO_BLIT_COPY));
+    EXPECT_FALSE(mono_surface_blit(&drawn.surface, 10, 13, bitmap, sizeof(bitmap), 8, MONO_BLIT_SET));
+    EXPECT_FALSE(mono_surface_fill_rect(&drawn.surface, 1, 2, 3, 4, true));
+    EXPECT_FALSE(mono_surface_draw_glyphs(&drawn.surface, 20, 9, "hi", false));
+    EXPECT_FALSE(mono_surface_is_dirty(&drawn.surface));
+}
+
+#ifndef MONO_SURFACE_ROTATION
+TEST_F(MonoSurfaceTest, TestChangedColumnsOnly) {
+    /* A rectangle 3 pixels into the page below the top one marks exactly its columns */
+    mono_surface_fill_rect(&drawn.surface, 40, 11, 7, 2, true);
+    EXPECT_EQ(drawn.span_start[1], 40);
+    EXPECT_EQ(drawn.span_end[1], 47);
+    EXPECT_FALSE(mono_surface_is_range_dirty(&drawn.surface, 0, WIDTH));
+    EXPECT_FALSE(mono_surface_is_range_dirty(&drawn.surface, 2 * WIDTH, 2 * WIDTH));
+
+    drawn.flush(&joining_driver);
+    ASSERT_EQ(sent.size(), 1u);
+    EXPECT_EQ(sent[0].first_page, 1);
+    EXPECT_EQ(sent[0].last_page, 1);
+    EXPECT_EQ(sent[0].start, 40);
+    EXPECT_EQ(sent[0].end, 47);
+}
+
+TEST_F(MonoSurfaceTest, TestFlushDrivers) {
+    static const uint8_t sprite[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+    /* A sprite across a page boundary goes out as one window where the panel continues on the next page */
+    mono_surface_blit(&drawn.surface, 60, 4, sprite, 8, 16, MONO_BLIT_COPY);
+    drawn.flush(&joining_driver);
+    ASSERT_EQ(sent.size(), 1u);
+    EXPECT_EQ(sent[0].first_page, 0);
+    EXPECT_EQ(sent[0].last_page, 2);
+
+    /* and as a window per page where it doesn't */
+    sent.clear();
+    mono_surface_blit(&drawn.surface, 60, 4, sprite, 8, 16, MONO_BLIT_INVERT);
+    drawn.flush(&per_page_driver);
+    ASSERT_EQ(sent.size(), 3u);
+    for (uint8_t page = 0; page < 3; ++page) {
+        EXPECT_EQ(sent[page].first_page, page);
+        EXPECT_EQ(sent[page].last_page, page);
+    }
+    EXPECT_EQ(memcmp(panel, drawn.buffer, sizeof(panel)), 0);
+}
+#endif
+
+TEST_F(MonoSurfaceTest, TestPan) {
+    randomize();
+    mono_surface_pan(&drawn.surface, true);
+    for (uint8_t y = 0; y < height(); ++y) {
+        for (uint8_t x = 0; x + 1 < width(); ++x) {
+            ASSERT_EQ(drawn.pixel(x, y), expected.pixel(x + 1, y));
+        }
+    }
+    drawn.flush(&joining_driver);
+    EXPECT_EQ(memcmp(panel, drawn.buffer, sizeof(panel)), 0);
+}
+
+TEST_F(MonoSurfaceTest, TestRleFormat) {
+    /* Two frames of 3x8 in one block, a literal across both and a run */
+    static const uint8_t image[] = {3, 8, 2, 0, 2, 0, 0, 0x03, 0x11, 0x22, 0x33, 0x44, 0x81, 0x55};
+    mono_rle_reader_t    reader;
+    uint8_t              decoded[3];
+
+    EXPECT_EQ(mono_rle_frame_count(image), 2);
+    EXPECT_EQ(mono_rle_frame_size(image), 3);
+    ASSERT_TRUE(mono_rle_open(&reader, image, 1));
+    mono_rle_decode(&reader, decoded, sizeof(decoded));
+    EXPECT_EQ(decoded[0], 0x44);
+    EXPECT_EQ(decoded[1], 0x55);
+    EXPECT_EQ(decoded[2], 0x55);
+    EXPECT_FALSE(mono_rle_open(&reader, image, 2));
+}
+
+TEST_F(MonoSurfaceTest, TestRleFont) {
+    std::vector<uint8_t> compressed = encode(font, 6, 8, 224, 16);
+    EXPECT_LT(compressed.size(), 224 * 6);
+
+    mono_rle_reader_t reader;
+    uint8_t           glyph[6];
+    for (uint16_t c = 0; c < 224; ++c) {
+        ASSERT_TRUE(mono_rle_open(&reader, compressed.data(), c));
+        mono_rle_decode(&reader, glyph, sizeof(glyph));
+        ASSERT_EQ(memcmp(glyph, &font[c * 6], sizeof(glyph)), 0) << "glyph " << c;
+    }
+
+    /* Text in the compressed font looks the same */
+    drawn.surface.font     = compressed.data();
+    drawn.surface.font_rle = true;
+    const char *text       = "Compressed \x85 font";
+    mono_surface_set_cursor(&drawn.surface, 1, 2);
+    mono_surface_set_cursor(&expected.surface, 1, 2);
+    for (const char *c = text; *c; ++c) {
+        mono_surface_write_char(&drawn.surface, *c, c - text > 10);
+        mono_surface_write_char(&expected.surface, *c, c - text > 10);
+    }
+    mono_surface_draw_glyphs(&drawn.surface, 7, 3, text, true);
+    mono_surface_draw_glyphs(&expected.surface, 7, 3, text, true);
+    expectDrawn();
+}
+
+TEST_F(MonoSurfaceTest, TestRleImage) {
+    uint8_t logo[WIDTH * PAGES];
+    qmk_logo(logo);
+    std::vector<uint8_t> compressed = encode(logo, WIDTH, PAGES * 8, 1, 1);
+
+    /* Decoded at the cursor like the raw image */
+    randomize();
+    mono_surface_set_cursor(&drawn.surface, 0, 1);
+    mono_surface_set_cursor(&expected.surface, 0, 1);
+    EXPECT_TRUE(mono_surface_write_rle(&drawn.surface, compressed.data(), 0));
+    mono_surface_write_raw(&expected.surface, logo, sizeof(logo));
+    expectDrawn();
+    EXPECT_FALSE(mono_surface_write_rle(&drawn.surface, compressed.data(), 0));
+    EXPECT_FALSE(mono_surface_is_dirty(&drawn.surface));
+
+    /* and at any position like a bitmap */
+    for (int i = 0; i < 50; ++i) {
+        randomize();
+        uint8_t        x  = rand() % width(), y = rand() % height();
+        mono_blit_op_t op = (mono_blit_op_t)(rand() % 4);
+        mono_surface_draw_rle(&drawn.surface, x, y, compressed.data(), 0, op);
+        drawReference(x, y, logo, NULL, WIDTH, PAGES * 8, op);
+        expectDrawn();
+    }
+}
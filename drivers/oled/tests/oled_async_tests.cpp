@@ -0,0 +1,128 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "oled_driver.h"
+#include "mock.h"
+
+extern uint8_t         oled_buffer[OLED_MATRIX_SIZE];
+extern OLED_BLOCK_TYPE oled_dirty;
+}
+
+class OledAsyncTest : public testing::Test {
+   public:
+    OledAsyncTest() {}
+    ~OledAsyncTest() {}
+
+   protected:
+    void SetUp() override {
+        mock_i2c_bus_busy = false;
+        flush();
+        mock_oled_reset();
+        ASSERT_TRUE(oled_init(OLED_ROTATION_0));
+        flush();
+        mock_i2c_reset_stats();
+    }
+
+    /* Render and finish transfers until the buffer is fully sent, like housekeeping and the I2C thread would */
+    void flush(void) {
+        for (int i = 0; i < 1000 && (oled_dirty || mock_i2c_in_flight()); ++i) {
+            if (!mock_i2c_complete(I2C_STATUS_SUCCESS)) {
+                oled_render();
+            }
+        }
+        EXPECT_EQ(oled_dirty, 0);
+        EXPECT_FALSE(mock_i2c_in_flight());
+    }
+};
+
+TEST_F(OledAsyncTest, TestChainedRender) {
+    oled_write("BASE", false);
+    oled_render();
+    ASSERT_TRUE(mock_i2c_in_flight());
+    EXPECT_EQ(mock_i2c_transfers, 0);
+
+    /* Rendering again while the window is on its way does not touch the bus */
+    oled_render();
+    EXPECT_EQ(mock_i2c_transfers, 0);
+
+    /* The position callback starts the data right away */
+    ASSERT_TRUE(mock_i2c_complete(I2C_STATUS_SUCCESS));
+    EXPECT_EQ(mock_i2c_transfers, 1);
+    EXPECT_EQ(mock_i2c_data_bytes, 0);
+    ASSERT_TRUE(mock_i2c_in_flight());
+
+    ASSERT_TRUE(mock_i2c_complete(I2C_STATUS_SUCCESS));
+    EXPECT_EQ(mock_i2c_transfers, 2);
+    EXPECT_EQ(mock_i2c_data_bytes, 4 * OLED_FONT_WIDTH);
+    EXPECT_FALSE(mock_i2c_in_flight());
+
+    flush();
+    EXPECT_EQ(memcmp(mock_oled_ram, oled_buffer, OLED_MATRIX_SIZE), 0);
+}
+
+TEST_F(OledAsyncTest, TestBusyBusFallback) {
+    /* Another device holds the bus, the changes wait for the next render */
+    mock_i2c_bus_busy = true;
+    oled_write("BASE", false);
+    oled_render();
+    EXPECT_FALSE(mock_i2c_in_flight());
+    EXPECT_NE(oled_dirty, 0);
+    EXPECT_EQ(mock_i2c_transfers, 0);
+
+    mock_i2c_bus_busy = false;
+    flush();
+    EXPECT_EQ(mock_i2c_transfers, 2);
+    EXPECT_EQ(mock_i2c_data_bytes, 4 * OLED_FONT_WIDTH);
+    EXPECT_EQ(memcmp(mock_oled_ram, oled_buffer, OLED_MATRIX_SIZE), 0);
+}
+
+TEST_F(OledAsyncTest, TestFailedDataIsResent) {
+    oled_write("BASE", false);
+    oled_render();
+    ASSERT_TRUE(mock_i2c_complete(I2C_STATUS_SUCCESS));
+    ASSERT_TRUE(mock_i2c_complete(I2C_STATUS_TIMEOUT));
+    EXPECT_EQ(mock_i2c_data_bytes, 0);
+
+    /* The next render marks the lost window as changed again */
+    flush();
+    EXPECT_EQ(mock_i2c_data_bytes, 4 * OLED_FONT_WIDTH);
+    EXPECT_EQ(memcmp(mock_oled_ram, oled_buffer, OLED_MATRIX_SIZE), 0);
+}
+
+TEST_F(OledAsyncTest, TestFailedPositionIsResent) {
+    oled_write("BASE", false);
+    oled_render();
+    ASSERT_TRUE(mock_i2c_complete(I2C_STATUS_ERROR));
+    EXPECT_FALSE(mock_i2c_in_flight());
+
+    flush();
+    EXPECT_EQ(mock_i2c_data_bytes, 4 * OLED_FONT_WIDTH);
+    EXPECT_EQ(memcmp(mock_oled_ram, oled_buffer, OLED_MATRIX_SIZE), 0);
+}
+
+TEST_F(OledAsyncTest, TestChangeWhileSending) {
+    oled_write("BASE", false);
+    oled_render();
+
+    /* The window in flight is a copy, the new text is sent after it */
+    oled_set_cursor(0, 0);
+    oled_write("LOWER", false);
+    flush();
+    EXPECT_EQ(memcmp(mock_oled_ram, oled_buffer, OLED_MATRIX_SIZE), 0);
+}
@@ -0,0 +1,176 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "oled_driver.h"
+#include "progmem.h"
+#include OLED_FONT_H
+#include "mock.h"
+
+extern OLED_BLOCK_TYPE oled_dirty;
+}
+
+/* Both ways of 90 degree rotation have to put the same image on the display */
+class OledRotationTest : public testing::Test {
+   public:
+    OledRotationTest() {}
+    ~OledRotationTest() {}
+
+   protected:
+    void SetUp() override {
+        mock_oled_reset();
+        ASSERT_TRUE(oled_init(OLED_ROTATION_90));
+        flush();
+        mock_i2c_reset_stats();
+    }
+
+    void flush(void) {
+        for (int i = 0; i < 1000 && oled_dirty; ++i) {
+            oled_render();
+        }
+        EXPECT_EQ(oled_dirty, 0);
+    }
+
+    /* Pixel of the rotated image, as shown by the display */
+    bool pixel(uint8_t x, uint8_t y) {
+        uint8_t row = OLED_DISPLAY_HEIGHT - 1 - x;
+        return mock_oled_ram[row / 8][y] & (1 << (row % 8));
+    }
+
+    int pixelCount(void) {
+        int count = 0;
+        for (uint8_t x = 0; x < OLED_DISPLAY_HEIGHT; ++x) {
+            for (uint8_t y = 0; y < OLED_DISPLAY_WIDTH; ++y) {
+                count += pixel(x, y);
+            }
+        }
+        return count;
+    }
+
+    void expectGlyph(char c, uint8_t col, uint8_t line, bool invert) {
+        for (uint8_t i = 0; i < OLED_FONT_WIDTH; ++i) {
+            uint8_t column = font[(uint8_t)c * OLED_FONT_WIDTH + i] ^ (invert ? 0xFF : 0x00);
+            for (uint8_t bit = 0; bit < 8; ++bit) {
+                EXPECT_EQ(pixel(col * OLED_FONT_WIDTH + i, line * 8 + bit), (bool)(column & (1 << bit))) << "'" << c << "' column " << (int)i << " bit " << (int)bit;
+            }
+        }
+    }
+
+    /* Something like a status screen, with a counter that changes every frame */
+    void drawStatus(uint16_t frame) {
+        char wpm[] = "000";
+        wpm[0] += frame / 100 % 10;
+        wpm[1] += frame / 10 % 10;
+        wpm[2] += frame % 10;
+        oled_set_cursor(0, 0);
+        oled_write_ln("WPM", false);
+        oled_write_ln(wpm, false);
+        oled_set_cursor(0, 4);
+        oled_write_ln(frame / 100 % 2 ? "LOWER" : "BASE", false);
+        oled_write("CAPS", frame / 50 % 2);
+    }
+};
+
+TEST_F(OledRotationTest, TestText) {
+    oled_write_ln("Hi", false);
+    oled_set_cursor(1, 3);
+    oled_write("Qz", true);
+    flush();
+
+    expectGlyph('H', 0, 0, false);
+    expectGlyph('i', 1, 0, false);
+    expectGlyph('Q', 1, 3, true);
+    expectGlyph('z', 2, 3, true);
+}
+
+TEST_F(OledRotationTest, TestRewriteText) {
+    oled_write("Hi", false);
+    flush();
+    mock_i2c_reset_stats();
+    oled_set_cursor(0, 0);
+    oled_write("Ho", false);
+    flush();
+
+    expectGlyph('H', 0, 0, false);
+    expectGlyph('o', 1, 0, false);
+#ifdef OLED_ROTATE_ON_WRITE
+    /* 8 columns on the two pages the character overlaps */
+    EXPECT_EQ(mock_i2c_transfers, 2);
+    EXPECT_EQ(mock_i2c_data_bytes, 16);
+#else
+    EXPECT_EQ(mock_i2c_data_bytes % OLED_BLOCK_SIZE, 0);
+#endif
+}
+
+TEST_F(OledRotationTest, TestPixels) {
+    oled_write_pixel(3, 100, true);
+    oled_write_pixel(OLED_DISPLAY_HEIGHT - 1, 0, true);
+    oled_write_pixel(OLED_DISPLAY_HEIGHT, 0, true);
+    flush();
+    EXPECT_TRUE(pixel(3, 100));
+    EXPECT_TRUE(pixel(OLED_DISPLAY_HEIGHT - 1, 0));
+    EXPECT_EQ(pixelCount(), 2);
+
+    oled_write_pixel(3, 100, false);
+    flush();
+    EXPECT_FALSE(pixel(3, 100));
+    EXPECT_EQ(pixelCount(), 1);
+}
+
+TEST_F(OledRotationTest, TestRawWrites) {
+    /* Byte 5 on the third line of the rotated image */
+    oled_write_raw_byte(0x81, 2 * OLED_DISPLAY_HEIGHT + 5);
+    flush();
+    EXPECT_TRUE(pixel(5, 16));
+    EXPECT_TRUE(pixel(5, 23));
+    EXPECT_EQ(pixelCount(), 2);
+
+    static const char logo[] = {0x01, 0x02, 0x04, 0x08};
+    oled_set_cursor(2, 5);
+    oled_write_raw(logo, sizeof(logo));
+    flush();
+    for (uint8_t i = 0; i < sizeof(logo); ++i) {
+        EXPECT_TRUE(pixel(2 * OLED_FONT_WIDTH + i, 5 * 8 + i));
+    }
+    EXPECT_EQ(pixelCount(), 2 + sizeof(logo));
+}
+
+TEST_F(OledRotationTest, TestPan) {
+    oled_write_pixel(10, 20, true);
+    oled_pan(true);
+    flush();
+    EXPECT_TRUE(pixel(9, 20));
+    EXPECT_EQ(pixelCount(), 1);
+
+    oled_pan(false);
+    oled_pan(false);
+    flush();
+    EXPECT_TRUE(pixel(11, 20));
+    EXPECT_EQ(pixelCount(), 1);
+}
+
+TEST_F(OledRotationTest, TestStatusScreen) {
+    /* Only the changed characters are redrawn and sent, the display has to keep up */
+    for (uint16_t frame = 0; frame < 1000; ++frame) {
+        drawStatus(frame);
+        flush();
+    }
+
+    expectGlyph('W', 0, 0, false);
+    expectGlyph('9', 2, 1, false);
+}
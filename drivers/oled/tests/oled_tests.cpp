@@ -0,0 +1,172 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "oled_driver.h"
+#include "mock.h"
+
+extern uint8_t         oled_buffer[OLED_MATRIX_SIZE];
+extern OLED_BLOCK_TYPE oled_dirty;
+}
+
+/* Address + 7 byte position command, address + control byte in front of the data */
+#define WINDOW_OVERHEAD 10
+
+class OledTest : public testing::Test {
+   public:
+    OledTest() {}
+    ~OledTest() {}
+
+   protected:
+    void SetUp() override {
+        mock_oled_reset();
+        ASSERT_TRUE(oled_init(OLED_ROTATION_0));
+        flush();
+        mock_i2c_reset_stats();
+    }
+
+    /* Render until the buffer is fully sent, like housekeeping would over a few loops */
+    void flush(void) {
+        for (int i = 0; i < 1000 && oled_dirty; ++i) {
+            oled_render();
+        }
+        EXPECT_EQ(oled_dirty, 0);
+        EXPECT_EQ(memcmp(mock_oled_ram, oled_buffer, OLED_MATRIX_SIZE), 0);
+    }
+};
+
+TEST_F(OledTest, TestInitSendsWholeScreen) {
+    mock_oled_reset();
+    ASSERT_TRUE(oled_init(OLED_ROTATION_0));
+    mock_i2c_reset_stats();
+    flush();
+    EXPECT_EQ(mock_i2c_data_bytes, OLED_MATRIX_SIZE);
+    EXPECT_EQ(mock_i2c_bytes, OLED_MATRIX_SIZE + OLED_BLOCK_COUNT * WINDOW_OVERHEAD);
+}
+
+TEST_F(OledTest, TestUnchangedTextSendsNothing) {
+    oled_write_ln("Layer: Base", false);
+    flush();
+    mock_i2c_reset_stats();
+
+    oled_set_cursor(0, 0);
+    oled_write_ln("Layer: Base", false);
+    EXPECT_EQ(oled_dirty, 0);
+    oled_render();
+    EXPECT_EQ(mock_i2c_transfers, 0);
+}
+
+TEST_F(OledTest, TestWpmCounter) {
+    oled_write("WPM: 045", false);
+    flush();
+    mock_i2c_reset_stats();
+
+    /* Only the last digit is sent, not the block around it */
+    oled_set_cursor(0, 0);
+    oled_write("WPM: 046", false);
+    flush();
+    EXPECT_EQ(mock_i2c_transfers, 2);
+    EXPECT_EQ(mock_i2c_data_bytes, OLED_FONT_WIDTH);
+    EXPECT_EQ(mock_i2c_bytes, OLED_FONT_WIDTH + WINDOW_OVERHEAD);
+    EXPECT_LT(mock_i2c_bytes, OLED_BLOCK_SIZE + WINDOW_OVERHEAD);
+}
+
+TEST_F(OledTest, TestWpmGraphBar) {
+    /* A new 24 pixel high bar at the right edge of a WPM graph spans three pages in one window */
+    for (uint8_t y = 8; y < 32; ++y) {
+        oled_write_pixel(OLED_DISPLAY_WIDTH - 1, y, true);
+    }
+    flush();
+    EXPECT_EQ(mock_i2c_transfers, 2);
+    EXPECT_EQ(mock_i2c_data_bytes, 3);
+    EXPECT_EQ(mock_i2c_bytes, 3 + WINDOW_OVERHEAD);
+}
+
+TEST_F(OledTest, TestLayerName) {
+    oled_write_ln("Layer: Base", false);
+    flush();
+    mock_i2c_reset_stats();
+
+    oled_set_cursor(0, 0);
+    oled_write_ln("Layer: Lower", false);
+    flush();
+    EXPECT_EQ(mock_i2c_transfers, 2);
+    EXPECT_EQ(mock_i2c_data_bytes, 5 * OLED_FONT_WIDTH);
+    EXPECT_EQ(mock_i2c_bytes, 5 * OLED_FONT_WIDTH + WINDOW_OVERHEAD);
+}
+
+TEST_F(OledTest, TestLayerHighlight) {
+    oled_set_cursor(0, 1);
+    oled_write("BASE", true);
+    oled_write(" LOWER RAISE", false);
+    flush();
+    mock_i2c_reset_stats();
+
+    oled_set_cursor(0, 1);
+    oled_write("BASE ", false);
+    oled_write("LOWER", true);
+    flush();
+
+    /* One span from BASE to the end of LOWER, split into windows of at most a block */
+    uint16_t span    = 10 * OLED_FONT_WIDTH;
+    uint16_t windows = (span + OLED_BLOCK_SIZE - 1) / OLED_BLOCK_SIZE;
+    EXPECT_EQ(mock_i2c_transfers, 2 * windows);
+    EXPECT_EQ(mock_i2c_data_bytes, span);
+    EXPECT_EQ(mock_i2c_bytes, span + windows * WINDOW_OVERHEAD);
+}
+
+TEST_F(OledTest, TestNearbyPagesMerge) {
+    oled_write_pixel(10, 0, true);
+    oled_write_pixel(12, 9, true);
+    flush();
+    EXPECT_EQ(mock_i2c_transfers, 2);
+    EXPECT_EQ(mock_i2c_data_bytes, 2 * 3);
+}
+
+TEST_F(OledTest, TestDistantColumnsStaySeparate) {
+    oled_write_pixel(0, 0, true);
+    oled_write_pixel(OLED_DISPLAY_WIDTH - 8, 8, true);
+    flush();
+    EXPECT_EQ(mock_i2c_transfers, 4);
+    EXPECT_EQ(mock_i2c_data_bytes, 2);
+}
+
+TEST_F(OledTest, TestRawWrites) {
+    oled_write_raw_byte(0xFF, OLED_DISPLAY_WIDTH + 5);
+    flush();
+    EXPECT_EQ(mock_i2c_transfers, 2);
+    EXPECT_EQ(mock_i2c_data_bytes, 1);
+    mock_i2c_reset_stats();
+
+    static const char logo[] = {0x3C, 0x42, 0x81, 0x81, 0x42, 0x3C};
+    oled_set_cursor(4, 2);
+    oled_write_raw(logo, sizeof(logo));
+    flush();
+    EXPECT_EQ(mock_i2c_transfers, 2);
+    EXPECT_EQ(mock_i2c_data_bytes, 6);
+}
+
+TEST_F(OledTest, TestPanSendsWholeScreen) {
+    oled_write("WPM: 045", false);
+    flush();
+    mock_i2c_reset_stats();
+
+    oled_pan(true);
+    flush();
+    EXPECT_EQ(mock_i2c_data_bytes, OLED_MATRIX_SIZE);
+}
@@ -0,0 +1,61 @@
+oled_DEFS := -DNO_DEBUG -DOLED_ENABLE
+
+oled_INC := \
+	$(DRIVER_PATH)/oled/tests \
+	$(DRIVER_PATH)/oled
+
+oled_SRC := \
+	$(DRIVER_PATH)/oled/tests/mock.c \
+	$(DRIVER_PATH)/oled/tests/oled_tests.cpp \
+	$(DRIVER_PATH)/oled/ssd1306_sh1106.c \
+	$(DRIVER_PATH)/oled/mono_surface.c \
+	$(DRIVER_PATH)/oled/mono_rle.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
+
+oled_128x64_DEFS := $(oled_DEFS) -DOLED_DISPLAY_128X64
+oled_128x64_INC  := $(oled_INC)
+oled_128x64_SRC  := $(oled_SRC)
+
+oled_rotation_DEFS := $(oled_DEFS)
+oled_rotation_INC  := $(oled_INC)
+
+oled_rotation_SRC := \
+	$(DRIVER_PATH)/oled/tests/mock.c \
+	$(DRIVER_PATH)/oled/tests/oled_rotation_tests.cpp \
+	$(DRIVER_PATH)/oled/ssd1306_sh1106.c \
+	$(DRIVER_PATH)/oled/mono_surface.c \
+	$(DRIVER_PATH)/oled/mono_rle.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
+
+oled_rotate_on_write_DEFS := $(oled_DEFS) -DOLED_ROTATE_ON_WRITE
+oled_rotate_on_write_INC  := $(oled_INC)
+oled_rotate_on_write_SRC  := $(oled_rotation_SRC)
+
+oled_async_DEFS := $(oled_DEFS) -DMOCK_I2C_ASYNC
+oled_async_INC  := $(oled_INC)
+
+oled_async_SRC := \
+	$(DRIVER_PATH)/oled/tests/mock.c \
+	$(DRIVER_PATH)/oled/tests/oled_async_tests.cpp \
+	$(DRIVER_PATH)/oled/ssd1306_sh1106.c \
+	$(DRIVER_PATH)/oled/mono_surface.c \
+	$(DRIVER_PATH)/oled/mono_rle.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
+
+oled_no_async_render_DEFS := $(oled_DEFS) -DMOCK_I2C_ASYNC -DOLED_NO_ASYNC_RENDER
+oled_no_async_render_INC  := $(oled_INC)
+oled_no_async_render_SRC  := $(oled_SRC)
+
+mono_surface_DEFS := -DNO_DEBUG
+
+mono_surface_INC := \
+	$(DRIVER_PATH)/oled
+
+mono_surface_SRC := \
+	$(DRIVER_PATH)/oled/tests/mono_surface_tests.cpp \
+	$(DRIVER_PATH)/oled/mono_surface.c \
+	$(DRIVER_PATH)/oled/mono_rle.c
+
+mono_surface_rotation_DEFS := $(mono_surface_DEFS) -DMONO_SURFACE_ROTATION
+mono_surface_rotation_INC  := $(mono_surface_INC)
+mono_surface_rotation_SRC  := $(mono_surface_SRC)
@@ -0,0 +1,9 @@
+TEST_LIST += \
+	oled \
+	oled_128x64 \
+	oled_rotation \
+	oled_rotate_on_write \
+	oled_async \
+	oled_no_async_render \
+	mono_surface \
+	mono_surface_rotation
@@ -68,3 +68,9 @@
  *         - Wait 50us to reset the LEDs
  */
 void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds);
+
+/* Drivers that send in the background return from ws2812_setleds() right away
+ * and call this once the frame including the reset time is out. It runs in
+ * interrupt context.
+ */
+void ws2812_transfer_complete(void);
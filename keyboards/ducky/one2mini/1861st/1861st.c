@@ -3,6 +3,7 @@
 #include "1861st.h"
 
 void bootloader_jump(void) {
+    bootloader_jump_prepare();
     // TODO: Work out how to jump to LDROM, for now just reset the board.
     NVIC_SystemReset();
 }
@@ -17,6 +17,7 @@ void board_init(void) {
 }
 
 void bootloader_jump(void) {
+    bootloader_jump_prepare();
     // This board doesn't use the "standard" stm32duino bootloader, and is resident in memory at the base location. All we can do here is reset.
     NVIC_SystemReset();
 }
@@ -31,5 +31,6 @@ LAYOUTS = 60_iso
 SRC =	keyboards/wilba_tech/wt_main.c \
 		keyboards/wilba_tech/wt_rgb_backlight.c \
 		drivers/led/issi/is31fl3733.c \
+		drivers/led/issi/is31fl_queue.c \
 		quantum/color.c \
 		i2c_master.c
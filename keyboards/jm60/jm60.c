@@ -22,6 +22,7 @@ void board_init(void) {
 }
 
 void bootloader_jump(void) {
+    bootloader_jump_prepare();
     // This board doesn't use the "standard" stm32duino bootloader. There's no information on how to jump to the custom bootloader, so all we can do here is reset.
     NVIC_SystemReset();
 }
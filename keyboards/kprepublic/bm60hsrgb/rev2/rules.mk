@@ -24,4 +24,5 @@ WS2812_DRIVER_REQUIRED = yes
 
 COMMON_VPATH += $(DRIVER_PATH)/led/issi
 SRC += is31fl3733.c
+SRC += is31fl_queue.c
 QUANTUM_LIB_SRC += i2c_master.c
@@ -27,5 +27,6 @@ RGB_MATRIX_ENABLE = yes
 RGB_MATRIX_DRIVER = custom
 COMMON_VPATH += $(DRIVER_PATH)/led/issi
 SRC += is31fl3733.c
+SRC += is31fl_queue.c
 QUANTUM_LIB_SRC += i2c_master.c
 WS2812_DRIVER_REQUIRED = yes
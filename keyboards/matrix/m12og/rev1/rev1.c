@@ -21,6 +21,7 @@ void board_init(void) {
 }
 
 void bootloader_jump(void) {
+    bootloader_jump_prepare();
     // This board doesn't use the standard DFU bootloader, and no information is available regarding how to enter bootloader mode. All we can do here is reset.
     NVIC_SystemReset();
 }
@@ -61,6 +61,7 @@ void shutdown_user(void)
 }
 
 void bootloader_jump(void) {
+    bootloader_jump_prepare();
     shutdown_user();
     NVIC_SystemReset();
 }
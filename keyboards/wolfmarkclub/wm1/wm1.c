@@ -1,6 +1,7 @@
 #include "wm1.h"
 
 void bootloader_jump(void) {
+    bootloader_jump_prepare();
     // This board doesn't use the "standard" stm32duino bootloader, and no information is available regarding how to enter bootloader mode. All we can do here is reset.
     NVIC_SystemReset();
 }
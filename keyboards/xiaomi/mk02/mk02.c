@@ -1,6 +1,7 @@
 #include "mk02.h"
 
 void bootloader_jump(void) {
+    bootloader_jump_prepare();
     uint32_t *magic_address = (void*)0x20000FFC;
     *magic_address = 0x626c6472;
 
@@ -0,0 +1,190 @@
+"""Convert SONG definitions into compact songs of note numbers and durations.
+"""
+import math
+import re
+
+from argcomplete.completers import FilesCompleter
+from milc import cli
+
+import qmk.path
+from qmk.comment_remover import comment_remover
+from qmk.constants import QMK_FIRMWARE
+
+SONG_LIST = QMK_FIRMWARE / 'quantum' / 'audio' / 'song_list.h'
+MAX_DURATION = 511  # SONG_NOTE_MAX_DURATION in musical_notes.h
+NOTE_NAMES = ['C', 'CS', 'D', 'DS', 'E', 'F', 'FS', 'G', 'GS', 'A', 'AS', 'B']
+PITCH_CLASSES = {'C': 0, 'D': 2, 'E': 4, 'F': 5, 'G': 7, 'A': 9, 'B': 11}
+
+# The note type macros of musical_notes.h, with their durations
+NOTE_TYPES = {}
+for short, long, duration in (('B', 'BREVE', 128), ('W', 'WHOLE', 64), ('H', 'HALF', 32), ('Q', 'QUARTER', 16), ('E', 'EIGHTH', 8), ('S', 'SIXTEENTH', 4), ('T', 'THIRTYSECOND', 2)):
+    NOTE_TYPES[f'{short}__NOTE'] = NOTE_TYPES[f'{long}_NOTE'] = duration
+    NOTE_TYPES[f'{short}D_NOTE'] = NOTE_TYPES[f'{long}_DOT_NOTE'] = duration + duration // 2
+
+
+def read_definitions(text):
+    """Returns the #defines and the float SONG arrays of a C file, as dicts of name to body.
+    """
+    text = comment_remover(text).replace('\\\n', ' ')
+    defines = dict(re.findall(r'^[ \t]*#[ \t]*define[ \t]+(\w+)[ \t]+(.*)$', text, re.MULTILINE))
+    arrays = {}
+    for match in re.finditer(r'float\s+(\w+)\s*\[\s*\]\s*\[\s*2\s*\]\s*=\s*(?:SONG\s*\((.*?)\)|\{(.*?)\})\s*;', text, re.DOTALL):
+        arrays[match.group(1)] = match.group(2) if match.group(2) is not None else match.group(3)
+    return defines, arrays
+
+
+def split_top_level(text):
+    """Splits a list of C expressions at the commas outside of parentheses and braces.
+    """
+    items, depth, start = [], 0, 0
+    for pos, char in enumerate(text):
+        if char in '({':
+            depth += 1
+        elif char in ')}':
+            depth -= 1
+        elif char == ',' and depth == 0:
+            items.append(text[start:pos].strip())
+            start = pos + 1
+    items.append(text[start:].strip())
+    return [item for item in items if item]
+
+
+def evaluate(expression):
+    """Evaluates the integer arithmetic of a duration, like '16 + 8'.
+    """
+    expression = expression.strip().rstrip('fF')
+    if not re.fullmatch(r'[\d\s+\-*/().]+', expression):
+        raise ValueError(f'Not a number: {expression}')
+    return int(eval(expression))  # nosec - only digits and operators
+
+
+def note_number(name):
+    """Returns the note number of a musical_notes.h name like '_CS4' or '_REST'.
+    """
+    if name == '_REST':
+        return 0
+    match = re.fullmatch(r'_([A-G])([SF]?)(\d)', name)
+    if not match:
+        raise ValueError(f'Unknown note: {name}')
+    pitch, accidental, octave = match.groups()
+    return 12 * (int(octave) + 1) + PITCH_CLASSES[pitch] + {'S': 1, 'F': -1, '': 0}[accidental]
+
+
+def frequency_number(frequency):
+    """Returns the nearest note number of a frequency in Hz, or of a NOTE_ name.
+    """
+    frequency = frequency.strip().strip('()')
+    if frequency.startswith('NOTE_'):
+        return note_number(frequency[4:])
+    frequency = float(frequency.rstrip('fF'))
+    if frequency <= 0:
+        return 0
+    number = round(69 + 12 * math.log2(frequency / 440))
+    if abs(1200 * math.log2(frequency / 440) - 100 * (number - 69)) > 10:
+        cli.log.warning('%sHz is not a note, playing it as %s', frequency, note_name(number))
+    return number
+
+
+def note_name(number):
+    """Returns the musical_notes.h name of a note number.
+    """
+    if number == 0:
+        return '_REST'
+    return f'_{NOTE_NAMES[number % 12]}{number // 12 - 1}'
+
+
+def parse_notes(body, defines, seen=()):
+    """Returns the (note number, duration) tuples of a SONG body, expanding the songs it refers to.
+    """
+    notes = []
+    for item in split_top_level(body):
+        macro = re.fullmatch(r'(\w+)\s*\((.*)\)', item, re.DOTALL)
+        pair = re.fullmatch(r'\{(.*)\}', item, re.DOTALL)
+
+        if macro and macro.group(1) in NOTE_TYPES:
+            notes.append((note_number(macro.group(2).strip()), NOTE_TYPES[macro.group(1)]))
+        elif macro and macro.group(1) in ('M__NOTE', 'MUSICAL_NOTE'):
+            note, duration = split_top_level(macro.group(2))
+            notes.append((note_number(note), evaluate(duration)))
+        elif pair:
+            frequency, duration = split_top_level(pair.group(1))
+            notes.append((frequency_number(frequency), evaluate(duration)))
+        elif re.fullmatch(r'\w+', item) and item in defines and item not in seen:
+            notes += parse_notes(defines[item], defines, seen + (item,))
+        else:
+            raise ValueError(f'Not a note: {item}')
+
+    for note, duration in notes:
+        if not 0 <= note <= 127 or not 0 <= duration <= MAX_DURATION:
+            raise ValueError(f'{note_name(note)} with a duration of {duration} does not fit a SONG_NOTE')
+
+    return notes
+
+
+def format_notes(notes):
+    return ', '.join(f'SONG_NOTE({note_name(note)}, {duration})' for note, duration in notes)
+
+
+@cli.argument('-o', '--output', arg_only=True, type=qmk.path.normpath, help='File to write to')
+@cli.argument('-q', '--quiet', arg_only=True, action='store_true', help='Quiet mode, only output error messages')
+@cli.argument('filename', arg_only=True, type=qmk.path.normpath, completer=FilesCompleter('.h'), help='C file with SONGs, such as a song list or a keymap')
+@cli.subcommand('Converts SONGs into compact songs for PLAY_COMPACT_SONG.')
+def generate_compact_song(cli):
+    """Converts the SONGs of a file into compact songs, see quantum/audio/musical_notes.h for the format.
+
+    Songs defined as a list of notes become a #define with a _COMPACT suffix, float SONG arrays become song_note_t arrays in PROGMEM of the same name. Songs of quantum/audio/song_list.h can be referred to.
+    """
+    if not cli.args.filename.exists():
+        cli.log.error('File not found: %s', cli.args.filename)
+        return False
+
+    defines, arrays = read_definitions(cli.args.filename.read_text())
+    library = dict(read_definitions(SONG_LIST.read_text())[0]) if SONG_LIST.exists() else {}
+    library.update(defines)
+
+    songs = []
+    for name, body in defines.items():
+        if f'{name}_COMPACT' in library:
+            continue
+        try:
+            notes = parse_notes(body, library, (name,))
+        except ValueError:
+            continue  # not a song
+        if notes:
+            songs.append((f'#define {name}_COMPACT ', notes, ''))
+
+    for name, body in arrays.items():
+        try:
+            notes = parse_notes(body, library)
+        except ValueError as e:
+            cli.log.error('%s: %s', name, e)
+            return False
+        songs.append((f'static const song_note_t PROGMEM {name}[] = SONG(', notes, ');'))
+
+    if not songs:
+        cli.log.error('No SONGs found in %s', cli.args.filename)
+        return False
+
+    count = sum(len(notes) for _, notes, _ in songs)
+    song_h = '''/* This file was generated by `qmk generate-compact-song`. Do not edit or copy.
+ */
+
+#pragma once
+
+#include "audio.h"
+
+// clang-format off
+'''
+    for start, notes, end in songs:
+        song_h += f'\n// {len(notes)} notes, {2 * len(notes)} bytes ({8 * len(notes)} as floats)\n{start}{format_notes(notes)}{end}\n'
+
+    if cli.args.output:
+        cli.args.output.parent.mkdir(parents=True, exist_ok=True)
+        if cli.args.output.exists():
+            cli.args.output.replace(cli.args.output.parent / (cli.args.output.name + '.bak'))
+        cli.args.output.write_text(song_h)
+
+        if not cli.args.quiet:
+            cli.log.info('Wrote %d songs of %d notes, %d bytes (%d as floats) to %s.', len(songs), count, 2 * count, 8 * count, cli.args.output)
+    else:
+        print(song_h)
@@ -0,0 +1,225 @@
+"""Compress monochrome images and fonts for the OLED and ST7565 drivers.
+"""
+import re
+from argparse import ArgumentTypeError
+
+from argcomplete.completers import FilesCompleter
+from milc import cli
+
+import qmk.path
+from qmk.comment_remover import comment_remover
+
+MAX_LITERAL = 128
+MAX_RUN = 129
+
+
+def byte_value(value):
+    value = int(value, 0)
+    if value in range(1, 256):
+        return value
+    else:
+        raise ArgumentTypeError('Value must be between 1 and 255')
+
+
+def read_pbm(path):
+    """Returns the width, height and pixel rows of a PBM (P1 or P4) image.
+    """
+    data = path.read_bytes()
+    fields = []
+    pos = 0
+
+    # Magic number, width and height, with comments allowed in between
+    while len(fields) < 3:
+        match = re.compile(rb'\s*(#[^\n]*\n\s*)*(\S+)').match(data, pos)
+        if not match:
+            raise ValueError(f'{path} is not a PBM image')
+        fields.append(match.group(2))
+        pos = match.end()
+
+    magic, width, height = fields[0], int(fields[1]), int(fields[2])
+    if magic == b'P4':
+        stride = (width + 7) // 8
+        raster = data[pos + 1:pos + 1 + stride * height]
+        rows = [[bool(raster[y * stride + x // 8] & (0x80 >> x % 8)) for x in range(width)] for y in range(height)]
+    elif magic == b'P1':
+        bits = [c == ord('1') for c in data[pos:] if c in b'01']
+        rows = [bits[y * width:(y + 1) * width] for y in range(height)]
+    else:
+        raise ValueError(f'{path} is not a PBM image')
+
+    if len(rows) < height or any(len(row) < width for row in rows):
+        raise ValueError(f'{path} is truncated')
+
+    return width, height, rows
+
+
+def pack_pages(rows, width, top, height):
+    """Packs pixel rows into the display layout, pages of 8 rows with one byte per column.
+    """
+    data = []
+    for page in range(0, height, 8):
+        for x in range(width):
+            byte = 0
+            for bit in range(min(8, height - page)):
+                if rows[top + page + bit][x]:
+                    byte |= 1 << bit
+            data.append(byte)
+    return data
+
+
+def read_c_array(path):
+    """Returns the values of the first array initializer in a C file, such as glcdfont.c.
+    """
+    text = comment_remover(path.read_text())
+    start = text.find('{')
+    end = text.rfind('}')
+    if start < 0 or end < start:
+        raise ValueError(f'No array found in {path}')
+
+    values = [int(value, 0) for value in re.findall(r'\b(0[xX][0-9a-fA-F]+|0[bB][01]+|\d+)\b', text[start:end])]
+    if any(value > 255 for value in values):
+        raise ValueError(f'{path} has values that are not bytes')
+
+    return values
+
+
+def encode_block(data):
+    """Run-length encodes the data of a block.
+
+    Runs of 3 bytes or more become a run token, runs of 2 only where they don't split a literal.
+    """
+    stream = bytearray()
+    literal = None
+    pos = 0
+
+    while pos < len(data):
+        run = 1
+        while pos + run < len(data) and run < MAX_RUN and data[pos + run] == data[pos]:
+            run += 1
+
+        if run >= 3 or (run == 2 and literal is None):
+            stream += bytes((0x80 | (run - 2), data[pos]))
+            literal = None
+            pos += run
+            continue
+
+        if literal is None:
+            literal = len(stream)
+            stream.append(0)
+        else:
+            stream[literal] += 1
+        stream.append(data[pos])
+        pos += 1
+        if stream[literal] == MAX_LITERAL - 1:
+            literal = None
+
+    return stream
+
+
+def encode(data, width, height, frames_per_block):
+    """Returns the compressed image, see drivers/oled/mono_rle.h for the format.
+    """
+    frame_size = width * ((height + 7) // 8)
+    frames = len(data) // frame_size
+    block_size = frames_per_block * frame_size
+    header = bytearray((width, height, frames & 0xFF, frames >> 8, frames_per_block))
+    stream = bytearray()
+
+    for block in range(0, frames * frame_size, block_size):
+        header += bytes((len(stream) & 0xFF, len(stream) >> 8))
+        stream += encode_block(data[block:min(block + block_size, frames * frame_size)])
+
+        if len(stream) > 0xFFFF:
+            raise ValueError('The compressed image is larger than 64 KiB')
+
+    return header + stream
+
+
+@cli.argument('-o', '--output', arg_only=True, type=qmk.path.normpath, help='File to write to')
+@cli.argument('-q', '--quiet', arg_only=True, action='store_true', help='Quiet mode, only output error messages')
+@cli.argument('-n', '--name', arg_only=True, help='Name of the array. Default: the input file name, use "font" for OLED_FONT_H')
+@cli.argument('-w', '--width', arg_only=True, type=byte_value, help='Width of a frame, required for C input. Default: the image width')
+@cli.argument('-H', '--height', arg_only=True, type=byte_value, help='Height of a frame in pixels, required for C input. Default: the image height')
+@cli.argument('-b', '--block', arg_only=True, type=byte_value, help='Frames per block, more frames compress better but take longer to find. Default: about 96 bytes of frames')
+@cli.argument('filename', arg_only=True, type=qmk.path.normpath, completer=FilesCompleter('.pbm'), help='PBM image, or C file with a raw image or font array')
+@cli.subcommand('Compresses an image or font for the OLED and ST7565 drivers.')
+def generate_mono_rle(cli):
+    """Converts an image or font into the run-length compressed format of mono_rle.h.
+
+    PBM images are cut into frames of --height rows, C arrays (raw images as used with oled_write_raw_P, or a font like glcdfont.c) are already in the display layout and are cut into frames of --width by --height.
+    """
+    if not cli.args.filename.exists():
+        cli.log.error('File not found: %s', cli.args.filename)
+        return False
+
+    try:
+        if cli.args.filename.suffix.lower() == '.pbm':
+            image_width, image_height, rows = read_pbm(cli.args.filename)
+            width = cli.args.width or image_width
+            height = cli.args.height or image_height
+            if width != image_width or image_height % height or image_width > 255:
+                cli.log.error('The image must be at most 255 pixels wide, and a multiple of --height high')
+                return False
+            data = []
+            for top in range(0, image_height, height):
+                data += pack_pages(rows, width, top, height)
+
+        else:
+            if not cli.args.width or not cli.args.height:
+                cli.log.error('C input needs --width and --height')
+                return False
+            width, height = cli.args.width, cli.args.height
+            data = read_c_array(cli.args.filename)
+
+    except ValueError as e:
+        cli.log.error(e)
+        return False
+
+    frame_size = width * ((height + 7) // 8)
+    frames = len(data) // frame_size
+    if not frames or frames > 0xFFFF:
+        cli.log.error('Found %d bytes, which is not a frame of %d bytes or more than 65535 of them', len(data), frame_size)
+        return False
+    if len(data) % frame_size:
+        cli.log.warning('Ignoring %d bytes after the last whole frame', len(data) % frame_size)
+
+    frames_per_block = cli.args.block or max(1, min(255, 96 // frame_size))
+    try:
+        compressed = encode(data, width, height, frames_per_block)
+    except ValueError as e:
+        cli.log.error(e)
+        return False
+
+    name = cli.args.name or re.sub(r'\W', '_', cli.args.filename.stem)
+    plural = 's' if frames > 1 else ''
+
+    values = ''
+    for pos in range(0, len(compressed), 16):
+        values += '    ' + ', '.join(f'0x{value:02X}' for value in compressed[pos:pos + 16]) + ',\n'
+
+    image_c = f'''/* This file was generated by `qmk generate-mono-rle`. Do not edit or copy.
+ */
+
+#pragma once
+
+#include "progmem.h"
+
+// clang-format off
+
+// {width}x{height}, {frames} frame{plural} of {frame_size} bytes, {frames_per_block} per block
+// {len(compressed)} bytes compressed, {frames * frame_size} raw
+
+static const unsigned char PROGMEM {name}[] = {{
+{values}}};
+'''
+
+    if cli.args.output:
+        cli.args.output.parent.mkdir(parents=True, exist_ok=True)
+        if cli.args.output.exists():
+            cli.args.output.replace(cli.args.output.parent / (cli.args.output.name + '.bak'))
+        cli.args.output.write_text(image_c)
+
+        if not cli.args.quiet:
+            cli.log.info('Wrote %d bytes (%d raw) to %s.', len(compressed), frames * frame_size, cli.args.output)
+    else:
+        print(image_c)
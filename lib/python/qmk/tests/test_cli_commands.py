@@ -255,6 +255,20 @@ def test_generate_rgb_breathe_table():
     assert 'Breathing max:    127' in result.stdout
 
 
+def test_generate_mono_rle():
+    result = check_subcommand('generate-mono-rle', '-w', '6', '-H', '8', '-n', 'font', 'drivers/oled/glcdfont.c')
+    check_returncode(result)
+    assert 'static const unsigned char PROGMEM font[] = {' in result.stdout
+    assert '6x8, 224 frames of 6 bytes, 16 per block' in result.stdout
+
+
+def test_generate_compact_song():
+    result = check_subcommand('generate-compact-song', 'quantum/audio/song_list.h')
+    check_returncode(result)
+    assert '#define ODE_TO_JOY_COMPACT SONG_NOTE(_E4, 16), SONG_NOTE(_E4, 16), SONG_NOTE(_F4, 16),' in result.stdout
+    assert '// 15 notes, 30 bytes (120 as floats)' in result.stdout
+
+
 def test_generate_config_h():
     result = check_subcommand('generate-config-h', '-kb', 'handwired/pytest/basic')
     check_returncode(result)
@@ -25,6 +25,7 @@ extern uint32_t _eram;
 
 // CTRL keyboards released with bootloader version below must use RAM method. Otherwise use WDT method.
 void bootloader_jump(void) {
+    bootloader_jump_prepare();
 #ifdef KEYBOARD_massdrop_ctrl
     uint8_t  ver_ram_method[] = "v2.18Jun 22 2018 17:28:08"; // The version to match (NULL terminated by compiler)
     uint8_t *ver_check        = ver_ram_method;              // Pointer to version match string for traversal
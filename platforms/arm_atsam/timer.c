@@ -30,6 +30,10 @@ uint32_t timer_elapsed32(uint32_t tlast) {
     return TIMER_DIFF_32(timer_read32(), tlast);
 }
 
+uint32_t timer_read_us32(void) {
+    return timer_read32() * 1000;
+}
+
 void timer_clear(void) {
     set_time(0);
 }
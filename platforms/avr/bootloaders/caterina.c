@@ -19,6 +19,7 @@
 #include <avr/wdt.h>
 
 __attribute__((weak)) void bootloader_jump(void) {
+    bootloader_jump_prepare();
     // this block may be optional
     // TODO: figure it out
 
@@ -16,4 +16,6 @@
 
 #include "bootloader.h"
 
-__attribute__((weak)) void bootloader_jump(void) {}
+__attribute__((weak)) void bootloader_jump(void) {
+    bootloader_jump_prepare();
+}
@@ -29,6 +29,7 @@
 uint32_t reset_key __attribute__((section(".noinit,\"aw\",@nobits;")));
 
 __attribute__((weak)) void bootloader_jump(void) {
+    bootloader_jump_prepare();
     UDCON  = 1;
     USBCON = (1 << FRZCLK); // disable USB
     UCSR1B = 0;
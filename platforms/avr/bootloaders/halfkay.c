@@ -20,6 +20,7 @@
 #include <util/delay.h>
 
 __attribute__((weak)) void bootloader_jump(void) {
+    bootloader_jump_prepare();
     // http://www.pjrc.com/teensy/jump_to_bootloader.html
 
     cli();
@@ -27,6 +27,7 @@
 #endif
 
 __attribute__((weak)) void bootloader_jump(void) {
+    bootloader_jump_prepare();
     // Taken with permission of Stephan Baerwolf from https://github.com/tinyusbboard/API/blob/master/apipage.c
 
     wdt_enable(WDTO_15MS);
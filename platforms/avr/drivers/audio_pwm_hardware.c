@@ -29,6 +29,11 @@ extern uint8_t note_timbre;
 
 #define CPU_PRESCALER 8
 
+// timer ticks per period of a frequency in 1/256 Hz, integer math to keep the soft-float routines out of the ISR
+#define PERIOD_TICKS(frequency) ((((uint32_t)F_CPU / CPU_PRESCALER) << AUDIO_FREQ_SHIFT) / (frequency))
+// number of ISR calls (one per period) between state updates, which makes for about 64 updates per second
+#define ISR_INTERVAL(frequency) ((frequency) / ((CPU_PRESCALER * 8) << AUDIO_FREQ_SHIFT))
+
 /*
   Audio Driver: PWM
 
@@ -150,9 +155,9 @@ extern uint8_t note_timbre;
 // -----------------------------------------------------------------------------
 
 #ifdef AUDIO1_PIN_SET
-static float channel_1_frequency = 0.0f;
-void         channel_1_set_frequency(float freq) {
-    if (freq == 0.0f) // a pause/rest is a valid "note" with freq=0
+static uint16_t channel_1_isr_interval = 0;
+void            channel_1_set_frequency(audio_freq_t freq) {
+    if (freq == 0) // a pause/rest is a valid "note" with freq=0
     {
         // disable the output, but keep the pwm-ISR going (with the previous
         // frequency) so the audio-state keeps getting updated
@@ -163,12 +168,13 @@ void         channel_1_set_frequency(float freq) {
         AUDIO1_TCCRxA |= _BV(AUDIO1_COMxy1); // enable output, PWM mode
     }
 
-    channel_1_frequency = freq;
+    channel_1_isr_interval = ISR_INTERVAL(freq);
 
+    uint32_t period = PERIOD_TICKS(freq);
     // set pwm period
-    AUDIO1_ICRx = (uint16_t)(((float)F_CPU) / (freq * CPU_PRESCALER));
+    AUDIO1_ICRx = (uint16_t)period;
     // and duty cycle
-    AUDIO1_OCRxy = (uint16_t)((((float)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre / 100);
+    AUDIO1_OCRxy = (uint16_t)(period * note_timbre / 100);
 }
 
 void channel_1_start(void) {
@@ -187,22 +193,25 @@ void channel_1_stop(void) {
 #endif
 
 #ifdef AUDIO2_PIN_SET
-static float channel_2_frequency = 0.0f;
-void         channel_2_set_frequency(float freq) {
-    if (freq == 0.0f) {
+static uint16_t     channel_2_isr_interval = 0;
+static audio_freq_t channel_2_frequency    = 0;
+void                channel_2_set_frequency(audio_freq_t freq) {
+    if (freq == 0) {
         AUDIO2_TCCRxA &= ~(_BV(AUDIO2_COMxy1) | _BV(AUDIO2_COMxy0));
         return;
     } else {
         AUDIO2_TCCRxA |= _BV(AUDIO2_COMxy1);
     }
 
-    channel_2_frequency = freq;
+    channel_2_frequency    = freq;
+    channel_2_isr_interval = ISR_INTERVAL(freq);
 
-    AUDIO2_ICRx  = (uint16_t)(((float)F_CPU) / (freq * CPU_PRESCALER));
-    AUDIO2_OCRxy = (uint16_t)((((float)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre / 100);
+    uint32_t period = PERIOD_TICKS(freq);
+    AUDIO2_ICRx     = (uint16_t)period;
+    AUDIO2_OCRxy    = (uint16_t)(period * note_timbre / 100);
 }
 
-float channel_2_get_frequency(void) {
+audio_freq_t channel_2_get_frequency(void) {
     return channel_2_frequency;
 }
 
@@ -272,14 +281,14 @@ void audio_driver_start(void) {
 #ifdef AUDIO1_PIN_SET
     channel_1_start();
     if (playing_note) {
-        channel_1_set_frequency(audio_get_processed_frequency(0));
+        channel_1_set_frequency(audio_get_processed_frequency_fixed(0));
     }
 #endif
 
 #if !defined(AUDIO1_PIN_SET) && defined(AUDIO2_PIN_SET)
     channel_2_start();
     if (playing_note) {
-        channel_2_set_frequency(audio_get_processed_frequency(0));
+        channel_2_set_frequency(audio_get_processed_frequency_fixed(0));
     }
 #endif
 }
@@ -288,7 +297,7 @@ static volatile uint32_t isr_counter = 0;
 #ifdef AUDIO1_PIN_SET
 ISR(AUDIO1_TIMERx_COMPy_vect) {
     isr_counter++;
-    if (isr_counter < channel_1_frequency / (CPU_PRESCALER * 8)) return;
+    if (isr_counter < channel_1_isr_interval) return;
 
     isr_counter        = 0;
     bool state_changed = audio_update_state();
@@ -302,10 +311,10 @@ ISR(AUDIO1_TIMERx_COMPy_vect) {
     }
 
     if (state_changed) {
-        channel_1_set_frequency(audio_get_processed_frequency(0));
+        channel_1_set_frequency(audio_get_processed_frequency_fixed(0));
 #    ifdef AUDIO2_PIN_SET
         if (audio_get_number_of_active_tones() > 1) {
-            channel_2_set_frequency(audio_get_processed_frequency(1));
+            channel_2_set_frequency(audio_get_processed_frequency_fixed(1));
         } else {
             channel_2_stop();
         }
@@ -317,7 +326,7 @@ ISR(AUDIO1_TIMERx_COMPy_vect) {
 #if !defined(AUDIO1_PIN_SET) && defined(AUDIO2_PIN_SET)
 ISR(AUDIO2_TIMERx_COMPy_vect) {
     isr_counter++;
-    if (isr_counter < channel_2_frequency / (CPU_PRESCALER * 8)) return;
+    if (isr_counter < channel_2_isr_interval) return;
 
     isr_counter        = 0;
     bool state_changed = audio_update_state();
@@ -328,7 +337,7 @@ ISR(AUDIO2_TIMERx_COMPy_vect) {
     }
 
     if (state_changed) {
-        channel_2_set_frequency(audio_get_processed_frequency(0));
+        channel_2_set_frequency(audio_get_processed_frequency_fixed(0));
     }
 }
 #endif
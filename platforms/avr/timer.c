@@ -134,6 +134,33 @@ inline uint32_t timer_elapsed32(uint32_t last) {
     return TIMER_DIFF_32(t, last);
 }
 
+/** \brief timer read_us32
+ *
+ * Combines the millisecond count with the raw timer value, the resolution is TIMER_PRESCALER clock cycles.
+ */
+uint32_t timer_read_us32(void) {
+    uint32_t t;
+    uint8_t  raw;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        t   = timer_count;
+        raw = TIMER_RAW;
+        // the counter has already wrapped, but the interrupt hasn't run yet
+#if defined(__AVR_ATmega32A__)
+        if (TIFR & _BV(OCF0)) {
+#elif defined(__AVR_ATtiny85__)
+        if (TIFR & _BV(OCF0A)) {
+#else
+        if (TIFR0 & _BV(OCF0A)) {
+#endif
+            t++;
+            raw = TIMER_RAW;
+        }
+    }
+
+    return t * 1000 + (uint32_t)raw * 1000 / TIMER_RAW_TOP;
+}
+
 // excecuted once per 1ms.(excess for just timer count?)
 #ifndef __AVR_ATmega32A__
 #    define TIMER_INTERRUPT_VECTOR TIMER0_COMPA_vect
@@ -17,5 +17,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 
+#ifdef EEPROM_DRIVER
+#    include "eeprom_driver.h"
+#endif
+
 /* give code for your bootloader to come up if needed */
 void bootloader_jump(void);
+
+/* saves what would be lost by the jump, implementations of bootloader_jump() call this first */
+static inline void bootloader_jump_prepare(void) {
+#ifdef EEPROM_DRIVER
+    eeprom_driver_flush();
+#endif
+}
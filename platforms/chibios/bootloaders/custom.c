@@ -16,6 +16,8 @@
 
 #include "bootloader.h"
 
-__attribute__((weak)) void bootloader_jump(void) {}
+__attribute__((weak)) void bootloader_jump(void) {
+    bootloader_jump_prepare();
+}
 
 __attribute__((weak)) void enter_bootloader_mode_if_requested(void) {}
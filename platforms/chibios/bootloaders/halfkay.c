@@ -20,6 +20,7 @@
 #include "wait.h"
 
 __attribute__((weak)) void bootloader_jump(void) {
+    bootloader_jump_prepare();
     wait_ms(100);
     __BKPT(0);
 }
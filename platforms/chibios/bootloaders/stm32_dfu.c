@@ -42,6 +42,7 @@ extern uint32_t __ram0_end__;
 #    endif
 
 __attribute__((weak)) void bootloader_jump(void) {
+    bootloader_jump_prepare();
     // For STM32 MCUs with dual-bank flash, and we're incapable of jumping to the bootloader. The first valid flash
     // bank is executed unconditionally after a reset, so it doesn't enter DFU unless BOOT0 is high. Instead, we do
     // it with hardware...in this case, we pull a GPIO high/low depending on the configuration, connects 3.3V to
@@ -72,6 +73,7 @@ void enter_bootloader_mode_if_requested(void) {}
 #    define MAGIC_ADDR (unsigned long *)(SYMVAL(__ram0_end__) - 4)
 
 __attribute__((weak)) void bootloader_jump(void) {
+    bootloader_jump_prepare();
     *MAGIC_ADDR = BOOTLOADER_MAGIC; // set magic flag => reset handler will jump into boot loader
     NVIC_SystemReset();
 }
@@ -19,5 +19,6 @@
 #include <ch.h>
 
 __attribute__((weak)) void bootloader_jump(void) {
+    bootloader_jump_prepare();
     NVIC_SystemReset();
 }
@@ -26,6 +26,7 @@ extern uint32_t _board_dfu_dbl_tap[];
 #define DBL_TAP_REG _board_dfu_dbl_tap[0]
 
 __attribute__((weak)) void bootloader_jump(void) {
+    bootloader_jump_prepare();
     DBL_TAP_REG = DBL_TAP_MAGIC;
     NVIC_SystemReset();
 }
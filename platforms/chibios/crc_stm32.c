@@ -0,0 +1,52 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <hal.h>
+#include "crc.h"
+
+/* Only STM32 CRC units with a programmable polynomial can produce the same
+ * crc8 as the software implementation, all others keep using quantum/crc.c. */
+#if defined(CRC_CR_POLYSIZE) && !defined(CRC8_USE_TABLE)
+
+void crc_init(void) {
+#    if defined(RCC_AHBENR_CRCEN)
+    RCC->AHBENR |= RCC_AHBENR_CRCEN;
+#    elif defined(RCC_AHB1ENR_CRCEN)
+    RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN;
+#    endif
+
+    CRC->POL  = 0x31;
+    CRC->INIT = 0xFF;
+    CRC->CR   = CRC_CR_POLYSIZE_1; // 8 bit polynomial, no reflection
+}
+
+uint8_t crc8(const void *data, size_t data_len) {
+    const uint8_t *d = (const uint8_t *)data;
+    uint8_t        crc;
+
+    /* The unit is shared between the main loop and the split transport thread. */
+    osalSysLock();
+    CRC->CR |= CRC_CR_RESET;
+    while (data_len--) {
+        *(volatile uint8_t *)&CRC->DR = *d++;
+    }
+    crc = (uint8_t)CRC->DR;
+    osalSysUnlock();
+
+    return crc;
+}
+
+#endif
@@ -60,17 +60,17 @@
 
 #ifdef AUDIO_DAC_QUALITY_LOW
 #    define AUDIO_DAC_SAMPLE_RATE 22050U
-#    define AUDIO_MAX_SIMULTANEOUS_TONES 4
+#    define AUDIO_MAX_SIMULTANEOUS_TONES 8
 #endif
 
 #ifdef AUDIO_DAC_QUALITY_HIGH
 #    define AUDIO_DAC_SAMPLE_RATE 44100U
-#    define AUDIO_MAX_SIMULTANEOUS_TONES 2
+#    define AUDIO_MAX_SIMULTANEOUS_TONES 4
 #endif
 
 #ifdef AUDIO_DAC_QUALITY_VERY_HIGH
 #    define AUDIO_DAC_SAMPLE_RATE 88200U
-#    define AUDIO_MAX_SIMULTANEOUS_TONES 1
+#    define AUDIO_MAX_SIMULTANEOUS_TONES 2
 #endif
 
 #ifdef AUDIO_DAC_QUALITY_SANE_MINIMUM
@@ -100,9 +100,11 @@
  * The number of tones that can be played simultaneously. If too high a value
  * is used here, the keyboard will freeze and glitch-out when that many tones
  * are being played.
+ * The additive driver spends a table lookup and an addition per tone and
+ * sample; no more than AUDIO_TONE_STACKSIZE (8) tones are active at a time.
  */
 #ifndef AUDIO_MAX_SIMULTANEOUS_TONES
-#    define AUDIO_MAX_SIMULTANEOUS_TONES 2
+#    define AUDIO_MAX_SIMULTANEOUS_TONES 4
 #endif
 
 /**
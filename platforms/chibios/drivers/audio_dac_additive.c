@@ -81,11 +81,31 @@ static const dacsample_t dac_buffer_trapezoid[AUDIO_DAC_BUFFER_SIZE] = {0x0,   0
 
 static dacsample_t dac_buffer_empty[AUDIO_DAC_BUFFER_SIZE] = {AUDIO_DAC_OFF_VALUE};
 
-/* keep track of the sample position for for each frequency */
-static float dac_if[AUDIO_MAX_SIMULTANEOUS_TONES] = {0.0};
+#if defined(AUDIO_DAC_SAMPLE_WAVEFORM_SINE)
+#    define DAC_WAVETABLE dac_buffer_sine
+#elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_TRIANGLE)
+#    define DAC_WAVETABLE dac_buffer_triangle
+#elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_TRAPEZOID)
+#    define DAC_WAVETABLE dac_buffer_trapezoid
+#elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_SQUARE)
+#    define DAC_WAVETABLE dac_buffer_square
+#endif
 
-static float   active_tones_snapshot[AUDIO_MAX_SIMULTANEOUS_TONES] = {0, 0};
-static uint8_t active_tones_snapshot_length                        = 0;
+#define DAC_WAVETABLE_BITS 8
+_Static_assert(AUDIO_DAC_BUFFER_SIZE == 1 << DAC_WAVETABLE_BITS, "AUDIO_DAC_BUFFER_SIZE has to match the wavetable of the additive synthesis");
+
+/* Note: the 2/3 (of the phase increment) are necessary to get the correct frequencies on the
+ *       DAC output (as measured with an oscilloscope), since the gpt timer runs with
+ *       3*AUDIO_DAC_SAMPLE_RATE; and the DAC callback is called twice per conversion.
+ */
+#define DAC_EFFECTIVE_SAMPLE_RATE (AUDIO_DAC_SAMPLE_RATE * 3 / 2)
+
+/* one oscillator per active tone, the phase increments are computed only when the tones change;
+ * mixing the samples then takes no divisions or floating point math
+ */
+static synth_oscillator_t oscillators[AUDIO_MAX_SIMULTANEOUS_TONES];
+static uint8_t            active_tones_snapshot_length = 0;
+static uint32_t           oscillators_gain             = 0; // 1/number of oscillators, in 1/65536
 
 typedef enum {
     OUTPUT_SHOULD_START,
@@ -104,67 +124,55 @@ typedef enum {
 output_states_t state = OUTPUT_OFF_2;
 
 /**
- * Generation of the waveform being passed to the callback. Declared weak so users
- * can override it with their own wave-forms/noises.
+ * Generation of the waveform being passed to the callback: additive wave
+ * synthesis over all currently playing tones = adding up wavetable samples
+ * for each frequency, scaled by the number of active tones
  */
-__attribute__((weak)) uint16_t dac_value_generate(void) {
+static uint16_t additive_value_generate(void) {
     // DAC is running/asking for values but snapshot length is zero -> must be playing a pause
     if (active_tones_snapshot_length == 0) {
         return AUDIO_DAC_OFF_VALUE;
     }
 
-    /* doing additive wave synthesis over all currently playing tones = adding up
-     * sine-wave-samples for each frequency, scaled by the number of active tones
-     */
-    uint16_t value     = 0;
-    float    frequency = 0.0f;
-
+    uint32_t value = 0;
     for (uint8_t i = 0; i < active_tones_snapshot_length; i++) {
-        /* Note: a user implementation does not have to rely on the active_tones_snapshot, but
-         * could directly query the active frequencies through audio_get_processed_frequency */
-        frequency = active_tones_snapshot[i];
+        value += DAC_WAVETABLE[synth_oscillator_next(&oscillators[i], DAC_WAVETABLE_BITS)];
+    }
 
-        dac_if[i] = dac_if[i] + ((frequency * AUDIO_DAC_BUFFER_SIZE) / AUDIO_DAC_SAMPLE_RATE) * 2 / 3;
-        /*Note: the 2/3 are necessary to get the correct frequencies on the
-         *      DAC output (as measured with an oscilloscope), since the gpt
-         *      timer runs with 3*AUDIO_DAC_SAMPLE_RATE; and the DAC callback
-         *      is called twice per conversion.*/
+    return (value * oscillators_gain) >> 16;
+}
 
-        dac_if[i] = fmod(dac_if[i], AUDIO_DAC_BUFFER_SIZE);
+/**
+ * Declared weak so users can override it with their own wave-forms/noises.
+ *
+ * Note: a user implementation does not have to rely on the internal snapshot, but
+ * could directly query the active frequencies through audio_get_processed_frequency
+ */
+uint16_t dac_value_generate(void) __attribute__((weak, alias("additive_value_generate")));
 
-        // Wavetable generation/lookup
-        uint16_t dac_i = (uint16_t)dac_if[i];
+/**
+ * update the oscillators to the currently active tones
+ */
+static void update_active_tones_snapshot(void) {
+    uint8_t active_tones         = MIN(AUDIO_MAX_SIMULTANEOUS_TONES, audio_get_number_of_active_tones());
+    active_tones_snapshot_length = 0;
 
-#if defined(AUDIO_DAC_SAMPLE_WAVEFORM_SINE)
-        value += dac_buffer_sine[dac_i] / active_tones_snapshot_length;
-#elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_TRIANGLE)
-        value += dac_buffer_triangle[dac_i] / active_tones_snapshot_length;
-#elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_TRAPEZOID)
-        value += dac_buffer_trapezoid[dac_i] / active_tones_snapshot_length;
-#elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_SQUARE)
-        value += dac_buffer_square[dac_i] / active_tones_snapshot_length;
-#endif
-        /*
-        // SINE
-        value += dac_buffer_sine[dac_i] / active_tones_snapshot_length / 3;
-        // TRIANGLE
-        value += dac_buffer_triangle[dac_i] / active_tones_snapshot_length / 3;
-        // SQUARE
-        value += dac_buffer_square[dac_i] / active_tones_snapshot_length / 3;
-        //NOTE: combination of these three wave-forms is more exemplary - and doesn't sound particularly good :-P
-        */
-
-        // STAIRS (mostly usefully as test-pattern)
-        // value_avg = dac_buffer_staircase[dac_i] / active_tones_snapshot_length;
+    for (uint8_t i = 0; i < active_tones; i++) {
+        audio_freq_t freq = audio_get_processed_frequency_fixed(i);
+        if (freq > 0) { // disregard 'rest' notes, with valid frequency 0; which would only lower the resulting waveform volume during the additive synthesis step
+            // keeping the phase, for a smooth transition where a tone keeps playing
+            oscillators[active_tones_snapshot_length++].increment = synth_phase_increment(freq, DAC_EFFECTIVE_SAMPLE_RATE);
+        }
     }
 
-    return value;
+    oscillators_gain = active_tones_snapshot_length ? 0x10000 / active_tones_snapshot_length : 0;
 }
 
 /**
  * DAC streaming callback. Does all of the main computing for playing songs.
  *
  * Note: chibios calls this CB twice: during the 'half buffer event', and the 'full buffer event'.
+ *       while one half of the circular buffer is converted by DMA, the other half is filled here.
  */
 static void dac_end(DACDriver *dacp) {
     dacsample_t *sample_p = (dacp)->samples;
@@ -174,62 +182,69 @@ static void dac_end(DACDriver *dacp) {
         sample_p += AUDIO_DAC_BUFFER_SIZE / 2; // 'half_index'
     }
 
-    for (uint8_t s = 0; s < AUDIO_DAC_BUFFER_SIZE / 2; s++) {
-        if (OUTPUT_OFF <= state) {
-            sample_p[s] = AUDIO_DAC_OFF_VALUE;
-            continue;
+    if ((OUTPUT_RUN_NORMALLY == state) && (dac_value_generate == additive_value_generate)) {
+        // nothing to wait for, and no custom waveform: mix the whole half buffer in one go
+        if (active_tones_snapshot_length > 0) {
+            synth_render(oscillators, active_tones_snapshot_length, DAC_WAVETABLE, DAC_WAVETABLE_BITS, oscillators_gain, sample_p, AUDIO_DAC_BUFFER_SIZE / 2);
         } else {
-            sample_p[s] = dac_value_generate();
-        }
-
-        /* zero crossing (or approach, whereas zero == DAC_OFF_VALUE, which can be configured to anything from 0 to DAC_SAMPLE_MAX)
-         * ============================*=*========================== AUDIO_DAC_SAMPLE_MAX
-         *                          *       *
-         *                        *           *
-         * ---------------------------------------------------------
-         *                     *                 *                  } AUDIO_DAC_SAMPLE_MAX/100
-         * --------------------------------------------------------- AUDIO_DAC_OFF_VALUE
-         *                  *                       *               } AUDIO_DAC_SAMPLE_MAX/100
-         * ---------------------------------------------------------
-         *               *
-         * *           *
-         *   *       *
-         * =====*=*================================================= 0x0
-         */
-        if (((sample_p[s] + (AUDIO_DAC_SAMPLE_MAX / 100)) > AUDIO_DAC_OFF_VALUE) && // value approaches from below
-            (sample_p[s] < (AUDIO_DAC_OFF_VALUE + (AUDIO_DAC_SAMPLE_MAX / 100)))    // or above
-        ) {
-            if ((OUTPUT_SHOULD_START == state) && (active_tones_snapshot_length > 0)) {
-                state = OUTPUT_RUN_NORMALLY;
-            } else if (OUTPUT_TONES_CHANGED == state) {
-                state = OUTPUT_REACHED_ZERO_BEFORE_TONE_CHANGE;
-            } else if (OUTPUT_SHOULD_STOP == state) {
-                state = OUTPUT_REACHED_ZERO_BEFORE_OFF;
+            for (uint8_t s = 0; s < AUDIO_DAC_BUFFER_SIZE / 2; s++) {
+                sample_p[s] = AUDIO_DAC_OFF_VALUE;
             }
         }
+    } else {
+        bool snapshot_updated = false;
+
+        for (uint8_t s = 0; s < AUDIO_DAC_BUFFER_SIZE / 2; s++) {
+            if (OUTPUT_OFF <= state) {
+                sample_p[s] = AUDIO_DAC_OFF_VALUE;
+                continue;
+            } else {
+                sample_p[s] = dac_value_generate();
+            }
 
-        // still 'ramping up', reset the output to OFF_VALUE until the generated values reach that value, to do a smooth handover
-        if (OUTPUT_SHOULD_START == state) {
-            sample_p[s] = AUDIO_DAC_OFF_VALUE;
-        }
-
-        if ((OUTPUT_SHOULD_START == state) || (OUTPUT_REACHED_ZERO_BEFORE_OFF == state) || (OUTPUT_REACHED_ZERO_BEFORE_TONE_CHANGE == state)) {
-            uint8_t active_tones         = MIN(AUDIO_MAX_SIMULTANEOUS_TONES, audio_get_number_of_active_tones());
-            active_tones_snapshot_length = 0;
-            // update the snapshot - once, and only on occasion that something changed;
-            // -> saves cpu cycles (?)
-            for (uint8_t i = 0; i < active_tones; i++) {
-                float freq = audio_get_processed_frequency(i);
-                if (freq > 0) { // disregard 'rest' notes, with valid frequency 0.0f; which would only lower the resulting waveform volume during the additive synthesis step
-                    active_tones_snapshot[active_tones_snapshot_length++] = freq;
+            /* zero crossing (or approach, whereas zero == DAC_OFF_VALUE, which can be configured to anything from 0 to DAC_SAMPLE_MAX)
+             * ============================*=*========================== AUDIO_DAC_SAMPLE_MAX
+             *                          *       *
+             *                        *           *
+             * ---------------------------------------------------------
+             *                     *                 *                  } AUDIO_DAC_SAMPLE_MAX/100
+             * --------------------------------------------------------- AUDIO_DAC_OFF_VALUE
+             *                  *                       *               } AUDIO_DAC_SAMPLE_MAX/100
+             * ---------------------------------------------------------
+             *               *
+             * *           *
+             *   *       *
+             * =====*=*================================================= 0x0
+             */
+            if (((sample_p[s] + (AUDIO_DAC_SAMPLE_MAX / 100)) > AUDIO_DAC_OFF_VALUE) && // value approaches from below
+                (sample_p[s] < (AUDIO_DAC_OFF_VALUE + (AUDIO_DAC_SAMPLE_MAX / 100)))    // or above
+            ) {
+                if ((OUTPUT_SHOULD_START == state) && (active_tones_snapshot_length > 0)) {
+                    state = OUTPUT_RUN_NORMALLY;
+                } else if (OUTPUT_TONES_CHANGED == state) {
+                    state = OUTPUT_REACHED_ZERO_BEFORE_TONE_CHANGE;
+                } else if (OUTPUT_SHOULD_STOP == state) {
+                    state = OUTPUT_REACHED_ZERO_BEFORE_OFF;
                 }
             }
 
-            if ((0 == active_tones_snapshot_length) && (OUTPUT_REACHED_ZERO_BEFORE_OFF == state)) {
-                state = OUTPUT_OFF;
+            // still 'ramping up', reset the output to OFF_VALUE until the generated values reach that value, to do a smooth handover
+            if (OUTPUT_SHOULD_START == state) {
+                sample_p[s] = AUDIO_DAC_OFF_VALUE;
             }
-            if (OUTPUT_REACHED_ZERO_BEFORE_TONE_CHANGE == state) {
-                state = OUTPUT_RUN_NORMALLY;
+
+            if (!snapshot_updated && ((OUTPUT_SHOULD_START == state) || (OUTPUT_REACHED_ZERO_BEFORE_OFF == state) || (OUTPUT_REACHED_ZERO_BEFORE_TONE_CHANGE == state))) {
+                // update the snapshot - only on occasion that something changed; the tones change
+                // in 'audio_update_state' below, so once per half buffer is enough
+                update_active_tones_snapshot();
+                snapshot_updated = true;
+
+                if ((0 == active_tones_snapshot_length) && (OUTPUT_REACHED_ZERO_BEFORE_OFF == state)) {
+                    state = OUTPUT_OFF;
+                }
+                if (OUTPUT_REACHED_ZERO_BEFORE_TONE_CHANGE == state) {
+                    state = OUTPUT_RUN_NORMALLY;
+                }
             }
         }
     }
@@ -329,9 +344,9 @@ void audio_driver_start(void) {
     gptStartContinuous(&GPTD6, 2U);
 
     for (uint8_t i = 0; i < AUDIO_MAX_SIMULTANEOUS_TONES; i++) {
-        dac_if[i]                = 0.0f;
-        active_tones_snapshot[i] = 0.0f;
+        oscillators[i] = (synth_oscillator_t){0};
     }
     active_tones_snapshot_length = 0;
+    oscillators_gain             = 0;
     state                        = OUTPUT_SHOULD_START;
 }
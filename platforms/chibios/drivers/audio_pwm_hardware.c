@@ -68,21 +68,21 @@ static PWMConfig pwmCFG = {
         },
 };
 
-static float channel_1_frequency = 0.0f;
-void         channel_1_set_frequency(float freq) {
+static audio_freq_t channel_1_frequency = 0;
+void                channel_1_set_frequency(audio_freq_t freq) {
     channel_1_frequency = freq;
 
-    if (freq <= 0.0) // a pause/rest has freq=0
+    if (freq == 0) // a pause/rest has freq=0
         return;
 
-    pwmcnt_t period = (pwmCFG.frequency / freq);
+    pwmcnt_t period = ((uint32_t)pwmCFG.frequency << AUDIO_FREQ_SHIFT) / freq; // fits 32bit for a pwm clock below 16MHz
     pwmChangePeriod(&AUDIO_PWM_DRIVER, period);
     pwmEnableChannel(&AUDIO_PWM_DRIVER, AUDIO_PWM_CHANNEL - 1,
                      // adjust the duty-cycle so that the output is for 'note_timbre' duration HIGH
                      PWM_PERCENTAGE_TO_WIDTH(&AUDIO_PWM_DRIVER, (100 - note_timbre) * 100));
 }
 
-float channel_1_get_frequency(void) {
+audio_freq_t channel_1_get_frequency(void) {
     return channel_1_frequency;
 }
 
@@ -139,10 +139,10 @@ void audio_driver_stop(void) {
  * and updates the pwm to output that frequency
  */
 static void gpt_callback(GPTDriver *gptp) {
-    float freq; // TODO: freq_alt
+    audio_freq_t freq; // TODO: freq_alt
 
     if (audio_update_state()) {
-        freq = audio_get_processed_frequency(0); // freq_alt would be index=1
+        freq = audio_get_processed_frequency_fixed(0); // freq_alt would be index=1
         channel_1_set_frequency(freq);
     }
 }
@@ -88,8 +88,18 @@
 #    endif
 #endif
 
+#ifndef I2C_ASYNC_THREAD_STACK_SIZE
+#    define I2C_ASYNC_THREAD_STACK_SIZE 256
+#endif
+#ifndef I2C_ASYNC_THREAD_PRIORITY
+#    define I2C_ASYNC_THREAD_PRIORITY (NORMALPRIO + 1)
+#endif
+
 static uint8_t i2c_address;
 
+// Taken while a transfer is on the bus, so blocking transfers wait for a pending asynchronous one
+static BSEMAPHORE_DECL(i2c_bus_idle, false);
+
 static const I2CConfig i2cconfig = {
 #if defined(USE_I2CV1_CONTRIB)
     I2C1_CLOCK_SPEED,
@@ -140,26 +150,33 @@ __attribute__((weak)) void i2c_init(void) {
 }
 
 i2c_status_t i2c_start(uint8_t address) {
+    chBSemWait(&i2c_bus_idle);
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
+    chBSemSignal(&i2c_bus_idle);
     return I2C_STATUS_SUCCESS;
 }
 
 i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    chBSemWait(&i2c_bus_idle);
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, 0, 0, TIME_MS2I(timeout));
+    chBSemSignal(&i2c_bus_idle);
     return chibios_to_qmk(&status);
 }
 
 i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout) {
+    chBSemWait(&i2c_bus_idle);
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterReceiveTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, TIME_MS2I(timeout));
+    chBSemSignal(&i2c_bus_idle);
     return chibios_to_qmk(&status);
 }
 
 i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    chBSemWait(&i2c_bus_idle);
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
 
@@ -170,10 +187,12 @@ i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data,
     complete_packet[0] = regaddr;
 
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), complete_packet, length + 1, 0, 0, TIME_MS2I(timeout));
+    chBSemSignal(&i2c_bus_idle);
     return chibios_to_qmk(&status);
 }
 
 i2c_status_t i2c_writeReg16(uint8_t devaddr, uint16_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    chBSemWait(&i2c_bus_idle);
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
 
@@ -185,24 +204,133 @@ i2c_status_t i2c_writeReg16(uint8_t devaddr, uint16_t regaddr, const uint8_t* da
     complete_packet[1] = regaddr & 0xFF;
 
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), complete_packet, length + 2, 0, 0, TIME_MS2I(timeout));
+    chBSemSignal(&i2c_bus_idle);
     return chibios_to_qmk(&status);
 }
 
 i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
+    chBSemWait(&i2c_bus_idle);
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), &regaddr, 1, data, length, TIME_MS2I(timeout));
+    chBSemSignal(&i2c_bus_idle);
     return chibios_to_qmk(&status);
 }
 
 i2c_status_t i2c_readReg16(uint8_t devaddr, uint16_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
+    chBSemWait(&i2c_bus_idle);
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     uint8_t register_packet[2] = {regaddr >> 8, regaddr & 0xFF};
     msg_t   status             = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), register_packet, 2, data, length, TIME_MS2I(timeout));
+    chBSemSignal(&i2c_bus_idle);
     return chibios_to_qmk(&status);
 }
 
 void i2c_stop(void) {
+    chBSemWait(&i2c_bus_idle);
     i2cStop(&I2C_DRIVER);
+    chBSemSignal(&i2c_bus_idle);
+}
+
+/*
+ * The ChibiOS I2C driver only offers blocking transfers, so asynchronous ones
+ * are handed to a worker thread. It sleeps while the peripheral moves the data,
+ * which leaves the CPU to the caller until the completion callback runs.
+ * A queue is sent back to back, holding the bus until its last transaction.
+ */
+static struct {
+    const i2c_transaction_t* transactions;
+    uint8_t                  count;
+    uint16_t                 timeout;
+    i2c_async_callback_t     callback;
+} i2c_async_queue;
+
+// The single transaction of i2c_transmit_async()
+static i2c_transaction_t i2c_async_transfer;
+
+static BSEMAPHORE_DECL(i2c_async_request, true);
+static THD_WORKING_AREA(waI2cAsyncThread, I2C_ASYNC_THREAD_STACK_SIZE);
+static thread_t* i2c_async_thread = NULL;
+
+static THD_FUNCTION(I2cAsyncThread, arg) {
+    (void)arg;
+    chRegSetThreadName("i2c_async");
+
+    while (true) {
+        chBSemWait(&i2c_async_request);
+
+        // Stop at the first failure, the remaining writes may depend on it (e.g. a page select)
+        i2cStart(&I2C_DRIVER, &i2cconfig);
+        msg_t status = I2C_NO_ERROR;
+        for (uint8_t i = 0; i < i2c_async_queue.count && status == I2C_NO_ERROR; i++) {
+            const i2c_transaction_t* transaction = &i2c_async_queue.transactions[i];
+            status = i2cMasterTransmitTimeout(&I2C_DRIVER, (transaction->address >> 1), transaction->data, transaction->length, 0, 0, TIME_MS2I(i2c_async_queue.timeout));
+        }
+
+        // Release the bus first, so the callback can start the next transfer
+        i2c_async_callback_t callback = i2c_async_queue.callback;
+        chBSemSignal(&i2c_bus_idle);
+        if (callback) {
+            callback(chibios_to_qmk(&status));
+        }
+    }
+}
+
+// Hands a queue to the worker thread, with the bus already taken
+static void i2c_async_start(const i2c_transaction_t* transactions, uint8_t count, uint16_t timeout, i2c_async_callback_t callback) {
+    if (!i2c_async_thread) {
+        i2c_async_thread = chThdCreateStatic(waI2cAsyncThread, sizeof(waI2cAsyncThread), I2C_ASYNC_THREAD_PRIORITY, I2cAsyncThread, NULL);
+    }
+
+    i2c_async_queue.transactions = transactions;
+    i2c_async_queue.count        = count;
+    i2c_async_queue.timeout      = timeout;
+    i2c_async_queue.callback     = callback;
+    chBSemSignal(&i2c_async_request);
+}
+
+/**
+ * @brief Start a transmission in the background and return right away.
+ *
+ * The data has to stay valid until the callback has been called, which
+ * happens on the worker thread.
+ *
+ * @return I2C_STATUS_BUSY Another transfer is in progress, nothing was sent.
+ */
+i2c_status_t i2c_transmit_async(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback) {
+    if (chBSemWaitTimeout(&i2c_bus_idle, TIME_IMMEDIATE) != MSG_OK) {
+        return I2C_STATUS_BUSY;
+    }
+
+    i2c_async_transfer.address = address;
+    i2c_async_transfer.data    = data;
+    i2c_async_transfer.length  = length;
+    i2c_async_start(&i2c_async_transfer, 1, timeout, callback);
+    return I2C_STATUS_SUCCESS;
+}
+
+/**
+ * @brief Send a number of transactions in the background and return right away.
+ *
+ * The transactions are sent in order, without other transfers in between,
+ * and the callback is called once, after the last one or the first failure.
+ * The array and the data it points to have to stay valid until then.
+ *
+ * @return I2C_STATUS_BUSY Another transfer is in progress, nothing was sent.
+ */
+i2c_status_t i2c_transmit_queue_async(const i2c_transaction_t* transactions, uint8_t count, uint16_t timeout, i2c_async_callback_t callback) {
+    if (chBSemWaitTimeout(&i2c_bus_idle, TIME_IMMEDIATE) != MSG_OK) {
+        return I2C_STATUS_BUSY;
+    }
+
+    i2c_async_start(transactions, count, timeout, callback);
+    return I2C_STATUS_SUCCESS;
+}
+
+bool i2c_is_busy(void) {
+    chSysLock();
+    bool busy = chBSemGetStateI(&i2c_bus_idle);
+    chSysUnlock();
+    return busy;
 }
@@ -25,12 +25,26 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
 
 typedef int16_t i2c_status_t;
 
 #define I2C_STATUS_SUCCESS (0)
 #define I2C_STATUS_ERROR (-1)
 #define I2C_STATUS_TIMEOUT (-2)
+#define I2C_STATUS_BUSY (-3)
+
+// i2c_transmit_async() and i2c_transmit_queue_async() are available
+#define I2C_ASYNC_SUPPORTED
+
+typedef void (*i2c_async_callback_t)(i2c_status_t status);
+
+// One write of a queue, to any device on the bus
+typedef struct {
+    uint8_t        address;
+    const uint8_t* data;
+    uint16_t       length;
+} i2c_transaction_t;
 
 void         i2c_init(void);
 i2c_status_t i2c_start(uint8_t address);
@@ -41,3 +55,7 @@ i2c_status_t i2c_writeReg16(uint8_t devaddr, uint16_t regaddr, const uint8_t* da
 i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout);
 i2c_status_t i2c_readReg16(uint8_t devaddr, uint16_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout);
 void         i2c_stop(void);
+
+i2c_status_t i2c_transmit_async(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback);
+i2c_status_t i2c_transmit_queue_async(const i2c_transaction_t* transactions, uint8_t count, uint16_t timeout, i2c_async_callback_t callback);
+bool         i2c_is_busy(void);
@@ -16,6 +16,12 @@
 
 #include "serial_usart.h"
 
+#if defined(SERIAL_USART_LINK_TRAINING)
+#    include "serial_usart_link.h"
+
+_Static_assert(NUM_TOTAL_TRANSACTIONS <= USART_LINK_COMMAND_BASE, "Too many split transactions for USART link training");
+#endif
+
 #if defined(SERIAL_USART_CONFIG)
 static SerialConfig serial_config = SERIAL_USART_CONFIG;
 #else
@@ -96,68 +102,51 @@ static inline bool receive(uint8_t* destination, const size_t size) {
     return success;
 }
 
-#if !defined(SERIAL_USART_FULL_DUPLEX)
+#if defined(SERIAL_USART_LINK_TRAINING)
 
-/**
- * @brief Initiate pins for USART peripheral. Half-duplex configuration.
- */
-__attribute__((weak)) void usart_init(void) {
-#    if defined(MCU_STM32)
-#        if defined(USE_GPIOV1)
-    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_ALTERNATE_OPENDRAIN);
-#        else
-    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_TX_PAL_MODE) | PAL_OUTPUT_TYPE_OPENDRAIN);
-#        endif
-
-#        if defined(USART_REMAP)
-    USART_REMAP;
-#        endif
-#    else
-#        pragma message "usart_init: MCU Familiy not supported by default, please supply your own init code by implementing usart_init() in your keyboard files."
-#    endif
+bool usart_link_send(const uint8_t* source, size_t size) {
+    return send(source, size);
 }
 
-#else
+bool usart_link_receive(uint8_t* destination, size_t size) {
+    return receive(destination, size);
+}
 
 /**
- * @brief Initiate pins for USART peripheral. Full-duplex configuration.
+ * @brief Restart the USART peripheral with a new baud rate.
  */
-__attribute__((weak)) void usart_init(void) {
-#    if defined(MCU_STM32)
-#        if defined(USE_GPIOV1)
-    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_ALTERNATE_PUSHPULL);
-    palSetLineMode(SERIAL_USART_RX_PIN, PAL_MODE_INPUT);
-#        else
-    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_TX_PAL_MODE) | PAL_OUTPUT_TYPE_PUSHPULL | PAL_OUTPUT_SPEED_HIGHEST);
-    palSetLineMode(SERIAL_USART_RX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_RX_PAL_MODE) | PAL_OUTPUT_TYPE_PUSHPULL | PAL_OUTPUT_SPEED_HIGHEST);
-#        endif
-
-#        if defined(USART_REMAP)
-    USART_REMAP;
-#        endif
-#    else
-#        pragma message "usart_init: MCU Familiy not supported by default, please supply your own init code by implementing usart_init() in your keyboard files."
-#    endif
-}
+void usart_link_set_speed(uint32_t speed) {
+    if (serial_config.speed == speed) {
+        return;
+    }
 
-#endif
+    /* Let the last frame leave the transmitter before the baud rate changes. */
+    while (true) {
+        osalSysLock();
+        bool empty = oqIsEmptyI(&serial_driver->oqueue);
+        osalSysUnlock();
+        if (empty) {
+            break;
+        }
+        chThdSleepMicroseconds(100);
+    }
+    chThdSleepMilliseconds(1);
 
-/**
- * @brief Overridable master specific initializations.
- */
-__attribute__((weak, nonnull)) void usart_master_init(SerialDriver** driver) {
-    (void)driver;
-    usart_init();
+    sdStop(serial_driver);
+    serial_config.speed = speed;
+    sdStart(serial_driver, &serial_config);
 }
 
 /**
- * @brief Overridable slave specific initializations.
+ * @brief Wait for the other half to time out and drop anything that arrived meanwhile.
  */
-__attribute__((weak, nonnull)) void usart_slave_init(SerialDriver** driver) {
-    (void)driver;
-    usart_init();
+void usart_link_settle(uint16_t timeout_ms) {
+    chThdSleepMilliseconds(timeout_ms);
+    usart_clear();
 }
 
+#endif
+
 /**
  * @brief This thread runs on the slave and responds to transactions initiated
  * by the master.
@@ -168,7 +157,13 @@ static THD_FUNCTION(SlaveThread, arg) {
     chRegSetThreadName("usart_tx_rx");
 
     while (true) {
-        if (!react_to_transactions()) {
+        bool success = react_to_transactions();
+
+#if defined(SERIAL_USART_LINK_TRAINING)
+        usart_link_report(success);
+#endif
+
+        if (!success) {
             /* Clear the receive queue, to start with a clean slate.
              * Parts of failed transactions or spurious bytes could still be in it. */
             usart_clear();
@@ -182,6 +177,10 @@ static THD_FUNCTION(SlaveThread, arg) {
 void soft_serial_target_init(void) {
     usart_slave_init(&serial_driver);
 
+#if defined(SERIAL_USART_LINK_TRAINING)
+    usart_link_init(serial_config.speed, false);
+#endif
+
     sdStart(serial_driver, &serial_config);
 
     /* Start transport thread. */
@@ -192,8 +191,25 @@ void soft_serial_target_init(void) {
  * @brief React to transactions started by the master.
  */
 static inline bool react_to_transactions(void) {
+#if defined(SERIAL_USART_LINK_TRAINING)
+    /* Wait until there is a transaction for us, a trained link falls back to the base speed when it stays silent. */
+    uint16_t timeout = usart_link_receive_timeout();
+    msg_t    token   = sdGetTimeout(serial_driver, timeout ? TIME_MS2I(timeout) : TIME_INFINITE);
+
+    if (token == MSG_TIMEOUT) {
+        usart_link_idle();
+        return true;
+    }
+
+    if (usart_link_is_command((uint8_t)token)) {
+        return usart_link_react((uint8_t)token);
+    }
+
+    uint8_t sstd_index = (uint8_t)token;
+#else
     /* Wait until there is a transaction for us. */
     uint8_t sstd_index = (uint8_t)sdGet(serial_driver);
+#endif
 
     /* Sanity check that we are actually responding to a valid transaction. */
     if (sstd_index >= NUM_TOTAL_TRANSACTIONS) {
@@ -241,6 +257,10 @@ void soft_serial_initiator_init(void) {
     serial_config.cr2 |= USART_CR2_SWAP; // master has swapped TX/RX pins
 #endif
 
+#if defined(SERIAL_USART_LINK_TRAINING)
+    usart_link_init(serial_config.speed, true);
+#endif
+
     sdStart(serial_driver, &serial_config);
 }
 
@@ -251,10 +271,27 @@ void soft_serial_initiator_init(void) {
  * @return bool Indicates success of transaction.
  */
 bool soft_serial_transaction(int index) {
+#if defined(SERIAL_USART_LINK_TRAINING)
+    /* Negotiate the link speed on startup and after error bursts. */
+    if (usart_link_needs_training()) {
+        usart_clear();
+        if (!usart_link_train()) {
+            dprintln("USART: Link training failed.");
+            return false;
+        }
+    }
+#endif
+
     /* Clear the receive queue, to start with a clean slate.
      * Parts of failed transactions or spurious bytes could still be in it. */
     usart_clear();
-    return initiate_transaction((uint8_t)index);
+    bool success = initiate_transaction((uint8_t)index);
+
+#if defined(SERIAL_USART_LINK_TRAINING)
+    usart_link_report(success);
+#endif
+
+    return success;
 }
 
 /**
@@ -27,6 +27,10 @@
 #    define SERIAL_USART_DRIVER SD1
 #endif
 
+#if defined(SERIAL_DRIVER_USART_DUPLEX) && !defined(SERIAL_USART_FULL_DUPLEX)
+#    define SERIAL_USART_FULL_DUPLEX // the streaming transport always uses separate TX and RX lines
+#endif
+
 #if !defined(USE_GPIOV1)
 /* The default PAL alternate modes are used to signal that the pins are used for USART. */
 #    if !defined(SERIAL_USART_TX_PAL_MODE)
@@ -114,3 +118,7 @@
 #endif
 
 #define HANDSHAKE_MAGIC 7
+
+void usart_init(void);
+void usart_master_init(SerialDriver** driver);
+void usart_slave_init(SerialDriver** driver);
@@ -0,0 +1,491 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Full-duplex streaming split transport.
+ *
+ * Unlike serial_usart.c, which serialises handshake, initiator2target and
+ * target2initiator transfers on a single wire, both halves run an independent
+ * stream of frames over their own TX line:
+ *
+ *   [ sync | id | seq | ack | payload ... | crc8 ]
+ *
+ * The payload length is implied by the transaction id and the direction. Every
+ * frame acknowledges the last frame received from the other half.
+ *
+ * The slave only accepts the master's frames in order, so its acknowledgement
+ * covers every frame up to that sequence number. A frame after a gap is
+ * dropped, and once the acknowledgement stops moving the master goes back to
+ * it and resends the writes the slave has missed. At most
+ * SERIAL_USART_STREAM_WINDOW frames are unacknowledged at any time, which
+ * keeps old acknowledgements from matching new frames when the 8 bit sequence
+ * number wraps.
+ *
+ * The master sends initiator2target buffers without waiting for an answer.
+ * The slave pushes its target2initiator buffers whenever they change, so most
+ * reads on the master are served from the last streamed copy. A read only
+ * costs a round trip when the slave has not yet streamed the buffer after
+ * seeing the master's latest frame, or when the transaction needs a slave
+ * callback.
+ */
+
+#include <string.h>
+
+#include "serial_usart.h"
+#include "crc.h"
+
+#if !defined(SERIAL_USART_STREAM_INTERVAL)
+#    define SERIAL_USART_STREAM_INTERVAL 1 // ms between checks for changed buffers on the slave
+#endif
+
+#if !defined(SERIAL_USART_STREAM_KEEPALIVE)
+#    define SERIAL_USART_STREAM_KEEPALIVE (SERIAL_USART_TIMEOUT / 4) // ms of silence before the slave sends a bare ack
+#endif
+
+#if !defined(SERIAL_USART_STREAM_REFRESH)
+#    define SERIAL_USART_STREAM_REFRESH 50 // ms between unconditional re-sends of all streamed buffers
+#endif
+
+#if !defined(SERIAL_USART_STREAM_WINDOW)
+#    define SERIAL_USART_STREAM_WINDOW 32 // frames the master may send ahead of the slave's acknowledgement
+#endif
+
+_Static_assert(SERIAL_USART_STREAM_WINDOW > 0 && SERIAL_USART_STREAM_WINDOW < 128, "SERIAL_USART_STREAM_WINDOW has to stay below half the sequence space");
+
+#define STREAM_SYNC 0xA5
+#define STREAM_ACK_ID 0xFF
+
+_Static_assert(NUM_TOTAL_TRANSACTIONS < STREAM_ACK_ID, "Too many split transactions for the duplex stream");
+
+typedef struct __attribute__((packed)) {
+    uint8_t sync;
+    uint8_t id;
+    uint8_t seq;
+    uint8_t ack;
+} stream_header_t;
+
+#define STREAM_FRAME_SIZE(payload) (sizeof(stream_header_t) + (payload) + 1)
+
+#if defined(SERIAL_USART_CONFIG)
+static SerialConfig serial_config = SERIAL_USART_CONFIG;
+#else
+static SerialConfig serial_config = {
+    .speed = (SERIAL_USART_SPEED), /* speed - mandatory */
+    .cr1   = (SERIAL_USART_CR1),
+    .cr2   = (SERIAL_USART_CR2),
+    .cr3   = (SERIAL_USART_CR3)
+};
+#endif
+
+static SerialDriver* serial_driver = &SERIAL_USART_DRIVER;
+
+static MUTEX_DECL(tx_mutex);
+static BSEMAPHORE_DECL(rx_event, true);
+
+static bool              is_master;
+static uint8_t           tx_seq;
+static volatile uint8_t  rx_seq;
+static volatile systime_t last_rx;
+static volatile bool     rx_seen;
+
+/* Master: ack carried by the last frame received for each transaction. */
+static uint8_t rx_ack[NUM_TOTAL_TRANSACTIONS];
+static bool    rx_valid[NUM_TOTAL_TRANSACTIONS];
+
+/* Master: last frame the slave has processed, and the writes it has not confirmed yet. */
+static volatile uint8_t tx_acked;
+static bool             tx_pending[NUM_TOTAL_TRANSACTIONS];
+static uint8_t          tx_pending_seq[NUM_TOTAL_TRANSACTIONS];
+
+static inline uint8_t tx_size(const split_transaction_desc_t* trans) {
+    return is_master ? trans->initiator2target_buffer_size : trans->target2initiator_buffer_size;
+}
+
+static inline uint8_t* tx_buffer(const split_transaction_desc_t* trans) {
+    return is_master ? split_trans_initiator2target_buffer(trans) : split_trans_target2initiator_buffer(trans);
+}
+
+static inline uint8_t rx_size(const split_transaction_desc_t* trans) {
+    return is_master ? trans->target2initiator_buffer_size : trans->initiator2target_buffer_size;
+}
+
+static inline uint8_t* rx_buffer(const split_transaction_desc_t* trans) {
+    return is_master ? split_trans_target2initiator_buffer(trans) : split_trans_initiator2target_buffer(trans);
+}
+
+/**
+ * @brief Buffers the slave pushes on its own, without being asked for.
+ */
+static inline bool is_streamed(const split_transaction_desc_t* trans) {
+    return trans->target2initiator_buffer_size && !trans->initiator2target_buffer_size && !trans->slave_callback;
+}
+
+static inline bool link_alive(void) {
+    return rx_seen && chVTTimeElapsedSinceX(last_rx) < TIME_MS2I(SERIAL_USART_TIMEOUT);
+}
+
+/**
+ * @brief Check whether an acknowledgement covers the frame with the given
+ * sequence number. Both have to be within the window for this to hold.
+ */
+static inline bool is_acked(uint8_t ack, uint8_t seq) {
+    return (uint8_t)(ack - seq) < SERIAL_USART_STREAM_WINDOW;
+}
+
+/**
+ * @brief Blocking receive of size * bytes with timeout.
+ */
+static inline bool receive(uint8_t* destination, const size_t size) {
+    return (size_t)sdReadTimeout(serial_driver, destination, size, TIME_MS2I(SERIAL_USART_TIMEOUT)) == size;
+}
+
+/**
+ * @brief Snapshot a buffer into a frame and queue it for sending.
+ *
+ * @param seq Receives the sequence number of the frame, may be NULL.
+ * @return true Frame was handed to the serial driver.
+ */
+static bool send_frame(uint8_t id, const uint8_t* payload, uint8_t size, uint8_t* seq) {
+    uint8_t          frame[STREAM_FRAME_SIZE(UINT8_MAX)];
+    stream_header_t* header = (stream_header_t*)frame;
+
+    chMtxLock(&tx_mutex);
+
+    header->sync = STREAM_SYNC;
+    header->id   = id;
+    header->seq  = ++tx_seq;
+    /* Read the ack before the payload, so a frame never claims more than its data reflects. */
+    header->ack = rx_seq;
+
+    osalSysLock();
+    memcpy(&frame[sizeof(stream_header_t)], payload, size);
+    if (is_master) {
+        /* Acks left over from before the sequence number wrapped would match this frame. */
+        for (uint8_t i = 0; i < NUM_TOTAL_TRANSACTIONS; i++) {
+            if (rx_ack[i] == header->seq) {
+                rx_valid[i] = false;
+            }
+        }
+    }
+    osalSysUnlock();
+
+    frame[sizeof(stream_header_t) + size] = crc8(&frame[1], sizeof(stream_header_t) - 1 + size);
+
+    bool success = (size_t)sdWriteTimeout(serial_driver, frame, STREAM_FRAME_SIZE(size), TIME_MS2I(SERIAL_USART_TIMEOUT)) == STREAM_FRAME_SIZE(size);
+    if (seq) {
+        *seq = header->seq;
+    }
+
+    chMtxUnlock(&tx_mutex);
+    return success;
+}
+
+/**
+ * @brief Receive and dispatch a single frame from the other half.
+ *
+ * @return true A valid frame was received.
+ */
+static bool receive_frame(void) {
+    uint8_t          frame[STREAM_FRAME_SIZE(UINT8_MAX)];
+    stream_header_t* header = (stream_header_t*)frame;
+    uint8_t          size   = 0;
+
+    /* Hunt for the start of the next frame. */
+    if ((uint8_t)sdGet(serial_driver) != STREAM_SYNC) {
+        return false;
+    }
+    header->sync = STREAM_SYNC;
+
+    if (!receive(&frame[1], sizeof(stream_header_t) - 1)) {
+        return false;
+    }
+
+    if (header->id != STREAM_ACK_ID) {
+        if (header->id >= NUM_TOTAL_TRANSACTIONS) {
+            return false;
+        }
+        size = rx_size(&split_transaction_table[header->id]);
+    }
+
+    if (!receive(&frame[sizeof(stream_header_t)], size + 1) || frame[sizeof(stream_header_t) + size] != crc8(&frame[1], sizeof(stream_header_t) - 1 + size)) {
+        return false;
+    }
+
+    /* Acks are cumulative, anything after a lost frame waits for the master to resend. */
+    if (!is_master && rx_seen && header->seq != (uint8_t)(rx_seq + 1)) {
+        return false;
+    }
+
+    last_rx = chVTGetSystemTimeX();
+    rx_seen = true;
+
+    if (is_master) {
+        tx_acked = header->ack;
+    }
+
+    if (header->id == STREAM_ACK_ID) {
+        rx_seq = header->seq;
+        return true;
+    }
+
+    split_transaction_desc_t* trans = &split_transaction_table[header->id];
+
+    osalSysLock();
+    memcpy(rx_buffer(trans), &frame[sizeof(stream_header_t)], size);
+    if (is_master) {
+        rx_ack[header->id]   = header->ack;
+        rx_valid[header->id] = true;
+        chBSemSignalI(&rx_event);
+    }
+    osalSysUnlock();
+
+    if (is_master) {
+        rx_seq = header->seq;
+        return true;
+    }
+
+    /* Allow any slave processing to occur. */
+    if (trans->slave_callback) {
+        trans->slave_callback(trans->initiator2target_buffer_size, split_trans_initiator2target_buffer(trans), trans->target2initiator_buffer_size, split_trans_target2initiator_buffer(trans));
+    }
+
+    /* Only acknowledge the frame once its side effects are visible. */
+    rx_seq = header->seq;
+
+    /* Answer requests for target2initiator buffers right away. */
+    if (trans->target2initiator_buffer_size) {
+        return send_frame(header->id, split_trans_target2initiator_buffer(trans), trans->target2initiator_buffer_size, NULL);
+    }
+
+    return true;
+}
+
+/**
+ * @brief This thread runs on both halves and consumes the incoming stream.
+ */
+static THD_WORKING_AREA(waReceiveThread, 1024);
+static THD_FUNCTION(ReceiveThread, arg) {
+    (void)arg;
+    chRegSetThreadName("usart_rx");
+
+    while (true) {
+        receive_frame();
+    }
+}
+
+/**
+ * @brief This thread runs on the slave and pushes changed target2initiator
+ * buffers to the master.
+ */
+static THD_WORKING_AREA(waStreamThread, 1024);
+static THD_FUNCTION(StreamThread, arg) {
+    (void)arg;
+    chRegSetThreadName("usart_stream");
+
+    static uint8_t checksums[NUM_TOTAL_TRANSACTIONS];
+    uint8_t        streamed_seq = rx_seq;
+    systime_t      last_tx      = chVTGetSystemTimeX();
+    systime_t      last_refresh = last_tx;
+
+    while (true) {
+        chThdSleepMilliseconds(SERIAL_USART_STREAM_INTERVAL);
+
+        /* Everything is re-sent once the master's latest frame has been processed,
+         * so the master can trust its copies again without asking. */
+        bool resend = streamed_seq != rx_seq || chVTTimeElapsedSinceX(last_refresh) >= TIME_MS2I(SERIAL_USART_STREAM_REFRESH);
+        streamed_seq = rx_seq;
+        if (resend) {
+            last_refresh = chVTGetSystemTimeX();
+        }
+
+        for (uint8_t id = 0; id < NUM_TOTAL_TRANSACTIONS; id++) {
+            split_transaction_desc_t* trans = &split_transaction_table[id];
+            if (!is_streamed(trans)) {
+                continue;
+            }
+
+            uint8_t checksum = crc8(split_trans_target2initiator_buffer(trans), trans->target2initiator_buffer_size);
+            if (resend || checksum != checksums[id]) {
+                if (send_frame(id, split_trans_target2initiator_buffer(trans), trans->target2initiator_buffer_size, NULL)) {
+                    checksums[id] = checksum;
+                    last_tx       = chVTGetSystemTimeX();
+                }
+            }
+        }
+
+        if (chVTTimeElapsedSinceX(last_tx) >= TIME_MS2I(SERIAL_USART_STREAM_KEEPALIVE)) {
+            if (send_frame(STREAM_ACK_ID, NULL, 0, NULL)) {
+                last_tx = chVTGetSystemTimeX();
+            }
+        }
+    }
+}
+
+/**
+ * @brief Slave specific initializations.
+ */
+void soft_serial_target_init(void) {
+    is_master = false;
+
+    usart_slave_init(&serial_driver);
+
+    sdStart(serial_driver, &serial_config);
+
+    /* Start transport threads. */
+    chThdCreateStatic(waReceiveThread, sizeof(waReceiveThread), HIGHPRIO, ReceiveThread, NULL);
+    chThdCreateStatic(waStreamThread, sizeof(waStreamThread), NORMALPRIO + 1, StreamThread, NULL);
+}
+
+/**
+ * @brief Master specific initializations.
+ */
+void soft_serial_initiator_init(void) {
+    is_master = true;
+
+    usart_master_init(&serial_driver);
+
+#if defined(MCU_STM32) && defined(SERIAL_USART_PIN_SWAP)
+    serial_config.cr2 |= USART_CR2_SWAP; // master has swapped TX/RX pins
+#endif
+
+    sdStart(serial_driver, &serial_config);
+
+    chThdCreateStatic(waReceiveThread, sizeof(waReceiveThread), HIGHPRIO, ReceiveThread, NULL);
+}
+
+/**
+ * @brief Wait for the slave to answer the frame with the given sequence number.
+ */
+static bool wait_for_answer(uint8_t id, uint8_t seq) {
+    systime_t start = chVTGetSystemTimeX();
+
+    while (true) {
+        osalSysLock();
+        bool answered = rx_valid[id] && is_acked(rx_ack[id], seq);
+        osalSysUnlock();
+
+        if (answered) {
+            return true;
+        }
+
+        sysinterval_t elapsed = chVTTimeElapsedSinceX(start);
+        if (elapsed >= TIME_MS2I(SERIAL_USART_TIMEOUT) || chBSemWaitTimeout(&rx_event, TIME_MS2I(SERIAL_USART_TIMEOUT) - elapsed) == MSG_TIMEOUT) {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief Resend the writes the slave has not acknowledged within SERIAL_USART_TIMEOUT.
+ */
+static void resend_unacked(void) {
+    static uint8_t   last_acked;
+    static systime_t last_progress;
+
+    uint8_t acked = tx_acked;
+    if (acked != last_acked || acked == tx_seq) {
+        last_acked    = acked;
+        last_progress = chVTGetSystemTimeX();
+    }
+
+    for (uint8_t id = 0; id < NUM_TOTAL_TRANSACTIONS; id++) {
+        if (tx_pending[id] && (uint8_t)(tx_seq - tx_pending_seq[id]) >= (uint8_t)(tx_seq - acked)) {
+            tx_pending[id] = false;
+        }
+    }
+
+    if (acked == tx_seq || chVTTimeElapsedSinceX(last_progress) < TIME_MS2I(SERIAL_USART_TIMEOUT)) {
+        return;
+    }
+
+    /* The slave drops everything after a lost frame, continue right after its last ack. */
+    dprintln("USART: Resending unacknowledged writes.");
+    tx_seq        = acked;
+    last_progress = chVTGetSystemTimeX();
+    for (uint8_t id = 0; id < NUM_TOTAL_TRANSACTIONS; id++) {
+        if (tx_pending[id]) {
+            split_transaction_desc_t* trans = &split_transaction_table[id];
+            send_frame(id, tx_buffer(trans), tx_size(trans), &tx_pending_seq[id]);
+        }
+    }
+}
+
+/**
+ * @brief Start transaction from the master half to the slave half.
+ *
+ * @param index Transaction Table index of the transaction to start.
+ * @return bool Indicates success of transaction.
+ */
+bool soft_serial_transaction(int index) {
+    /* Sanity check that we are actually starting a valid transaction. */
+    if (index < 0 || index >= NUM_TOTAL_TRANSACTIONS) {
+        dprintln("USART: Illegal transaction Id.");
+        return false;
+    }
+
+    split_transaction_desc_t* trans = &split_transaction_table[index];
+
+    resend_unacked();
+
+    /* Writes are not waited for, they are resent until the slave acknowledges them. */
+    if (!trans->target2initiator_buffer_size) {
+        if ((uint8_t)(tx_seq - tx_acked) >= SERIAL_USART_STREAM_WINDOW) {
+            dprintln("USART: Too many unacknowledged frames.");
+            return false;
+        }
+        if (!send_frame(index, tx_buffer(trans), tx_size(trans), &tx_pending_seq[index])) {
+            dprintln("USART: Send failed.");
+            return false;
+        }
+        tx_pending[index] = true;
+        return link_alive();
+    }
+
+    /* Streamed copies are good as long as the slave had seen everything we sent. */
+    if (is_streamed(trans)) {
+        osalSysLock();
+        bool fresh = rx_valid[index] && rx_ack[index] == tx_seq;
+        osalSysUnlock();
+
+        if (fresh && link_alive()) {
+            return true;
+        }
+    }
+
+    if ((uint8_t)(tx_seq - tx_acked) >= SERIAL_USART_STREAM_WINDOW) {
+        dprintln("USART: Too many unacknowledged frames.");
+        return false;
+    }
+
+    /* Only an answer sent after this request counts. */
+    osalSysLock();
+    rx_valid[index] = false;
+    osalSysUnlock();
+
+    uint8_t seq;
+    chBSemReset(&rx_event, true);
+    if (!send_frame(index, tx_buffer(trans), tx_size(trans), &seq)) {
+        dprintln("USART: Send failed.");
+        return false;
+    }
+
+    if (!wait_for_answer(index, seq)) {
+        dprintln("USART: Receive failed.");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,311 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Link training for the USART split transport.
+ *
+ * Both halves boot at the configured base speed. The master proposes a faster
+ * speed, both halves switch over and the master sends a number of probe
+ * frames, which the slave echoes back with an inverted payload. Only when all
+ * probes pass the master commits the speed, otherwise both halves fall back to
+ * the base speed and the next slower candidate is tried. A burst of failed
+ * transactions on a trained link starts the whole process again.
+ *
+ * This file contains no ChibiOS specific code, the actual transfers are done
+ * through the usart_link_* primitives so the negotiation can be exercised on
+ * the host against a simulated link.
+ */
+
+#include <string.h>
+
+#include "serial_usart_link.h"
+#include "crc.h"
+
+#define LINK_SPEED_COUNT (sizeof(link_speeds) / sizeof(link_speeds[0]))
+
+static const uint32_t link_speeds[] = SERIAL_USART_LINK_SPEEDS;
+
+static uint32_t           base_speed;
+static bool               is_master;
+static uint8_t            speed_index    = USART_LINK_BASE_SPEED_INDEX;
+static bool               training       = false;
+static bool               needs_training = true;
+static bool               needs_settle   = false;
+static uint8_t            error_count    = 0;
+static usart_link_stats_t link_stats;
+
+static inline uint32_t speed_of(uint8_t index) {
+    return index == USART_LINK_BASE_SPEED_INDEX ? base_speed : link_speeds[index];
+}
+
+static inline void frame_seal(usart_link_frame_t *frame) {
+    frame->checksum = crc8(frame, sizeof(usart_link_frame_t) - 1);
+}
+
+static inline bool frame_valid(const usart_link_frame_t *frame) {
+    return frame->checksum == crc8(frame, sizeof(usart_link_frame_t) - 1);
+}
+
+/**
+ * @brief Fill a probe payload with a bit pattern that exercises long runs of
+ * equal bits as well as fast toggling lines.
+ */
+static void probe_pattern(uint8_t sequence, uint8_t *payload) {
+    static const uint8_t pattern[USART_LINK_PAYLOAD_SIZE - 2] = {0x55, 0xAA, 0x00, 0xFF, 0x0F, 0xF0};
+    memcpy(payload, pattern, sizeof(pattern));
+    payload[USART_LINK_PAYLOAD_SIZE - 2] = sequence;
+    payload[USART_LINK_PAYLOAD_SIZE - 1] = ~sequence;
+}
+
+static void revert_to_base_speed(void) {
+    training    = false;
+    speed_index = USART_LINK_BASE_SPEED_INDEX;
+    usart_link_set_speed(base_speed);
+}
+
+/**
+ * @brief Initialize the link state, both halves start out at the base speed.
+ */
+void usart_link_init(uint32_t speed, bool master) {
+    base_speed     = speed;
+    is_master      = master;
+    training       = false;
+    needs_training = true;
+    needs_settle   = false;
+    error_count    = 0;
+    speed_index    = USART_LINK_BASE_SPEED_INDEX;
+    memset(&link_stats, 0, sizeof(link_stats));
+}
+
+uint32_t usart_link_speed(void) {
+    return speed_of(speed_index);
+}
+
+void usart_link_get_stats(usart_link_stats_t *stats) {
+    *stats       = link_stats;
+    stats->speed = usart_link_speed();
+}
+
+/**
+ * @brief Account the outcome of a transaction. A burst of consecutive errors
+ * makes the master re-train and the slave fall back to the base speed.
+ */
+void usart_link_report(bool success) {
+    if (success) {
+        error_count = 0;
+        return;
+    }
+
+    link_stats.transaction_errors++;
+
+    /* Anything but a training frame aborts the training on the slave. */
+    if (!is_master && training) {
+        revert_to_base_speed();
+        return;
+    }
+
+    if (++error_count < SERIAL_USART_LINK_ERROR_BURST) {
+        return;
+    }
+    error_count = 0;
+
+    if (is_master) {
+        needs_training = true;
+        /* The slave has to notice the broken link before it listens at the base speed again. */
+        needs_settle = speed_index != USART_LINK_BASE_SPEED_INDEX;
+    } else if (speed_index != USART_LINK_BASE_SPEED_INDEX) {
+        revert_to_base_speed();
+    }
+}
+
+bool usart_link_needs_training(void) {
+    return needs_training;
+}
+
+/**
+ * @brief Send a training frame to the slave and validate its answer.
+ *
+ * @return true The slave echoed the frame correctly.
+ * @return false Transfer failed or the echo was corrupted.
+ */
+static bool exchange(uint8_t command, uint8_t argument, const uint8_t *payload) {
+    usart_link_frame_t request = {.command = command, .argument = argument};
+    usart_link_frame_t reply;
+
+    if (payload) {
+        memcpy(request.payload, payload, USART_LINK_PAYLOAD_SIZE);
+    }
+    frame_seal(&request);
+
+    if (!usart_link_send((const uint8_t *)&request, sizeof(request)) || !usart_link_receive((uint8_t *)&reply, sizeof(reply))) {
+        return false;
+    }
+
+    if (!frame_valid(&reply) || reply.command != (command | USART_LINK_REPLY) || reply.argument != argument) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < USART_LINK_PAYLOAD_SIZE; i++) {
+        if (reply.payload[i] != (uint8_t)~request.payload[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Try to run the link at the given candidate speed.
+ */
+static bool try_speed(uint8_t index) {
+    uint8_t payload[USART_LINK_PAYLOAD_SIZE];
+
+    if (!exchange(USART_LINK_PROPOSE, index, NULL)) {
+        /* Only the answer might have been lost, let the slave time out. */
+        usart_link_settle(SERIAL_USART_LINK_TRAINING_TIMEOUT);
+        return false;
+    }
+
+    usart_link_set_speed(speed_of(index));
+    /* Give the slave time to restart its peripheral. */
+    usart_link_settle(1);
+
+    for (uint8_t sequence = 0; sequence < SERIAL_USART_LINK_PROBES; sequence++) {
+        probe_pattern(sequence, payload);
+        if (!exchange(USART_LINK_PROBE, sequence, payload)) {
+            usart_link_set_speed(base_speed);
+            usart_link_settle(SERIAL_USART_LINK_TRAINING_TIMEOUT);
+            return false;
+        }
+    }
+
+    if (!exchange(USART_LINK_COMMIT, index, NULL)) {
+        /* The slave might have committed and only the answer got lost. */
+        usart_link_set_speed(base_speed);
+        usart_link_settle(SERIAL_USART_LINK_IDLE_TIMEOUT);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Negotiate the fastest reliable speed with the slave.
+ *
+ * @return true The link is usable, possibly only at the base speed.
+ * @return false The slave did not answer at all.
+ */
+bool usart_link_train(void) {
+    if (speed_index != USART_LINK_BASE_SPEED_INDEX) {
+        revert_to_base_speed();
+    }
+
+    if (needs_settle) {
+        usart_link_settle(SERIAL_USART_LINK_IDLE_TIMEOUT);
+        needs_settle = false;
+    }
+
+    link_stats.trainings++;
+
+    /* Make sure the slave is listening at the base speed before negotiating. */
+    if (!exchange(USART_LINK_PROPOSE, USART_LINK_BASE_SPEED_INDEX, NULL)) {
+        return false;
+    }
+
+    for (uint8_t index = 0; index < LINK_SPEED_COUNT; index++) {
+        if (link_speeds[index] <= base_speed) {
+            continue;
+        }
+        if (try_speed(index)) {
+            speed_index = index;
+            break;
+        }
+    }
+
+    needs_training = false;
+    error_count    = 0;
+    return true;
+}
+
+/**
+ * @brief Handle a training frame on the slave, the command byte has already
+ * been consumed by the caller.
+ */
+bool usart_link_react(uint8_t command) {
+    usart_link_frame_t request = {.command = command};
+    usart_link_frame_t reply;
+
+    if (!usart_link_receive(&request.argument, sizeof(request) - 1) || !frame_valid(&request)) {
+        if (training) {
+            revert_to_base_speed();
+        }
+        return false;
+    }
+
+    reply.command  = command | USART_LINK_REPLY;
+    reply.argument = request.argument;
+    for (uint8_t i = 0; i < USART_LINK_PAYLOAD_SIZE; i++) {
+        reply.payload[i] = ~request.payload[i];
+    }
+    frame_seal(&reply);
+
+    switch (command) {
+        case USART_LINK_PROPOSE:
+            if (request.argument != USART_LINK_BASE_SPEED_INDEX && request.argument >= LINK_SPEED_COUNT) {
+                return false;
+            }
+            /* The answer still goes out at the old speed. */
+            if (!usart_link_send((const uint8_t *)&reply, sizeof(reply))) {
+                return false;
+            }
+            speed_index = request.argument;
+            training    = speed_index != USART_LINK_BASE_SPEED_INDEX;
+            usart_link_set_speed(speed_of(speed_index));
+            return true;
+        case USART_LINK_PROBE:
+            if (!training) {
+                return false;
+            }
+            return usart_link_send((const uint8_t *)&reply, sizeof(reply));
+        case USART_LINK_COMMIT:
+            if (!training || request.argument != speed_index) {
+                return false;
+            }
+            training = false;
+            return usart_link_send((const uint8_t *)&reply, sizeof(reply));
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Called on the slave when nothing arrived within usart_link_receive_timeout().
+ */
+void usart_link_idle(void) {
+    if (speed_index != USART_LINK_BASE_SPEED_INDEX) {
+        revert_to_base_speed();
+    }
+}
+
+/**
+ * @brief Receive timeout for the slave in ms, 0 means wait forever.
+ */
+uint16_t usart_link_receive_timeout(void) {
+    if (training) {
+        return SERIAL_USART_LINK_TRAINING_TIMEOUT;
+    }
+    return speed_index != USART_LINK_BASE_SPEED_INDEX ? SERIAL_USART_LINK_IDLE_TIMEOUT : 0;
+}
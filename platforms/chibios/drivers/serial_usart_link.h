@@ -0,0 +1,99 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Candidate speeds tried during link training, fastest first. Only speeds
+ * above the configured base speed (SERIAL_USART_SPEED) are negotiated, the
+ * base speed is always the fallback. */
+#if !defined(SERIAL_USART_LINK_SPEEDS)
+#    define SERIAL_USART_LINK_SPEEDS \
+        { 1843200, 1500000, 1000000, 921600, 460800, 230400, 115200 }
+#endif
+
+/* Number of echoed probe frames that have to pass before a speed is accepted. */
+#if !defined(SERIAL_USART_LINK_PROBES)
+#    define SERIAL_USART_LINK_PROBES 16
+#endif
+
+/* Consecutive failed transactions that trigger a re-training of the link. */
+#if !defined(SERIAL_USART_LINK_ERROR_BURST)
+#    define SERIAL_USART_LINK_ERROR_BURST 4
+#endif
+
+/* Time in ms the slave waits for the next training frame before reverting to the base speed. */
+#if !defined(SERIAL_USART_LINK_TRAINING_TIMEOUT)
+#    define SERIAL_USART_LINK_TRAINING_TIMEOUT 40
+#endif
+
+/* Time in ms without any traffic after which the slave reverts a trained link to the base speed. */
+#if !defined(SERIAL_USART_LINK_IDLE_TIMEOUT)
+#    define SERIAL_USART_LINK_IDLE_TIMEOUT 500
+#endif
+
+#define USART_LINK_PAYLOAD_SIZE 8
+
+/* Training commands share the first byte with the transaction index, so they
+ * have to stay clear of any valid transaction id. */
+enum usart_link_command {
+    USART_LINK_COMMAND_BASE = 0xF0,
+    USART_LINK_PROPOSE      = USART_LINK_COMMAND_BASE,
+    USART_LINK_PROBE,
+    USART_LINK_COMMIT,
+};
+
+#define USART_LINK_REPLY 0x08
+#define USART_LINK_BASE_SPEED_INDEX 0xFF
+
+typedef struct __attribute__((packed)) {
+    uint8_t command;
+    uint8_t argument;
+    uint8_t payload[USART_LINK_PAYLOAD_SIZE];
+    uint8_t checksum;
+} usart_link_frame_t;
+
+typedef struct {
+    uint32_t speed;
+    uint16_t trainings;
+    uint16_t transaction_errors;
+} usart_link_stats_t;
+
+/* Low level primitives, implemented by the serial driver (or a host mock). */
+bool usart_link_send(const uint8_t *source, size_t size);
+bool usart_link_receive(uint8_t *destination, size_t size);
+void usart_link_set_speed(uint32_t speed);
+void usart_link_settle(uint16_t timeout_ms);
+
+void     usart_link_init(uint32_t base_speed, bool master);
+uint32_t usart_link_speed(void);
+void     usart_link_get_stats(usart_link_stats_t *stats);
+
+/* Master side */
+bool usart_link_needs_training(void);
+bool usart_link_train(void);
+void usart_link_report(bool success);
+
+/* Slave side */
+static inline bool usart_link_is_command(uint8_t token) {
+    return token >= USART_LINK_COMMAND_BASE && token < USART_LINK_COMMAND_BASE + USART_LINK_REPLY;
+}
+bool     usart_link_react(uint8_t command);
+void     usart_link_idle(void);
+uint16_t usart_link_receive_timeout(void);
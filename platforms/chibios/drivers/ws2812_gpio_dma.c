@@ -0,0 +1,237 @@
+#include "ws2812.h"
+#include "quantum.h"
+#include <hal.h>
+
+/*
+ * Timer driven DMA to the GPIO set/reset register, so any pin can be used.
+ *
+ * Every bit period the timer raises three DMA requests:
+ *   - update: the pin goes high
+ *   - CC1 at T0H: the pin goes low if the bit is a zero, from the frame buffer
+ *   - CC2 at T1H: the pin goes low
+ * The frame buffer only holds the CC1 writes, the other two streams repeat a constant.
+ */
+
+#ifdef RGBW
+#    define WS2812_CHANNELS 4
+#else
+#    define WS2812_CHANNELS 3
+#endif
+
+#ifndef WS2812_GPIO_DMA_TIMER
+#    define WS2812_GPIO_DMA_TIMER PWMD1 // TIMx
+#endif
+#ifndef WS2812_GPIO_DMA_UP_STREAM
+#    define WS2812_GPIO_DMA_UP_STREAM STM32_DMA2_STREAM5 // DMA Stream for TIMx_UP
+#endif
+#ifndef WS2812_GPIO_DMA_UP_CHANNEL
+#    define WS2812_GPIO_DMA_UP_CHANNEL 6 // DMA Channel for TIMx_UP
+#endif
+#ifndef WS2812_GPIO_DMA_CH1_STREAM
+#    define WS2812_GPIO_DMA_CH1_STREAM STM32_DMA2_STREAM1 // DMA Stream for TIMx_CH1
+#endif
+#ifndef WS2812_GPIO_DMA_CH1_CHANNEL
+#    define WS2812_GPIO_DMA_CH1_CHANNEL 6 // DMA Channel for TIMx_CH1
+#endif
+#ifndef WS2812_GPIO_DMA_CH2_STREAM
+#    define WS2812_GPIO_DMA_CH2_STREAM STM32_DMA2_STREAM2 // DMA Stream for TIMx_CH2
+#endif
+#ifndef WS2812_GPIO_DMA_CH2_CHANNEL
+#    define WS2812_GPIO_DMA_CH2_CHANNEL 6 // DMA Channel for TIMx_CH2
+#endif
+#if (STM32_DMA_SUPPORTS_DMAMUX == TRUE) && !(defined(WS2812_GPIO_DMA_UP_DMAMUX_ID) && defined(WS2812_GPIO_DMA_CH1_DMAMUX_ID) && defined(WS2812_GPIO_DMA_CH2_DMAMUX_ID))
+#    error "please consult your MCU's datasheet and specify in your config.h: #define WS2812_GPIO_DMA_UP_DMAMUX_ID STM32_DMAMUX1_TIM?_UP, WS2812_GPIO_DMA_CH1_DMAMUX_ID STM32_DMAMUX1_TIM?_CH1 and WS2812_GPIO_DMA_CH2_DMAMUX_ID STM32_DMAMUX1_TIM?_CH2"
+#endif
+
+#ifndef WS2812_GPIO_DMA_FREQUENCY
+#    define WS2812_GPIO_DMA_FREQUENCY (CPU_CLOCK / 2) // Timer clock, must be valid with respect to the system clock
+#endif
+
+// Push Pull or Open Drain Configuration
+// Default Push Pull
+#ifndef WS2812_EXTERNAL_PULLUP
+#    define WS2812_OUTPUT_MODE PAL_MODE_OUTPUT_PUSHPULL
+#else
+#    define WS2812_OUTPUT_MODE PAL_MODE_OUTPUT_OPENDRAIN
+#endif
+
+#define WS2812_TICKS(ns) ((uint32_t)((uint64_t)WS2812_GPIO_DMA_FREQUENCY * (ns) / 1000000000))
+#define WS2812_COLOR_BITS (WS2812_CHANNELS * 8)
+#define WS2812_BIT_N (RGBLED_NUM * WS2812_COLOR_BITS)
+
+#if defined(USE_GPIOV1)
+// BSRR only takes word writes, pins are reset through its upper half
+typedef uint32_t ws2812_bit_t;
+#    define WS2812_RESET_WORD(mask) ((uint32_t)(mask) << 16)
+#    define WS2812_RESET_OFFSET 0
+#    define WS2812_DMA_SIZE (STM32_DMA_CR_PSIZE_WORD | STM32_DMA_CR_MSIZE_WORD)
+#else
+// Half word writes to either half of BSRR, which halves the frame buffer
+typedef uint16_t ws2812_bit_t;
+#    define WS2812_RESET_WORD(mask) (mask)
+#    define WS2812_RESET_OFFSET 2
+#    define WS2812_DMA_SIZE (STM32_DMA_CR_PSIZE_HWORD | STM32_DMA_CR_MSIZE_HWORD)
+#endif
+
+// Timer events that raise the three DMA requests
+#define WS2812_DMA_REQUESTS (STM32_TIM_DIER_UDE | STM32_TIM_DIER_CC1DE | STM32_TIM_DIER_CC2DE)
+
+#define WS2812_DMA_MODE(channel) (STM32_DMA_CR_CHSEL(channel) | STM32_DMA_CR_DIR_M2P | WS2812_DMA_SIZE | STM32_DMA_CR_PL(3))
+
+static ws2812_bit_t ws2812_frame_buffer[WS2812_BIT_N];
+static ws2812_bit_t ws2812_set_bits;
+static ws2812_bit_t ws2812_reset_bits;
+
+static const stm32_dma_stream_t *ws2812_up_dma;
+static const stm32_dma_stream_t *ws2812_ch1_dma;
+static const stm32_dma_stream_t *ws2812_ch2_dma;
+
+static virtual_timer_t ws2812_reset_timer;
+static binary_semaphore_t ws2812_idle;
+
+__attribute__((weak)) void ws2812_transfer_complete(void) {}
+
+static void ws2812_reset_done(void *arg) {
+    (void)arg;
+    chSysLockFromISR();
+    chBSemSignalI(&ws2812_idle);
+    ws2812_transfer_complete();
+    chSysUnlockFromISR();
+}
+
+// The last bit has been pulled low, the line now has to stay low for the reset time
+static void ws2812_dma_done(void *arg, uint32_t flags) {
+    (void)arg;
+    (void)flags;
+    WS2812_GPIO_DMA_TIMER.tim->CR1 &= ~STM32_TIM_CR1_CEN;
+    dmaStreamDisable(ws2812_up_dma);
+    dmaStreamDisable(ws2812_ch1_dma);
+    dmaStreamDisable(ws2812_ch2_dma);
+
+    chSysLockFromISR();
+    chVTSetI(&ws2812_reset_timer, TIME_US2I(WS2812_TRST_US), ws2812_reset_done, NULL);
+    chSysUnlockFromISR();
+}
+
+static const stm32_dma_stream_t *ws2812_dma_alloc(const stm32_dma_stream_t *stream, stm32_dmaisr_t func, uint8_t offset) {
+    const stm32_dma_stream_t *dma = dmaStreamAlloc(stream - STM32_DMA_STREAM(0), 10, func, NULL);
+    dmaStreamSetPeripheral(dma, (uint8_t *)&PAL_PORT(RGB_DI_PIN)->BSRR + offset);
+    return dma;
+}
+
+void ws2812_init(void) {
+    ioportmask_t mask = PAL_PORT_BIT(PAL_PAD(RGB_DI_PIN));
+    ws2812_set_bits   = mask;
+    ws2812_reset_bits = WS2812_RESET_WORD(mask);
+
+    palClearLine(RGB_DI_PIN);
+    palSetLineMode(RGB_DI_PIN, WS2812_OUTPUT_MODE);
+
+    chVTObjectInit(&ws2812_reset_timer);
+    chBSemObjectInit(&ws2812_idle, false);
+
+    ws2812_up_dma  = ws2812_dma_alloc(WS2812_GPIO_DMA_UP_STREAM, NULL, 0);
+    ws2812_ch1_dma = ws2812_dma_alloc(WS2812_GPIO_DMA_CH1_STREAM, NULL, WS2812_RESET_OFFSET);
+    ws2812_ch2_dma = ws2812_dma_alloc(WS2812_GPIO_DMA_CH2_STREAM, ws2812_dma_done, WS2812_RESET_OFFSET);
+
+#if (STM32_DMA_SUPPORTS_DMAMUX == TRUE)
+    // If the MCU has a DMAMUX we need to assign the correct resource
+    dmaSetRequestSource(ws2812_up_dma, WS2812_GPIO_DMA_UP_DMAMUX_ID);
+    dmaSetRequestSource(ws2812_ch1_dma, WS2812_GPIO_DMA_CH1_DMAMUX_ID);
+    dmaSetRequestSource(ws2812_ch2_dma, WS2812_GPIO_DMA_CH2_DMAMUX_ID);
+#endif
+
+    // The channels only raise DMA requests, none of them drives a pin
+    static const PWMConfig ws2812_pwm_config = {
+        .frequency = WS2812_GPIO_DMA_FREQUENCY,
+        .period    = WS2812_TICKS(WS2812_TIMING),
+        .callback  = NULL,
+        .channels =
+            {
+                [0 ... 3] = {.mode = PWM_OUTPUT_DISABLED, .callback = NULL},
+            },
+        .cr2  = 0,
+        .dier = WS2812_DMA_REQUESTS,
+    };
+    pwmStart(&WS2812_GPIO_DMA_TIMER, &ws2812_pwm_config);
+    // Stop until there is something to send, and let the software update event raise a DMA request
+    WS2812_GPIO_DMA_TIMER.tim->CR1 &= ~(STM32_TIM_CR1_CEN | STM32_TIM_CR1_URS);
+    WS2812_GPIO_DMA_TIMER.tim->CCR[0] = WS2812_TICKS(WS2812_T0H);
+    WS2812_GPIO_DMA_TIMER.tim->CCR[1] = WS2812_TICKS(WS2812_T1H);
+}
+
+static inline ws2812_bit_t *ws2812_encode_byte(ws2812_bit_t *out, uint8_t byte) {
+    // WS2812 protocol wants most significant bits first
+    for (uint8_t bit = 0x80; bit; bit >>= 1) {
+        *out++ = (byte & bit) ? 0 : ws2812_reset_bits;
+    }
+    return out;
+}
+
+// Setleds for standard RGB
+void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
+    static bool s_init = false;
+    if (!s_init) {
+        ws2812_init();
+        s_init = true;
+    }
+
+    if (leds > RGBLED_NUM) leds = RGBLED_NUM;
+    if (leds == 0) return;
+
+    // The previous frame may still be going out
+    chBSemWait(&ws2812_idle);
+
+    ws2812_bit_t *out = ws2812_frame_buffer;
+    for (uint16_t i = 0; i < leds; i++) {
+        // WS2812 protocol dictates grb order
+#if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
+        out = ws2812_encode_byte(out, ledarray[i].g);
+        out = ws2812_encode_byte(out, ledarray[i].r);
+        out = ws2812_encode_byte(out, ledarray[i].b);
+#elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_RGB)
+        out = ws2812_encode_byte(out, ledarray[i].r);
+        out = ws2812_encode_byte(out, ledarray[i].g);
+        out = ws2812_encode_byte(out, ledarray[i].b);
+#elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_BGR)
+        out = ws2812_encode_byte(out, ledarray[i].b);
+        out = ws2812_encode_byte(out, ledarray[i].g);
+        out = ws2812_encode_byte(out, ledarray[i].r);
+#endif
+
+#ifdef RGBW
+        out = ws2812_encode_byte(out, ledarray[i].w);
+#endif
+    }
+
+    size_t bits = out - ws2812_frame_buffer;
+
+    dmaStreamSetMemory0(ws2812_up_dma, &ws2812_set_bits);
+    dmaStreamSetTransactionSize(ws2812_up_dma, bits);
+    dmaStreamSetMode(ws2812_up_dma, WS2812_DMA_MODE(WS2812_GPIO_DMA_UP_CHANNEL));
+
+    dmaStreamSetMemory0(ws2812_ch1_dma, ws2812_frame_buffer);
+    dmaStreamSetTransactionSize(ws2812_ch1_dma, bits);
+    dmaStreamSetMode(ws2812_ch1_dma, WS2812_DMA_MODE(WS2812_GPIO_DMA_CH1_CHANNEL) | STM32_DMA_CR_MINC);
+
+    dmaStreamSetMemory0(ws2812_ch2_dma, &ws2812_reset_bits);
+    dmaStreamSetTransactionSize(ws2812_ch2_dma, bits);
+    dmaStreamSetMode(ws2812_ch2_dma, WS2812_DMA_MODE(WS2812_GPIO_DMA_CH2_CHANNEL) | STM32_DMA_CR_TCIE);
+
+    // The timer stopped partway through the last bit, restart its counter and drop the requests the streams did not take
+    WS2812_GPIO_DMA_TIMER.tim->DIER &= ~WS2812_DMA_REQUESTS;
+    WS2812_GPIO_DMA_TIMER.tim->CNT = 0;
+    WS2812_GPIO_DMA_TIMER.tim->SR  = 0;
+    WS2812_GPIO_DMA_TIMER.tim->DIER |= WS2812_DMA_REQUESTS;
+    dmaStreamClearInterrupt(ws2812_up_dma);
+    dmaStreamClearInterrupt(ws2812_ch1_dma);
+    dmaStreamClearInterrupt(ws2812_ch2_dma);
+
+    dmaStreamEnable(ws2812_up_dma);
+    dmaStreamEnable(ws2812_ch1_dma);
+    dmaStreamEnable(ws2812_ch2_dma);
+
+    // The update event restarts the counter and raises the first bit
+    WS2812_GPIO_DMA_TIMER.tim->CR1 |= STM32_TIM_CR1_CEN;
+    WS2812_GPIO_DMA_TIMER.tim->EGR = STM32_TIM_EGR_UG;
+}
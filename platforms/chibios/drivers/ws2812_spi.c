@@ -79,58 +79,88 @@
 #define DATA_SIZE (BYTES_FOR_LED * RGBLED_NUM)
 #define RESET_SIZE (1000 * WS2812_TRST_US / (2 * WS2812_TIMING))
 #define PREAMBLE_SIZE 4
+#define TXBUF_SIZE (PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE)
 
-static uint8_t txbuf[PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE] = {0};
+#ifdef WS2812_SPI_USE_CIRCULAR_BUFFER
+#    define WS2812_SPI_BUFFER_COUNT 1 // the same buffer is sent over and over
+#else
+#    define WS2812_SPI_BUFFER_COUNT 2 // the next frame is encoded while the other buffer is sent
+#endif
+
+static uint8_t txbuf[WS2812_SPI_BUFFER_COUNT][TXBUF_SIZE] = {0};
+// Colors currently encoded in each buffer, so unchanged LEDs don't have to be encoded again
+static LED_TYPE txbuf_leds[WS2812_SPI_BUFFER_COUNT][RGBLED_NUM];
+
+#if WS2812_SPI_BUFFER_COUNT > 1
+static uint8_t       front   = 0; // buffer that was sent last or is being sent
+static volatile bool sending = false;
+static volatile bool pending = false; // the other buffer waits to be sent
+#endif
 
 /*
  * As the trick here is to use the SPI to send a huge pattern of 0 and 1 to
- * the ws2812b protocol, we use this helper function to translate bytes into
- * 0s and 1s for the LED (with the appropriate timing).
+ * the ws2812b protocol, every LED data bit becomes 4 SPI bits: 1110 for a one
+ * and 1000 for a zero. This table holds the two SPI bytes for every nibble.
  */
-static uint8_t get_protocol_eq(uint8_t data, int pos) {
-    uint8_t eq = 0;
-    if (data & (1 << (2 * (3 - pos))))
-        eq = 0b1110;
-    else
-        eq = 0b1000;
-    if (data & (2 << (2 * (3 - pos))))
-        eq += 0b11100000;
-    else
-        eq += 0b10000000;
-    return eq;
+static const uint8_t protocol_eq[16][2] = {
+    {0x88, 0x88}, {0x88, 0x8E}, {0x88, 0xE8}, {0x88, 0xEE}, {0x8E, 0x88}, {0x8E, 0x8E}, {0x8E, 0xE8}, {0x8E, 0xEE},
+    {0xE8, 0x88}, {0xE8, 0x8E}, {0xE8, 0xE8}, {0xE8, 0xEE}, {0xEE, 0x88}, {0xEE, 0x8E}, {0xEE, 0xE8}, {0xEE, 0xEE},
+};
+
+static inline uint8_t* encode_byte(uint8_t* out, uint8_t data) {
+    const uint8_t* high = protocol_eq[data >> 4];
+    const uint8_t* low  = protocol_eq[data & 0x0F];
+    out[0]              = high[0];
+    out[1]              = high[1];
+    out[2]              = low[0];
+    out[3]              = low[1];
+    return out + BYTES_FOR_LED_BYTE;
 }
 
-static void set_led_color_rgb(LED_TYPE color, int pos) {
-    uint8_t* tx_start = &txbuf[PREAMBLE_SIZE];
+static void set_led_color_rgb(uint8_t buffer, LED_TYPE color, int pos) {
+    uint8_t* out = &txbuf[buffer][PREAMBLE_SIZE + BYTES_FOR_LED * pos];
 
 #if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
+    out = encode_byte(out, color.g);
+    out = encode_byte(out, color.r);
+    out = encode_byte(out, color.b);
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_RGB)
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
+    out = encode_byte(out, color.r);
+    out = encode_byte(out, color.g);
+    out = encode_byte(out, color.b);
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_BGR)
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.b, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.r, j);
+    out = encode_byte(out, color.b);
+    out = encode_byte(out, color.g);
+    out = encode_byte(out, color.r);
 #endif
 #ifdef RGBW
-    for (int j = 0; j < 4; j++)
-        tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 4 + j] = get_protocol_eq(color.w, j);
+    out = encode_byte(out, color.w);
 #endif
+
+    txbuf_leds[buffer][pos] = color;
 }
 
+__attribute__((weak)) void ws2812_transfer_complete(void) {}
+
+#if WS2812_SPI_BUFFER_COUNT > 1
+static void ws2812_spi_end(SPIDriver* spip) {
+    chSysLockFromISR();
+    ws2812_transfer_complete();
+    if (pending) {
+        // the next frame has been waiting, send it right away
+        pending = false;
+        front ^= 1;
+        spiStartSendI(spip, TXBUF_SIZE, txbuf[front]);
+    } else {
+        sending = false;
+    }
+    chSysUnlockFromISR();
+}
+#    define WS2812_SPI_END_CB ws2812_spi_end
+#else
+#    define WS2812_SPI_END_CB NULL
+#endif
+
 void ws2812_init(void) {
     palSetLineMode(RGB_DI_PIN, WS2812_MOSI_OUTPUT_MODE);
 
@@ -138,14 +168,22 @@ void ws2812_init(void) {
     palSetLineMode(WS2812_SPI_SCK_PIN, WS2812_SCK_OUTPUT_MODE);
 #endif // WS2812_SPI_SCK_PIN
 
+    // All LEDs start out black
+    LED_TYPE black = {0};
+    for (uint8_t buffer = 0; buffer < WS2812_SPI_BUFFER_COUNT; buffer++) {
+        for (uint16_t i = 0; i < RGBLED_NUM; i++) {
+            set_led_color_rgb(buffer, black, i);
+        }
+    }
+
     // TODO: more dynamic baudrate
-    static const SPIConfig spicfg = {WS2812_SPI_BUFFER_MODE, NULL, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN), WS2812_SPI_DIVISOR_CR1_BR_X};
+    static const SPIConfig spicfg = {WS2812_SPI_BUFFER_MODE, WS2812_SPI_END_CB, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN), WS2812_SPI_DIVISOR_CR1_BR_X};
 
     spiAcquireBus(&WS2812_SPI);     /* Acquire ownership of the bus.    */
     spiStart(&WS2812_SPI, &spicfg); /* Setup transfer parameters.       */
     spiSelect(&WS2812_SPI);         /* Slave Select assertion.          */
 #ifdef WS2812_SPI_USE_CIRCULAR_BUFFER
-    spiStartSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    spiStartSend(&WS2812_SPI, TXBUF_SIZE, txbuf[0]);
 #endif
 }
 
@@ -156,17 +194,40 @@ void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
         s_init = true;
     }
 
-    for (uint8_t i = 0; i < leds; i++) {
-        set_led_color_rgb(ledarray[i], i);
+    if (leds > RGBLED_NUM) leds = RGBLED_NUM;
+
+#if WS2812_SPI_BUFFER_COUNT > 1
+    // Only the buffer that is being sent is off limits, a frame still waiting in the other one gets replaced
+    chSysLock();
+    pending = false;
+    chSysUnlock();
+    uint8_t buffer = front ^ 1;
+#else
+    uint8_t buffer = 0;
+#endif
+
+    for (uint16_t i = 0; i < leds; i++) {
+        if (memcmp(&txbuf_leds[buffer][i], &ledarray[i], sizeof(LED_TYPE)) != 0) {
+            set_led_color_rgb(buffer, ledarray[i], i);
+        }
     }
 
-    // Send async - each led takes ~0.03ms, 50 leds ~1.5ms, animations flushing faster than send will cause issues.
-    // Instead spiSend can be used to send synchronously (or the thread logic can be added back).
+    // Send async - each led takes ~0.03ms, 50 leds ~1.5ms. While a frame is
+    // being sent the next one is queued and follows as soon as it is done.
 #ifndef WS2812_SPI_USE_CIRCULAR_BUFFER
 #    ifdef WS2812_SPI_SYNC
-    spiSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    spiSend(&WS2812_SPI, TXBUF_SIZE, txbuf[buffer]);
+    front = buffer;
 #    else
-    spiStartSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    chSysLock();
+    if (sending) {
+        pending = true;
+    } else {
+        sending = true;
+        front   = buffer;
+        spiStartSendI(&WS2812_SPI, TXBUF_SIZE, txbuf[buffer]);
+    }
+    chSysUnlock();
 #    endif
 #endif
 }
@@ -24,6 +24,7 @@
 #include "debug.h"
 #include "eeprom_stm32.h"
 #include "flash_stm32.h"
+#include "keyboard.h"
 
 /*
  * We emulate eeprom by writing a snapshot compacted view of eeprom contents,
@@ -83,6 +84,9 @@
  * *** Write Log Structure ***
  *
  * Write log entries allow for optimized byte writes to addresses below 128. Writing 0 or 1 words are also optimized when word-aligned.
+ * Multi-byte writes through eeprom_write_block() are logged as a single block entry whenever that takes less
+ * log space than the equivalent byte and word entries. Block entries carry a CRC, a block which was only
+ * partially programmed (e.g. power loss in the middle of a write) is skipped as a whole during replay.
  *
  * === WRITE LOG ENTRY FORMATS ===
  *
@@ -109,9 +113,14 @@
  * ╚════════════════╝
  * 0 <= Address <= 0x3FFE (16382)
  *
- * ╔═══ Reserved ═══╗
- * ║110XXXXXXXXXXXXX║
- * ╚════════════════╝
+ * ╔═════════════════════════ Block ═════════════════════════╗
+ * ║110CCCCCCCCNNNNN║0OXXXXXXXXXXXXXX║YYYYYYYYYYYYYYYY║...║
+ * ║   └──┬───┘└─┬─┘║ │└─────┬──────┘║└───────┬──────┘║   ║
+ * ║    CRC8  Words-1║ Odd  Address   ║   ~Data[0..1]  ║   ║
+ * ╚════════════════╩════════════════╩════════════════╩═══╝
+ * 0 <= Address <= 0x3FFF (16383)
+ * 1 <= Words <= 32, length in bytes is 2 * Words, minus one if the Odd bit is set
+ * CRC8 covers the second header word and all data words as stored in flash
  *
  * ╔═══════════ Word-Next ═══════════╗
  * ║111XXXXXXXXXXXXX║YYYYYYYYYYYYYYYY║
@@ -125,11 +134,29 @@
  * 0x0000 ... 0x7FFF - Byte-Entry;     address is (Entry & 0x7F00) >> 4; value is (Entry & 0xFF)
  * 0x8000 ... 0x9FFF - Word-Encoded 0; address is (Entry & 0x1FFF) << 1; value is 0
  * 0xA000 ... 0xBFFF - Word-Encoded 1; address is (Entry & 0x1FFF) << 1; value is 1
- * 0xC000 ... 0xDFFF - Reserved
+ * 0xC000 ... 0xDFFF - Block;          Words is (Entry & 0x1F) + 1; address and length follow in the next entry; data in the Words after
  * 0xE000 ... 0xFFBF - Word-Next;      address is (Entry & 0x1FFF) << 1 + 0x80; value is ~(Next_Entry)
- * 0xFFC0 ... 0xFFFE - Reserved
+ * 0xFFC0 ... 0xFFFE - Reserved (Bank marker as first entry of the write log, see below)
  * 0xFFFF            - Unprogrammed
  *
+ *
+ * *** Incremental Compaction ***
+ *
+ * With FEE_INCREMENTAL_COMPACTION defined the pages are split into two banks of
+ * Compacted + Write log each. Once the free write log space drops below
+ * FEE_COMPACTION_LOW_WATER, eeprom_driver_task() starts compacting into the other bank:
+ * one page erase or FEE_COMPACTION_STEP_WORDS programmed words per call. An erase stalls
+ * the CPU for as long as it takes, so it is only done once there was no input for
+ * FEE_COMPACTION_ERASE_IDLE_MS. Writes keep
+ * going to the active bank in the meantime. Words which changed after they were copied
+ * are carried over as log entries into the new bank, and only then the new bank's
+ * marker (0xFFC0 | generation) is programmed as the first word of its write log.
+ *
+ * During initialization the bank with the newer marker wins. A power loss during a
+ * compaction leaves the new bank without a marker, so the old bank stays in use and
+ * the compaction simply starts over. A write which finds the write log full before
+ * the compaction is done finishes it synchronously.
+ *
  */
 
 #include "eeprom_stm32_defs.h"
@@ -140,6 +167,15 @@
 #define FEE_VALUE_ENCODED 0x2000
 #define FEE_BYTE_RANGE 0x80
 
+/* Block entries, see above */
+#define FEE_BLOCK_ENCODING 0xC000
+#define FEE_BLOCK_WORDS_MASK 0x1F
+#define FEE_BLOCK_CRC_SHIFT 5
+#define FEE_BLOCK_ODD_LENGTH 0x4000
+#define FEE_BLOCK_ADDRESS_MASK 0x3FFF
+#define FEE_BLOCK_MAX_WORDS (FEE_BLOCK_WORDS_MASK + 1)
+#define FEE_BLOCK_MAX_BYTES (FEE_BLOCK_MAX_WORDS * 2)
+
 /* Flash word value after erase */
 #define FEE_EMPTY_WORD ((uint16_t)0xFFFF)
 
@@ -155,6 +191,35 @@ static uint8_t *DataBuf = (uint8_t *)WordBuf;
 /* Pointer to the first available slot within the write log */
 static uint16_t *empty_slot;
 
+/* Flash wear counters since boot */
+static EEPROM_WearStats wear_stats;
+
+#if defined(FEE_INCREMENTAL_COMPACTION)
+#    define FEE_BANK_BYTES (FEE_BANK_PAGE_COUNT * FEE_PAGE_SIZE)
+#    define FEE_BANK_MARKER 0xFFC0
+#    define FEE_BANK_GENERATIONS 0x3F
+#    define FEE_BANK_UNMARKED 0xFF
+
+typedef enum {
+    COMPACTION_IDLE,
+    COMPACTION_ERASE,
+    COMPACTION_COPY,
+} compaction_state_t;
+
+/* Bank in use, referenced through FEE_BANK_BASE_ADDRESS */
+static uintptr_t fee_active_bank;
+static uint8_t   active_generation;
+
+/* Background compaction into the other bank, cursor counts pages while erasing and words while copying */
+static compaction_state_t compaction_state;
+static uint16_t           compaction_cursor;
+
+static uint8_t eeprom_compact(void);
+#endif
+
+/* First write log entry, behind the bank marker if there is one */
+static uint16_t *log_start;
+
 // #define DEBUG_EEPROM_OUTPUT
 
 /*
@@ -213,7 +278,95 @@ void print_eeprom(void) {
 #endif
 }
 
+/*
+ * CRC-8 (polynomial 0x07) of block entries. Deliberately not using quantum/crc.c:
+ * the on-flash format must not depend on CRC8_USE_TABLE or a hardware CRC unit,
+ * and the eeprom is read long before crc_init() runs.
+ */
+static uint8_t fee_crc8(const uint16_t *data, uint16_t words) {
+    uint8_t crc = 0xFF;
+    for (uint16_t i = 0; i < words; i++) {
+        for (uint8_t shift = 0; shift < 16; shift += 8) {
+            crc ^= (uint8_t)(data[i] >> shift);
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+            }
+        }
+    }
+    return crc;
+}
+
+/* Replay a block entry, returns the number of additional log words it occupies */
+static uint16_t eeprom_replay_block_entry(uint16_t *log_addr) {
+    uint16_t  header = *log_addr;
+    uint16_t  words  = (header & FEE_BLOCK_WORDS_MASK) + 1;
+    uint16_t *info   = log_addr + 1;
+
+    if (info + 1 + words > (uint16_t *)FEE_WRITE_LOG_LAST_ADDRESS) {
+        eeprom_printf("Truncated block at log_addr: 0x%04x;\n", (uint32_t)log_addr);
+        return words + 1;
+    }
+    if (fee_crc8(info, words + 1) != (uint8_t)(header >> FEE_BLOCK_CRC_SHIFT)) {
+        eeprom_printf("Incomplete block at log_addr: 0x%04x;\n", (uint32_t)log_addr);
+        /* Possibly incomplete write.  Ignore the whole block and continue */
+        return words + 1;
+    }
+
+    uint16_t address = *info & FEE_BLOCK_ADDRESS_MASK;
+    uint16_t length  = words * 2 - ((*info & FEE_BLOCK_ODD_LENGTH) ? 1 : 0);
+    if (address + length > FEE_DENSITY_BYTES) {
+        eeprom_printf("DataBuf[0x%04x] cannot be set to block of %d bytes [BAD ADDRESS]\n", address, length);
+        return words + 1;
+    }
+
+    eeprom_printf("DataBuf[0x%04x] = block of %d bytes;\n", address, length);
+    for (uint16_t i = 0; i < length; i++) {
+        uint16_t wvalue = ~info[1 + i / 2];
+        DataBuf[address + i] = (i % 2) ? wvalue >> 8 : wvalue;
+    }
+    return words + 1;
+}
+
+#if defined(FEE_INCREMENTAL_COMPACTION)
+static uint8_t eeprom_bank_generation(uintptr_t bank) {
+    uint16_t marker = *(uint16_t *)(bank + FEE_DENSITY_BYTES);
+    if ((marker & ~FEE_BANK_GENERATIONS) != FEE_BANK_MARKER || marker == FEE_EMPTY_WORD) {
+        return FEE_BANK_UNMARKED;
+    }
+    return marker & FEE_BANK_GENERATIONS;
+}
+
+static uint8_t eeprom_next_generation(uint8_t generation) {
+    return generation == FEE_BANK_UNMARKED ? 0 : (generation + 1) % FEE_BANK_GENERATIONS;
+}
+
+/* Pick the bank holding the newest contents, an unmarked first bank is a freshly erased one */
+static void eeprom_select_bank(void) {
+    uintptr_t other            = FEE_PAGE_BASE_ADDRESS + FEE_BANK_BYTES;
+    uint8_t   first_generation = eeprom_bank_generation(FEE_PAGE_BASE_ADDRESS);
+    uint8_t   other_generation = eeprom_bank_generation(other);
+
+    if (other_generation != FEE_BANK_UNMARKED && (first_generation == FEE_BANK_UNMARKED || other_generation == eeprom_next_generation(first_generation))) {
+        fee_active_bank   = other;
+        active_generation = other_generation;
+    } else {
+        fee_active_bank   = FEE_PAGE_BASE_ADDRESS;
+        active_generation = first_generation;
+    }
+
+    log_start        = (uint16_t *)FEE_WRITE_LOG_BASE_ADDRESS + (active_generation != FEE_BANK_UNMARKED ? 1 : 0);
+    compaction_state = COMPACTION_IDLE;
+    eeprom_printf("eeprom_select_bank: 0x%08x generation %d\n", (uint32_t)fee_active_bank, active_generation);
+}
+#endif
+
 uint16_t EEPROM_Init(void) {
+#if defined(FEE_INCREMENTAL_COMPACTION)
+    eeprom_select_bank();
+#else
+    log_start = (uint16_t *)FEE_WRITE_LOG_BASE_ADDRESS;
+#endif
+
     /* Load emulated eeprom contents from compacted flash into memory */
     uint16_t *src  = (uint16_t *)FEE_COMPACTED_BASE_ADDRESS;
     uint16_t *dest = (uint16_t *)DataBuf;
@@ -229,7 +382,7 @@ uint16_t EEPROM_Init(void) {
 
     /* Replay write log */
     uint16_t *log_addr;
-    for (log_addr = (uint16_t *)FEE_WRITE_LOG_BASE_ADDRESS; log_addr < (uint16_t *)FEE_WRITE_LOG_LAST_ADDRESS; ++log_addr) {
+    for (log_addr = log_start; log_addr < (uint16_t *)FEE_WRITE_LOG_LAST_ADDRESS; ++log_addr) {
         uint16_t address = *log_addr;
         if (address == FEE_EMPTY_WORD) {
             break;
@@ -259,9 +412,13 @@ uint16_t EEPROM_Init(void) {
                 /* Writes to addresses less than 128 are byte log entries */
                 address += FEE_BYTE_RANGE;
             } else {
-                /* Reserved for future use */
+                /* Multi-byte block */
                 if (address & FEE_VALUE_RESERVED) {
-                    eeprom_printf("Reserved encoded value at log_addr: 0x%04x;\n", (uint32_t)log_addr);
+                    log_addr += eeprom_replay_block_entry(log_addr);
+                    if (log_addr >= (uint16_t *)FEE_WRITE_LOG_LAST_ADDRESS) {
+                        log_addr = (uint16_t *)FEE_WRITE_LOG_LAST_ADDRESS;
+                        break;
+                    }
                     continue;
                 }
                 /* Optimization for 0 or 1 values. */
@@ -295,11 +452,17 @@ static void eeprom_clear(void) {
     for (uint16_t page_num = 0; page_num < FEE_PAGE_COUNT; ++page_num) {
         eeprom_printf("FLASH_ErasePage(0x%04x)\n", (uint32_t)(FEE_PAGE_BASE_ADDRESS + (page_num * FEE_PAGE_SIZE)));
         FLASH_ErasePage(FEE_PAGE_BASE_ADDRESS + (page_num * FEE_PAGE_SIZE));
+        ++wear_stats.page_erases;
     }
 
     FLASH_Lock();
 
-    empty_slot = (uint16_t *)FEE_WRITE_LOG_BASE_ADDRESS;
+#if defined(FEE_INCREMENTAL_COMPACTION)
+    eeprom_select_bank();
+#else
+    log_start = (uint16_t *)FEE_WRITE_LOG_BASE_ADDRESS;
+#endif
+    empty_slot = log_start;
     eeprom_printf("eeprom_clear empty_slot: 0x%08x\n", (uint32_t)empty_slot);
 }
 
@@ -312,10 +475,12 @@ void EEPROM_Erase(void) {
     EEPROM_Init();
 }
 
+#if !defined(FEE_INCREMENTAL_COMPACTION)
 /* Compact write log */
 static uint8_t eeprom_compact(void) {
     /* Erase compacted pages and write log */
     eeprom_clear();
+    ++wear_stats.compactions;
 
     FLASH_Unlock();
 
@@ -343,6 +508,7 @@ static uint8_t eeprom_compact(void) {
 
     return final_status;
 }
+#endif
 
 static uint8_t eeprom_write_direct_entry(uint16_t Address) {
     /* Check if we can just write this directly to the compacted flash area */
@@ -357,6 +523,7 @@ static uint8_t eeprom_write_direct_entry(uint16_t Address) {
 
         eeprom_printf("FLASH_ProgramHalfWord(0x%08x, 0x%04x) [DIRECT]\n", (uint32_t)directAddress, value);
         FLASH_Status status = FLASH_ProgramHalfWord(directAddress, value);
+        ++wear_stats.direct_writes;
 
         FLASH_Lock();
         return status;
@@ -399,12 +566,14 @@ static uint8_t eeprom_write_log_word_entry(uint16_t Address) {
     /* address */
     eeprom_printf("FLASH_ProgramHalfWord(0x%08x, 0x%04x)\n", (uint32_t)empty_slot, Address);
     final_status = FLASH_ProgramHalfWord((uintptr_t)empty_slot++, Address);
+    ++wear_stats.log_writes;
 
     /* value */
     if (encoding == (FEE_WORD_ENCODING | FEE_VALUE_NEXT)) {
         eeprom_printf("FLASH_ProgramHalfWord(0x%08x, 0x%04x)\n", (uint32_t)empty_slot, ~value);
         FLASH_Status status = FLASH_ProgramHalfWord((uintptr_t)empty_slot++, ~value);
         if (status != FLASH_COMPLETE) final_status = status;
+        ++wear_stats.log_writes;
     }
 
     FLASH_Lock();
@@ -430,12 +599,57 @@ static uint8_t eeprom_write_log_byte_entry(uint16_t Address) {
     /* write to flash */
     eeprom_printf("FLASH_ProgramHalfWord(0x%08x, 0x%04x)\n", (uint32_t)empty_slot, value);
     FLASH_Status status = FLASH_ProgramHalfWord((uintptr_t)empty_slot++, value);
+    ++wear_stats.log_writes;
 
     FLASH_Lock();
 
     return status;
 }
 
+static uint8_t eeprom_write_log_block_entry(uint16_t Address, uint16_t Length) {
+    FLASH_Status final_status = FLASH_COMPLETE;
+    uint16_t     entry[2 + FEE_BLOCK_MAX_WORDS];
+
+    eeprom_printf("eeprom_write_log_block_entry(0x%04x, %d)\n", Address, Length);
+
+    while (Length) {
+        uint16_t chunk = Length < FEE_BLOCK_MAX_BYTES ? Length : FEE_BLOCK_MAX_BYTES;
+        uint16_t words = (chunk + 1) / 2;
+
+        /* if we can't find an empty spot, we must compact emulated eeprom */
+        if (empty_slot > (uint16_t *)FEE_WRITE_LOG_LAST_ADDRESS - (2 + words)) {
+            /* DataBuf already holds the whole block, so compaction writes all of it */
+            return eeprom_compact();
+        }
+
+        /* Build the entry first, the CRC covers everything after the first word */
+        entry[1] = Address | ((chunk % 2) ? FEE_BLOCK_ODD_LENGTH : 0);
+        for (uint16_t i = 0; i < words; i++) {
+            uint16_t value = DataBuf[Address + i * 2];
+            if (i * 2 + 1 < chunk) {
+                value |= DataBuf[Address + i * 2 + 1] << 8;
+            }
+            entry[2 + i] = ~value;
+        }
+        entry[0] = FEE_BLOCK_ENCODING | (fee_crc8(&entry[1], words + 1) << FEE_BLOCK_CRC_SHIFT) | (words - 1);
+
+        /* ok we found a place let's write our data */
+        FLASH_Unlock();
+        for (uint16_t i = 0; i < 2 + words; i++) {
+            eeprom_printf("FLASH_ProgramHalfWord(0x%08x, 0x%04x)\n", (uint32_t)empty_slot, entry[i]);
+            FLASH_Status status = FLASH_ProgramHalfWord((uintptr_t)empty_slot++, entry[i]);
+            if (status != FLASH_COMPLETE) final_status = status;
+        }
+        FLASH_Lock();
+        wear_stats.log_writes += 2 + words;
+
+        Address += chunk;
+        Length -= chunk;
+    }
+
+    return final_status;
+}
+
 uint8_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte) {
     /* if the address is out-of-bounds, do nothing */
     if (Address >= FEE_DENSITY_BYTES) {
@@ -528,6 +742,264 @@ uint8_t EEPROM_WriteDataWord(uint16_t Address, uint16_t DataWord) {
     return final_status;
 }
 
+#if defined(FEE_INCREMENTAL_COMPACTION)
+static uintptr_t eeprom_compaction_target(void) {
+    return fee_active_bank == FEE_PAGE_BASE_ADDRESS ? FEE_PAGE_BASE_ADDRESS + FEE_BANK_BYTES : FEE_PAGE_BASE_ADDRESS;
+}
+
+static bool eeprom_page_is_blank(uintptr_t page) {
+    for (uint16_t *word = (uint16_t *)page; word < (uint16_t *)(page + FEE_PAGE_SIZE); ++word) {
+        if (*word != FEE_EMPTY_WORD) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Log space needed to carry the words changed behind the copy cursor over to the target bank */
+static uint16_t eeprom_carry_over_cost(uintptr_t target) {
+    uint16_t cost = 0;
+    for (uint16_t address = 0; address < FEE_DENSITY_BYTES; address += 2) {
+        uint16_t compacted = *(uint16_t *)(target + address);
+        uint16_t old_value = ~compacted;
+        uint16_t value     = *(uint16_t *)(&DataBuf[address]);
+        if (old_value == value || compacted == FEE_EMPTY_WORD) {
+            continue;
+        }
+        if (address < FEE_BYTE_RANGE) {
+            cost += ((uint8_t)old_value != (uint8_t)value) + ((old_value >> 8) != (value >> 8));
+        } else {
+            cost += value <= 1 ? 1 : 2;
+        }
+    }
+    return cost * 2;
+}
+
+static bool eeprom_compaction_step(uint16_t budget);
+
+/* Switch over to the freshly written bank, the marker goes last so a power loss keeps the old bank */
+static void eeprom_compaction_finish(uintptr_t target) {
+    if (eeprom_carry_over_cost(target) > FEE_WRITE_LOG_BYTES - 2) {
+        /* Too much changed while copying, start over and copy everything in one go */
+        eeprom_printf("eeprom_compaction_finish: restart\n");
+        compaction_state  = COMPACTION_ERASE;
+        compaction_cursor = 0;
+        while (eeprom_compaction_step(UINT16_MAX)) {
+        }
+        return;
+    }
+
+    fee_active_bank  = target;
+    compaction_state = COMPACTION_IDLE;
+    log_start        = (uint16_t *)FEE_WRITE_LOG_BASE_ADDRESS + 1;
+    empty_slot       = log_start;
+
+    for (uint16_t address = 0; address < FEE_DENSITY_BYTES; address += 2) {
+        uint16_t old_value = ~*(uint16_t *)(target + address);
+        uint16_t value     = *(uint16_t *)(&DataBuf[address]);
+        if (old_value == value) {
+            continue;
+        }
+        if (!eeprom_write_direct_entry(address)) {
+            if (address < FEE_BYTE_RANGE) {
+                if ((uint8_t)old_value != (uint8_t)value) {
+                    eeprom_write_log_byte_entry(address);
+                }
+                if ((old_value >> 8) != (value >> 8)) {
+                    eeprom_write_log_byte_entry(address + 1);
+                }
+            } else {
+                eeprom_write_log_word_entry(address);
+            }
+        }
+    }
+
+    active_generation = eeprom_next_generation(active_generation);
+    FLASH_Unlock();
+    eeprom_printf("FLASH_ProgramHalfWord(0x%08x, 0x%04x) [MARKER]\n", (uint32_t)FEE_WRITE_LOG_BASE_ADDRESS, FEE_BANK_MARKER | active_generation);
+    FLASH_ProgramHalfWord(FEE_WRITE_LOG_BASE_ADDRESS, FEE_BANK_MARKER | active_generation);
+    FLASH_Lock();
+    ++wear_stats.compactions;
+
+    if (debug_eeprom) {
+        println("eeprom_compacted:");
+        print_eeprom();
+    }
+}
+
+/* Advance the background compaction, returns false once it is done */
+static bool eeprom_compaction_step(uint16_t budget) {
+    uintptr_t target = eeprom_compaction_target();
+
+    switch (compaction_state) {
+        case COMPACTION_ERASE: {
+            /* At most one page erase per step */
+            uintptr_t page = target + compaction_cursor * FEE_PAGE_SIZE;
+            if (!eeprom_page_is_blank(page)) {
+                FLASH_Unlock();
+                eeprom_printf("FLASH_ErasePage(0x%04x)\n", (uint32_t)page);
+                FLASH_ErasePage(page);
+                FLASH_Lock();
+                ++wear_stats.page_erases;
+            }
+            if (++compaction_cursor == FEE_BANK_PAGE_COUNT) {
+                compaction_state  = COMPACTION_COPY;
+                compaction_cursor = 0;
+            }
+            return true;
+        }
+        case COMPACTION_COPY: {
+            FLASH_Unlock();
+            for (; budget && compaction_cursor < FEE_DENSITY_BYTES / 2; --budget, ++compaction_cursor) {
+                uint16_t value = WordBuf[compaction_cursor];
+                if (value) {
+                    FLASH_ProgramHalfWord(target + compaction_cursor * 2, ~value);
+                }
+            }
+            FLASH_Lock();
+            if (compaction_cursor < FEE_DENSITY_BYTES / 2) {
+                return true;
+            }
+            eeprom_compaction_finish(target);
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+static void eeprom_compaction_start(void) {
+    eeprom_printf("eeprom_compaction_start: 0x%08x\n", (uint32_t)eeprom_compaction_target());
+    compaction_state  = COMPACTION_ERASE;
+    compaction_cursor = 0;
+}
+
+/* Write log is full, finish the compaction right away */
+static uint8_t eeprom_compact(void) {
+    if (compaction_state == COMPACTION_IDLE) {
+        eeprom_compaction_start();
+    }
+    while (eeprom_compaction_step(UINT16_MAX)) {
+    }
+    return FLASH_COMPLETE;
+}
+
+void eeprom_driver_backend_task(void) {
+    if (compaction_state == COMPACTION_IDLE) {
+        if ((uintptr_t)FEE_WRITE_LOG_LAST_ADDRESS - (uintptr_t)empty_slot > FEE_COMPACTION_LOW_WATER) {
+            return;
+        }
+        eeprom_compaction_start();
+    }
+    if (compaction_state == COMPACTION_ERASE && last_input_activity_elapsed() < FEE_COMPACTION_ERASE_IDLE_MS) {
+        return;
+    }
+    eeprom_compaction_step(FEE_COMPACTION_STEP_WORDS);
+}
+#endif
+
+/* Value of the word at Address once the block has been written */
+static uint16_t eeprom_merge_block_word(uint16_t Address, uint16_t BlockAddress, const uint8_t *DataBlock, uint16_t Length) {
+    uint16_t value = *(uint16_t *)(&DataBuf[Address]);
+    if (Address >= BlockAddress) {
+        value = (value & 0xFF00) | DataBlock[Address - BlockAddress];
+    }
+    if (Address + 1 < BlockAddress + Length) {
+        value = (value & 0x00FF) | (DataBlock[Address + 1 - BlockAddress] << 8);
+    }
+    return value;
+}
+
+uint8_t EEPROM_WriteDataBlock(uint16_t Address, const uint8_t *DataBlock, uint16_t Length) {
+    /* if the address is out-of-bounds, do nothing */
+    if (Address >= FEE_DENSITY_BYTES) {
+        eeprom_printf("EEPROM_WriteDataBlock(0x%04x, %d) [BAD ADDRESS]\n", Address, Length);
+        return FLASH_BAD_ADDRESS;
+    }
+
+    /* Write what fits, but still report the overflow */
+    FLASH_Status final_status = 0;
+    if (Length > FEE_DENSITY_BYTES - Address) {
+        eeprom_printf("EEPROM_WriteDataBlock(0x%04x, %d) [BAD ADDRESS]\n", Address, Length);
+        Length       = FEE_DENSITY_BYTES - Address;
+        final_status = FLASH_BAD_ADDRESS;
+    }
+
+    /* Find the words which can't be written directly, and what they cost as byte or word log entries */
+    uint16_t log_first = FEE_DENSITY_BYTES;
+    uint16_t log_last  = 0;
+    uint16_t log_cost  = 0;
+    for (uint16_t word = Address & 0xFFFE; word < Address + Length; word += 2) {
+        uint16_t oldValue = *(uint16_t *)(&DataBuf[word]);
+        uint16_t newValue = eeprom_merge_block_word(word, Address, DataBlock, Length);
+        if (oldValue == newValue || *(uint16_t *)(FEE_COMPACTED_BASE_ADDRESS + word) == FEE_EMPTY_WORD) {
+            continue;
+        }
+        if (word < FEE_BYTE_RANGE) {
+            log_cost += ((uint8_t)oldValue != (uint8_t)newValue) + ((oldValue >> 8) != (newValue >> 8));
+        } else {
+            log_cost += newValue <= 1 ? 1 : 2;
+        }
+        if (word < log_first) log_first = word;
+        log_last = word;
+    }
+
+    /* A block entry pays off once its header is outweighed by the per-word overhead */
+    bool     use_block  = false;
+    uint16_t block_span = 0;
+    if (log_cost) {
+        block_span = log_last + 2 - log_first;
+        use_block  = block_span / 2 + 2 * ((block_span + FEE_BLOCK_MAX_BYTES - 1) / FEE_BLOCK_MAX_BYTES) < log_cost;
+    }
+
+    for (uint16_t word = Address & 0xFFFE; word < Address + Length; word += 2) {
+        uint16_t oldValue = *(uint16_t *)(&DataBuf[word]);
+        uint16_t newValue = eeprom_merge_block_word(word, Address, DataBlock, Length);
+        if (oldValue == newValue) {
+            continue;
+        }
+
+        /* keep DataBuf cache in sync */
+        *(uint16_t *)(&DataBuf[word]) = newValue;
+
+        /* First, attempt to write directly into the compacted flash area */
+        FLASH_Status status = eeprom_write_direct_entry(word);
+        if (!status && !use_block) {
+            /* Otherwise append to the write log */
+            status = FLASH_COMPLETE;
+            if (word < FEE_BYTE_RANGE) {
+                if ((uint8_t)oldValue != (uint8_t)newValue) {
+                    status = eeprom_write_log_byte_entry(word);
+                }
+                if ((oldValue >> 8) != (newValue >> 8)) {
+                    FLASH_Status byte_status = eeprom_write_log_byte_entry(word + 1);
+                    if (byte_status != FLASH_COMPLETE) status = byte_status;
+                }
+            } else {
+                status = eeprom_write_log_word_entry(word);
+            }
+        }
+        /* Keep the first error */
+        if (status && (!final_status || final_status == FLASH_COMPLETE)) final_status = status;
+    }
+
+    if (use_block) {
+        FLASH_Status status = eeprom_write_log_block_entry(log_first, block_span);
+        if (!final_status || final_status == FLASH_COMPLETE) final_status = status;
+    }
+
+    if (final_status != 0 && final_status != FLASH_COMPLETE) {
+        eeprom_printf("EEPROM_WriteDataBlock [STATUS == %d]\n", final_status);
+    }
+    return final_status;
+}
+
+void EEPROM_GetWearStats(EEPROM_WearStats *stats) {
+    *stats          = wear_stats;
+    stats->log_used = (uintptr_t)empty_slot - (uintptr_t)log_start;
+    stats->log_size = FEE_WRITE_LOG_BYTES;
+}
+
 uint8_t EEPROM_ReadDataByte(uint16_t Address) {
     uint8_t DataByte = 0xFF;
 
@@ -568,7 +1040,7 @@ void eeprom_driver_erase(void) {
     EEPROM_Erase();
 }
 
-void eeprom_read_block(void *buf, const void *addr, size_t len) {
+void eeprom_driver_read_block(void *buf, const void *addr, size_t len) {
     const uint8_t *src  = (const uint8_t *)addr;
     uint8_t *      dest = (uint8_t *)buf;
 
@@ -598,32 +1070,6 @@ void eeprom_read_block(void *buf, const void *addr, size_t len) {
     }
 }
 
-void eeprom_write_block(const void *buf, void *addr, size_t len) {
-    uint8_t *      dest = (uint8_t *)addr;
-    const uint8_t *src  = (const uint8_t *)buf;
-
-    /* Check word alignment */
-    if (len && (uintptr_t)dest % 2) {
-        /* Write the unaligned first byte */
-        EEPROM_WriteDataByte((uintptr_t)dest++, *src++);
-        --len;
-    }
-
-    uint16_t value;
-    bool     aligned = ((uintptr_t)src % 2 == 0);
-    while (len > 1) {
-        if (aligned) {
-            value = *(uint16_t *)src;
-        } else {
-            value = *(uint8_t *)src | (*(uint8_t *)(src + 1) << 8);
-        }
-        EEPROM_WriteDataWord((uintptr_t)((uint16_t *)dest), value);
-        dest += 2;
-        src += 2;
-        len -= 2;
-    }
-
-    if (len) {
-        EEPROM_WriteDataByte((uintptr_t)dest, *src);
-    }
+void eeprom_driver_write_block(const void *buf, void *addr, size_t len) {
+    EEPROM_WriteDataBlock((uintptr_t)addr, (const uint8_t *)buf, len);
 }
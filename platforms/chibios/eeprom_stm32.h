@@ -23,10 +23,23 @@
 
 #pragma once
 
+#include <stdint.h>
+
+typedef struct {
+    uint32_t compactions;   // Rewrites of the compacted area
+    uint32_t page_erases;   // Flash pages erased
+    uint32_t direct_writes; // Half-words programmed straight into the compacted area
+    uint32_t log_writes;    // Half-words appended to the write log
+    uint16_t log_used;      // Bytes of the write log currently in use
+    uint16_t log_size;      // Total bytes of the write log
+} EEPROM_WearStats;
+
 uint16_t EEPROM_Init(void);
 void     EEPROM_Erase(void);
 uint8_t  EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte);
 uint8_t  EEPROM_WriteDataWord(uint16_t Address, uint16_t DataWord);
+uint8_t  EEPROM_WriteDataBlock(uint16_t Address, const uint8_t *DataBlock, uint16_t Length);
+void     EEPROM_GetWearStats(EEPROM_WearStats *stats);
 uint8_t  EEPROM_ReadDataByte(uint16_t Address);
 uint16_t EEPROM_ReadDataWord(uint16_t Address);
 
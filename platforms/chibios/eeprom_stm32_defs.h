@@ -76,13 +76,24 @@
 /* Addressable range 16KByte: 0 <-> (0x1FFF << 1) */
 #define FEE_ADDRESS_MAX_SIZE 0x4000
 
+/* With incremental compaction the pages are split into two banks, the write
+ * log of one bank is compacted into the other one in the background. */
+#if defined(FEE_INCREMENTAL_COMPACTION)
+#    if (FEE_PAGE_COUNT % 2) == 1
+#        error emulated eeprom: FEE_INCREMENTAL_COMPACTION requires an even FEE_PAGE_COUNT
+#    endif
+#    define FEE_BANK_PAGE_COUNT (FEE_PAGE_COUNT / 2)
+#else
+#    define FEE_BANK_PAGE_COUNT FEE_PAGE_COUNT
+#endif
+
 /* Size of combined compacted eeprom and write log pages */
-#define FEE_DENSITY_MAX_SIZE (FEE_PAGE_COUNT * FEE_PAGE_SIZE)
+#define FEE_DENSITY_MAX_SIZE (FEE_BANK_PAGE_COUNT * FEE_PAGE_SIZE)
 
 #ifndef FEE_MCU_FLASH_SIZE_IGNORE_CHECK /* *TODO: Get rid of this check */
-#    if FEE_DENSITY_MAX_SIZE > (FEE_MCU_FLASH_SIZE * 1024)
-#        pragma message STR(FEE_DENSITY_MAX_SIZE) " > " STR(FEE_MCU_FLASH_SIZE * 1024)
-#        error emulated eeprom: FEE_DENSITY_MAX_SIZE is greater than available flash size
+#    if (FEE_PAGE_COUNT * FEE_PAGE_SIZE) > (FEE_MCU_FLASH_SIZE * 1024)
+#        pragma message STR(FEE_PAGE_COUNT * FEE_PAGE_SIZE) " > " STR(FEE_MCU_FLASH_SIZE * 1024)
+#        error emulated eeprom: FEE_PAGE_COUNT * FEE_PAGE_SIZE is greater than available flash size
 #    endif
 #endif
 
@@ -105,7 +116,7 @@
 #    endif
 #else
 /* Default to half of allocated space used for emulated eeprom, half for write log */
-#    define FEE_DENSITY_BYTES (FEE_PAGE_COUNT * FEE_PAGE_SIZE / 2)
+#    define FEE_DENSITY_BYTES (FEE_DENSITY_MAX_SIZE / 2)
 #endif
 
 /* Size of write log */
@@ -119,11 +130,30 @@
 #    endif
 #else
 /* Default to use all remaining space */
-#    define FEE_WRITE_LOG_BYTES (FEE_PAGE_COUNT * FEE_PAGE_SIZE - FEE_DENSITY_BYTES)
+#    define FEE_WRITE_LOG_BYTES (FEE_DENSITY_MAX_SIZE - FEE_DENSITY_BYTES)
+#endif
+
+#if defined(FEE_INCREMENTAL_COMPACTION)
+/* Free write log space in bytes at which the next compaction starts */
+#    ifndef FEE_COMPACTION_LOW_WATER
+#        define FEE_COMPACTION_LOW_WATER (FEE_WRITE_LOG_BYTES / 4)
+#    endif
+/* Words copied into the other bank per eeprom_driver_task() call */
+#    ifndef FEE_COMPACTION_STEP_WORDS
+#        define FEE_COMPACTION_STEP_WORDS 32
+#    endif
+/* Page erases stall the CPU (F4 sectors for hundreds of ms), they wait for this long without input */
+#    ifndef FEE_COMPACTION_ERASE_IDLE_MS
+#        define FEE_COMPACTION_ERASE_IDLE_MS 1000
+#    endif
+/* Start of the bank in use, selected at runtime by eeprom_stm32.c */
+#    define FEE_BANK_BASE_ADDRESS fee_active_bank
+#else
+#    define FEE_BANK_BASE_ADDRESS FEE_PAGE_BASE_ADDRESS
 #endif
 
 /* Start of the emulated eeprom compacted flash area */
-#define FEE_COMPACTED_BASE_ADDRESS FEE_PAGE_BASE_ADDRESS
+#define FEE_COMPACTED_BASE_ADDRESS FEE_BANK_BASE_ADDRESS
 /* End of the emulated eeprom compacted flash area */
 #define FEE_COMPACTED_LAST_ADDRESS (FEE_COMPACTED_BASE_ADDRESS + FEE_DENSITY_BYTES)
 /* Start of the emulated eeprom write log */
@@ -105,3 +105,12 @@ uint16_t timer_elapsed(uint16_t last) {
 uint32_t timer_elapsed32(uint32_t last) {
     return TIMER_DIFF_32(timer_read32(), last);
 }
+
+// Only as precise as the system tick, CH_CFG_ST_FREQUENCY
+uint32_t timer_read_us32(void) {
+    chSysLock();
+    uint32_t ticks = get_system_time_ticks() - ticks_offset;
+    chSysUnlock();
+
+    return (uint32_t)TIME_I2US(ticks);
+}
@@ -0,0 +1,264 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "eeprom.h"
+#include "eeprom_driver.h"
+}
+
+/* Mock Flash Parameters:
+ *
+ * flash size: 65536
+ * page size: 2048
+ * density pages: 16, 8 per bank
+ * Simulated EEPROM size: 8192
+ *
+ * FlashBuf Layout:
+ * [Unused | Bank 0 Compact | Bank 0 Log | Bank 1 Compact | Bank 1 Log ]
+ * [0......|32768..........|40960......|49152..........|57344...65535]
+ *
+ */
+
+#define LOG_SIZE EEPROM_SIZE
+#define BANK_SIZE (EEPROM_SIZE + LOG_SIZE)
+#define BANK0 (MOCK_FLASH_SIZE - 2 * BANK_SIZE)
+#define BANK1 (MOCK_FLASH_SIZE - BANK_SIZE)
+#define MARKER(bank) (*(uint16_t*)&FlashBuf[(bank) + EEPROM_SIZE])
+
+/* Compaction defaults from eeprom_stm32_defs.h */
+#define BANK_PAGES (FEE_PAGE_COUNT / 2)
+#define LOW_WATER (LOG_SIZE / 4)
+#define STEP_WORDS 32
+#define ERASE_IDLE_MS 1000
+
+/* Mocked keyboard input activity, the compaction only erases while idle */
+static uint32_t input_idle_ms;
+
+extern "C" uint32_t last_input_activity_elapsed(void) {
+    return input_idle_ms;
+}
+
+class EepromStm32IncrementalTest : public testing::Test {
+   public:
+    EepromStm32IncrementalTest() {}
+    ~EepromStm32IncrementalTest() {}
+
+   protected:
+    void SetUp() override {
+        input_idle_ms = ERASE_IDLE_MS;
+        EEPROM_Erase();
+    }
+
+    EEPROM_WearStats stats(void) {
+        EEPROM_WearStats stats;
+        EEPROM_GetWearStats(&stats);
+        return stats;
+    }
+
+    /* Fill the write log up to the low-water mark, returns the last value written */
+    uint16_t fillLog(uint16_t* address) {
+        uint16_t value = 0x1000;
+        eeprom_write_word(address, value);
+        while (stats().log_used < LOG_SIZE - LOW_WATER) {
+            eeprom_write_word(address, ++value);
+        }
+        return value;
+    }
+
+    /* Run eeprom_driver_task() until the pending compaction is done */
+    int runCompaction(void) {
+        uint32_t compactions = stats().compactions;
+        int      steps       = 0;
+        while (stats().compactions == compactions && steps < 10000) {
+            eeprom_driver_task();
+            ++steps;
+        }
+        return steps;
+    }
+};
+
+TEST_F(EepromStm32IncrementalTest, TestNoCompactionAboveLowWater) {
+    eeprom_write_dword((uint32_t*)0x200, 0xdeadbeef);
+    eeprom_write_dword((uint32_t*)0x200, 0xcafef00d);
+    EEPROM_WearStats before = stats();
+    for (int i = 0; i < 100; ++i) {
+        eeprom_driver_task();
+    }
+    EXPECT_EQ(stats().page_erases, before.page_erases);
+    EXPECT_EQ(stats().compactions, before.compactions);
+}
+
+TEST_F(EepromStm32IncrementalTest, TestBackgroundCompaction) {
+    eeprom_write_dword((uint32_t*)0x10, 0xdeadbeef);
+    eeprom_write_byte((uint8_t*)0x40, 0x3c);
+    eeprom_write_word((uint16_t*)(EEPROM_SIZE - 2), 0xd00d);
+
+    /* None of the writes may erase anything */
+    EEPROM_WearStats before = stats();
+    uint16_t         value  = fillLog((uint16_t*)0x300);
+    EXPECT_EQ(stats().page_erases, before.page_erases);
+    EXPECT_EQ(stats().compactions, before.compactions);
+
+    /* Copying takes many small steps */
+    EXPECT_GT(runCompaction(), EEPROM_SIZE / 2 / STEP_WORDS);
+    EXPECT_EQ(stats().compactions, before.compactions + 1);
+    EXPECT_EQ(MARKER(BANK1), 0xFFC0);
+    EXPECT_EQ(stats().log_used, 0);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[BANK1 + 0x300], (uint16_t)~value);
+
+    EEPROM_Init();
+    EXPECT_EQ(eeprom_read_dword((uint32_t*)0x10), 0xdeadbeef);
+    EXPECT_EQ(eeprom_read_byte((uint8_t*)0x40), 0x3c);
+    EXPECT_EQ(eeprom_read_word((uint16_t*)(EEPROM_SIZE - 2)), 0xd00d);
+    EXPECT_EQ(eeprom_read_word((uint16_t*)0x300), value);
+
+    /* New writes go to the log of the new bank, after the marker */
+    eeprom_write_word((uint16_t*)0x300, 0x4242);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[BANK1 + EEPROM_SIZE + 2], 0xE000 | ((0x300 - 0x80) >> 1));
+    EEPROM_Init();
+    EXPECT_EQ(eeprom_read_word((uint16_t*)0x300), 0x4242);
+}
+
+TEST_F(EepromStm32IncrementalTest, TestEraseWaitsForIdle) {
+    uint16_t value = fillLog((uint16_t*)0x300);
+
+    /* No erase while typing */
+    input_idle_ms           = ERASE_IDLE_MS - 1;
+    EEPROM_WearStats before = stats();
+    for (int i = 0; i < 100; ++i) {
+        eeprom_driver_task();
+    }
+    EXPECT_EQ(stats().page_erases, before.page_erases);
+
+    /* Writes still go to the log in the meantime */
+    eeprom_write_word((uint16_t*)0x300, ++value);
+    EXPECT_EQ(eeprom_read_word((uint16_t*)0x300), value);
+
+    input_idle_ms = ERASE_IDLE_MS;
+    runCompaction();
+    EXPECT_EQ(stats().compactions, before.compactions + 1);
+    EEPROM_Init();
+    EXPECT_EQ(eeprom_read_word((uint16_t*)0x300), value);
+}
+
+TEST_F(EepromStm32IncrementalTest, TestWritesDuringCompaction) {
+    eeprom_write_word((uint16_t*)0x20, 0x1111);
+    eeprom_write_word((uint16_t*)0x800, 0x2222);
+    eeprom_write_word((uint16_t*)0x1800, 0x3333);
+    fillLog((uint16_t*)0x300);
+
+    /* Erase the target bank and copy the first half */
+    uint32_t compactions = stats().compactions;
+    for (int i = 0; i < BANK_PAGES + (EEPROM_SIZE / 4) / STEP_WORDS; ++i) {
+        eeprom_driver_task();
+    }
+    EXPECT_EQ(stats().compactions, compactions);
+
+    /* Already copied */
+    eeprom_write_word((uint16_t*)0x20, 0x4444);
+    eeprom_write_word((uint16_t*)0x800, 0x5555);
+    eeprom_write_byte((uint8_t*)0x801, 0x00);
+    /* Not copied yet */
+    eeprom_write_word((uint16_t*)0x1800, 0x6666);
+
+    runCompaction();
+    EXPECT_EQ(MARKER(BANK1), 0xFFC0);
+
+    EEPROM_Init();
+    EXPECT_EQ(eeprom_read_word((uint16_t*)0x20), 0x4444);
+    EXPECT_EQ(eeprom_read_word((uint16_t*)0x800), 0x0055);
+    EXPECT_EQ(eeprom_read_word((uint16_t*)0x1800), 0x6666);
+}
+
+TEST_F(EepromStm32IncrementalTest, TestPowerLossDuringCompaction) {
+    eeprom_write_dword((uint32_t*)0x100, 0x12345678);
+    uint16_t value = fillLog((uint16_t*)0x300);
+    for (int i = 0; i < BANK_PAGES + 10; ++i) {
+        eeprom_driver_task();
+    }
+
+    /* Reboot with a half written target bank, the old bank stays in use */
+    EEPROM_Init();
+    EXPECT_EQ(MARKER(BANK1), 0xFFFF);
+    EXPECT_EQ(eeprom_read_dword((uint32_t*)0x100), 0x12345678);
+    EXPECT_EQ(eeprom_read_word((uint16_t*)0x300), value);
+
+    /* The compaction starts over and succeeds */
+    eeprom_write_word((uint16_t*)0x300, 0x4242);
+    runCompaction();
+    EXPECT_EQ(MARKER(BANK1), 0xFFC0);
+    EEPROM_Init();
+    EXPECT_EQ(eeprom_read_dword((uint32_t*)0x100), 0x12345678);
+    EXPECT_EQ(eeprom_read_word((uint16_t*)0x300), 0x4242);
+}
+
+TEST_F(EepromStm32IncrementalTest, TestLogFullDuringCompaction) {
+    eeprom_write_dword((uint32_t*)0x100, 0x12345678);
+    uint16_t value = fillLog((uint16_t*)0x300);
+    for (int i = 0; i < BANK_PAGES + 10; ++i) {
+        eeprom_driver_task();
+    }
+
+    /* Keep writing until the log overflows, which finishes the compaction on the spot */
+    uint32_t compactions = stats().compactions;
+    while (stats().compactions == compactions) {
+        eeprom_write_word((uint16_t*)0x300, ++value);
+    }
+    eeprom_write_word((uint16_t*)0x300, ++value);
+
+    EEPROM_Init();
+    EXPECT_EQ(MARKER(BANK1), 0xFFC0);
+    EXPECT_EQ(eeprom_read_dword((uint32_t*)0x100), 0x12345678);
+    EXPECT_EQ(eeprom_read_word((uint16_t*)0x300), value);
+}
+
+TEST_F(EepromStm32IncrementalTest, TestLargeChangeDuringCompaction) {
+    uint8_t data[EEPROM_SIZE / 2], readback[EEPROM_SIZE / 2];
+    memset(data, 0x11, sizeof(data));
+    eeprom_write_block(data, (void*)0, sizeof(data));
+    fillLog((uint16_t*)(EEPROM_SIZE - 2));
+    runCompaction();
+    fillLog((uint16_t*)(EEPROM_SIZE - 2));
+
+    /* Copy everything, then change more than the new log can carry over */
+    for (int i = 0; i < BANK_PAGES + EEPROM_SIZE / 2 / STEP_WORDS - 1; ++i) {
+        eeprom_driver_task();
+    }
+    for (uint16_t i = 0; i < sizeof(data); ++i) {
+        data[i] = i * 7;
+    }
+    eeprom_write_block(data, (void*)0, sizeof(data));
+
+    EEPROM_Init();
+    EXPECT_EQ(MARKER(BANK0), 0xFFC1);
+    eeprom_read_block(readback, (void*)0, sizeof(readback));
+    EXPECT_EQ(memcmp(readback, data, sizeof(data)), 0);
+}
+
+TEST_F(EepromStm32IncrementalTest, TestGenerationWrap) {
+    for (uint16_t i = 0; i < 70; ++i) {
+        eeprom_write_word((uint16_t*)0x100, i);
+        fillLog((uint16_t*)0x300);
+        runCompaction();
+        EEPROM_Init();
+        ASSERT_EQ(eeprom_read_word((uint16_t*)0x100), i);
+    }
+    /* Generations count modulo 63, the first compaction goes to bank 1 */
+    EXPECT_EQ(MARKER(BANK1) & 0x3F, 68 % 63);
+    EXPECT_EQ(MARKER(BANK0) & 0x3F, 69 % 63);
+}
@@ -53,6 +53,9 @@ extern "C" {
 #define WORD_ZERO(addr) (0x8000 | ((addr) >> 1))
 #define WORD_ONE(addr) (0xA000 | ((addr) >> 1))
 #define WORD_NEXT(addr) (0xE000 | (((addr)-0x80) >> 1))
+#define BLOCK_HEADER(words) (0xC000 | ((words)-1))
+#define BLOCK_HEADER_MASK 0xE01F
+#define BLOCK_ODD 0x4000
 
 class EepromStm32Test : public testing::Test {
    public:
@@ -435,3 +438,130 @@ TEST_F(EepromStm32Test, TestCompaction) {
     EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE], 0xFFFF);
     EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + LOG_SIZE - 2], 0xFFFF);
 }
+
+TEST_F(EepromStm32Test, TestWriteBlock) {
+    uint8_t initial[16], updated[16], readback[16];
+    for (uint8_t i = 0; i < sizeof(initial); i++) {
+        initial[i] = 0x10 + i;
+        updated[i] = 0xF0 - i;
+    }
+    /* First write goes directly to the compacted area */
+    eeprom_write_block(initial, (void*)0xA0, sizeof(initial));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[EEPROM_BASE + 0xA0], (uint16_t)~0x1110);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE], 0xFFFF);
+    /* Second write becomes a single block entry */
+    eeprom_write_block(updated, (void*)0xA0, sizeof(updated));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE] & BLOCK_HEADER_MASK, BLOCK_HEADER(8));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 2], 0xA0);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 4], (uint16_t)~0xEFF0);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 18], (uint16_t)~0xE1E2);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 20], 0xFFFF);
+    /* Replay */
+    EEPROM_Init();
+    eeprom_read_block(readback, (void*)0xA0, sizeof(readback));
+    EXPECT_EQ(memcmp(readback, updated, sizeof(updated)), 0);
+}
+
+TEST_F(EepromStm32Test, TestWriteBlockOddLength) {
+    uint8_t initial[7] = {1, 2, 3, 4, 5, 6, 7};
+    uint8_t updated[7] = {11, 12, 13, 14, 15, 16, 17};
+    uint8_t readback[9];
+    eeprom_write_block(initial, (void*)0x85, sizeof(initial));
+    eeprom_write_block(updated, (void*)0x85, sizeof(updated));
+    /* Unaligned blocks are widened to whole words */
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE] & BLOCK_HEADER_MASK, BLOCK_HEADER(4));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 2], 0x84);
+    EEPROM_Init();
+    eeprom_read_block(readback, (void*)0x84, sizeof(readback));
+    EXPECT_EQ(readback[0], 0);
+    EXPECT_EQ(memcmp(&readback[1], updated, sizeof(updated)), 0);
+    EXPECT_EQ(readback[8], 0);
+}
+
+TEST_F(EepromStm32Test, TestWriteBlockSmallChange) {
+    uint8_t data[8] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+    eeprom_write_block(data, (void*)0x90, sizeof(data));
+    /* A single changed word is cheaper as a word entry */
+    data[4] = 0x99;
+    eeprom_write_block(data, (void*)0x90, sizeof(data));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE], WORD_NEXT(0x94));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 2], (uint16_t)~0x6699);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 4], 0xFFFF);
+    /* So are low addresses with few changed bytes */
+    eeprom_write_block(data, (void*)0x10, sizeof(data));
+    data[0] = 0x42;
+    eeprom_write_block(data, (void*)0x10, sizeof(data));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 4], BYTE_VALUE(0x10, 0x42));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 6], 0xFFFF);
+}
+
+TEST_F(EepromStm32Test, TestWriteBlockIncomplete) {
+    uint8_t initial[12], updated[12], readback[12];
+    for (uint8_t i = 0; i < sizeof(initial); i++) {
+        initial[i] = 0x30 + i;
+        updated[i] = 0x60 + i;
+    }
+    eeprom_write_block(initial, (void*)0x40, sizeof(initial));
+    eeprom_write_block(updated, (void*)0x40, sizeof(updated));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE] & BLOCK_HEADER_MASK, BLOCK_HEADER(6));
+    /* Simulate power loss before the last data word was programmed */
+    *(uint16_t*)&FlashBuf[LOG_BASE + 14] = 0xFFFF;
+    EEPROM_Init();
+    eeprom_read_block(readback, (void*)0x40, sizeof(readback));
+    EXPECT_EQ(memcmp(readback, initial, sizeof(initial)), 0);
+    /* The broken block is skipped, new entries go after it */
+    eeprom_write_word((uint16_t*)0x80, 0x1234);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 16], 0xFFFF);
+    eeprom_write_word((uint16_t*)0x80, 0x5678);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 16], WORD_NEXT(0x80));
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE + 18], (uint16_t)~0x5678);
+    EEPROM_Init();
+    EXPECT_EQ(eeprom_read_word((uint16_t*)0x80), 0x5678);
+}
+
+TEST_F(EepromStm32Test, TestBlockCompaction) {
+    uint8_t data[40], readback[40];
+    for (uint8_t i = 0; i < sizeof(data); i++) {
+        data[i] = i + 1;
+    }
+    eeprom_write_block(data, (void*)0x20, sizeof(data));
+    /* Each block entry takes 2 header words and 20 data words */
+    for (uint32_t i = 0; i < LOG_SIZE / 44 + 1; i++) {
+        for (uint8_t j = 0; j < sizeof(data); j++) {
+            data[j] += 3;
+        }
+        eeprom_write_block(data, (void*)0x20, sizeof(data));
+    }
+    EEPROM_Init();
+    eeprom_read_block(readback, (void*)0x20, sizeof(readback));
+    EXPECT_EQ(memcmp(readback, data, sizeof(data)), 0);
+    /* Last write didn't fit and compacted the log */
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[LOG_BASE], 0xFFFF);
+    EXPECT_EQ(*(uint16_t*)&FlashBuf[EEPROM_BASE + 0x20], (uint16_t)~(data[0] | (data[1] << 8)));
+}
+
+TEST_F(EepromStm32Test, TestWearStats) {
+    EEPROM_WearStats before, after;
+    uint8_t          data[16] = {0};
+    EEPROM_GetWearStats(&before);
+    EXPECT_EQ(before.log_used, 0);
+    EXPECT_EQ(before.log_size, LOG_SIZE);
+
+    memset(data, 0x5a, sizeof(data));
+    eeprom_write_block(data, (void*)0x80, sizeof(data));
+    memset(data, 0xa5, sizeof(data));
+    eeprom_write_block(data, (void*)0x80, sizeof(data));
+    EEPROM_GetWearStats(&after);
+    EXPECT_EQ(after.direct_writes - before.direct_writes, 8);
+    EXPECT_EQ(after.log_writes - before.log_writes, 10);
+    EXPECT_EQ(after.log_used, 20);
+    EXPECT_EQ(after.compactions, before.compactions);
+
+    /* Fill the log until it compacts */
+    for (uint32_t i = 0; i < LOG_SIZE / 4; i++) {
+        eeprom_write_word((uint16_t*)0x80, 0x1000 + i);
+    }
+    EEPROM_GetWearStats(&after);
+    EXPECT_EQ(after.compactions - before.compactions, 1);
+    EXPECT_LT(after.log_used, LOG_SIZE);
+}
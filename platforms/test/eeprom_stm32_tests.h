@@ -5,4 +5,8 @@
 #include "flash_stm32.h"
 #include "eeprom_stm32.h"
 
-#define EEPROM_SIZE (FEE_PAGE_SIZE * FEE_PAGE_COUNT / 2)
+#if defined(FEE_INCREMENTAL_COMPACTION)
+#    define EEPROM_SIZE (FEE_PAGE_SIZE * FEE_PAGE_COUNT / 4)
+#else
+#    define EEPROM_SIZE (FEE_PAGE_SIZE * FEE_PAGE_COUNT / 2)
+#endif
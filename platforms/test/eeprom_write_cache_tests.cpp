@@ -0,0 +1,209 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "eeprom.h"
+#include "eeprom_driver.h"
+
+void advance_time(uint32_t ms);
+}
+
+/* Cache parameters from rules.mk */
+#define LINE_SIZE EEPROM_WRITE_CACHE_LINE_SIZE
+#define TIMEOUT EEPROM_WRITE_CACHE_TIMEOUT
+#define MAX_DELAY EEPROM_WRITE_CACHE_MAX_DELAY
+
+/* Mocked driver, records every block written to the backing store */
+struct driver_write {
+    uintptr_t offset;
+    size_t    length;
+};
+
+static uint8_t                   backing[8 * LINE_SIZE];
+static std::vector<driver_write> driver_writes;
+
+extern "C" {
+void eeprom_driver_init(void) {}
+
+void eeprom_driver_erase(void) {
+    memset(backing, 0x00, sizeof(backing));
+}
+
+void eeprom_driver_read_block(void *buf, const void *addr, size_t len) {
+    memcpy(buf, &backing[(uintptr_t)addr], len);
+}
+
+void eeprom_driver_write_block(const void *buf, void *addr, size_t len) {
+    memcpy(&backing[(uintptr_t)addr], buf, len);
+    driver_writes.push_back({(uintptr_t)addr, len});
+}
+}
+
+class EepromWriteCacheTest : public testing::Test {
+   public:
+    EepromWriteCacheTest() {}
+    ~EepromWriteCacheTest() {}
+
+   protected:
+    /* Time keeps running across tests, the deferred executor ignores a clock going backwards */
+    void SetUp() override {
+        eeprom_driver_discard();
+        for (size_t i = 0; i < sizeof(backing); i++) {
+            backing[i] = i;
+        }
+        driver_writes.clear();
+    }
+
+    /* Let the deferred flush run, the task only acts once per millisecond */
+    void runTask(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            advance_time(1);
+            eeprom_driver_task();
+        }
+    }
+};
+
+TEST_F(EepromWriteCacheTest, TestReadAfterWrite) {
+    eeprom_write_dword((uint32_t *)0x04, 0xdeadbeef);
+    EXPECT_EQ(driver_writes.size(), 0);
+    EXPECT_EQ(backing[0x04], 0x04);
+
+    /* Reads see the cached data, including the untouched bytes of the line */
+    EXPECT_EQ(eeprom_read_dword((uint32_t *)0x04), 0xdeadbeef);
+    EXPECT_EQ(eeprom_read_byte((uint8_t *)0x03), 0x03);
+    EXPECT_EQ(eeprom_read_byte((uint8_t *)0x08), 0x08);
+
+    /* A read across two lines mixes cached and driver data */
+    uint8_t buf[4];
+    eeprom_read_block(buf, (void *)(LINE_SIZE - 2), sizeof(buf));
+    EXPECT_EQ(buf[0], LINE_SIZE - 2);
+    EXPECT_EQ(buf[2], LINE_SIZE);
+
+    eeprom_write_byte((uint8_t *)(LINE_SIZE - 1), 0x42);
+    eeprom_read_block(buf, (void *)(LINE_SIZE - 2), sizeof(buf));
+    EXPECT_EQ(buf[1], 0x42);
+    EXPECT_EQ(driver_writes.size(), 0);
+}
+
+TEST_F(EepromWriteCacheTest, TestUnchangedWriteStaysClean) {
+    eeprom_write_byte((uint8_t *)0x05, 0x05);
+    eeprom_driver_flush();
+    EXPECT_EQ(driver_writes.size(), 0);
+}
+
+TEST_F(EepromWriteCacheTest, TestOverlappingSpans) {
+    eeprom_write_dword((uint32_t *)0x04, 0x11111111);
+    eeprom_write_dword((uint32_t *)0x06, 0x22222222);
+    eeprom_driver_flush();
+
+    ASSERT_EQ(driver_writes.size(), 1);
+    EXPECT_EQ(driver_writes[0].offset, 0x04);
+    EXPECT_EQ(driver_writes[0].length, 6);
+    EXPECT_EQ(backing[0x05], 0x11);
+    EXPECT_EQ(backing[0x06], 0x22);
+    EXPECT_EQ(backing[0x09], 0x22);
+    EXPECT_EQ(backing[0x0A], 0x0A);
+}
+
+TEST_F(EepromWriteCacheTest, TestAdjacentSpans) {
+    eeprom_write_word((uint16_t *)0x06, 0x3333);
+    eeprom_write_word((uint16_t *)0x04, 0x4444);
+    eeprom_write_byte((uint8_t *)0x0C, 0x55);
+    eeprom_driver_flush();
+
+    /* One write covers both spans, the gap is written back unchanged */
+    ASSERT_EQ(driver_writes.size(), 1);
+    EXPECT_EQ(driver_writes[0].offset, 0x04);
+    EXPECT_EQ(driver_writes[0].length, 9);
+    EXPECT_EQ(backing[0x04], 0x44);
+    EXPECT_EQ(backing[0x07], 0x33);
+    EXPECT_EQ(backing[0x08], 0x08);
+    EXPECT_EQ(backing[0x0B], 0x0B);
+    EXPECT_EQ(backing[0x0C], 0x55);
+}
+
+TEST_F(EepromWriteCacheTest, TestEvictDirtyLine) {
+    /* Fill every line, the first one is the least recently used */
+    for (int i = 0; i < EEPROM_WRITE_CACHE_LINES; i++) {
+        eeprom_write_byte((uint8_t *)(i * LINE_SIZE + 1), 0xA0 + i);
+    }
+    eeprom_read_byte((uint8_t *)(1 * LINE_SIZE));
+    EXPECT_EQ(driver_writes.size(), 0);
+
+    /* A new line takes over the first one, which is written out first */
+    eeprom_write_byte((uint8_t *)(EEPROM_WRITE_CACHE_LINES * LINE_SIZE), 0xB0);
+    ASSERT_EQ(driver_writes.size(), 1);
+    EXPECT_EQ(driver_writes[0].offset, 1);
+    EXPECT_EQ(driver_writes[0].length, 1);
+    EXPECT_EQ(backing[1], 0xA0);
+
+    /* The evicted data is read back from the driver */
+    EXPECT_EQ(eeprom_read_byte((uint8_t *)1), 0xA0);
+    EXPECT_EQ(eeprom_read_byte((uint8_t *)(EEPROM_WRITE_CACHE_LINES * LINE_SIZE)), 0xB0);
+
+    eeprom_driver_flush();
+    EXPECT_EQ(driver_writes.size(), EEPROM_WRITE_CACHE_LINES + 1);
+    for (int i = 1; i < EEPROM_WRITE_CACHE_LINES; i++) {
+        EXPECT_EQ(backing[i * LINE_SIZE + 1], 0xA0 + i);
+    }
+}
+
+TEST_F(EepromWriteCacheTest, TestFlush) {
+    eeprom_write_word((uint16_t *)0x02, 0x1234);
+    eeprom_write_word((uint16_t *)(LINE_SIZE + 2), 0x5678);
+
+    /* As done before jumping to the bootloader or on suspend */
+    eeprom_driver_flush();
+    EXPECT_EQ(driver_writes.size(), 2);
+    EXPECT_EQ(backing[0x02], 0x34);
+    EXPECT_EQ(backing[LINE_SIZE + 3], 0x56);
+
+    /* Nothing left to write, and the pending timed flush is gone */
+    eeprom_driver_flush();
+    runTask(MAX_DELAY);
+    EXPECT_EQ(driver_writes.size(), 2);
+}
+
+TEST_F(EepromWriteCacheTest, TestFlushAfterTimeout) {
+    eeprom_write_byte((uint8_t *)0x02, 0x77);
+    runTask(TIMEOUT - 1);
+    EXPECT_EQ(driver_writes.size(), 0);
+    runTask(1);
+    EXPECT_EQ(driver_writes.size(), 1);
+    EXPECT_EQ(backing[0x02], 0x77);
+}
+
+TEST_F(EepromWriteCacheTest, TestFlushAfterMaxDelay) {
+    /* Writes keep pushing the flush back, but not beyond the maximum delay */
+    for (uint32_t elapsed = 0; elapsed < MAX_DELAY; elapsed += TIMEOUT / 2) {
+        eeprom_write_byte((uint8_t *)0x02, elapsed / (TIMEOUT / 2));
+        runTask(TIMEOUT / 2);
+    }
+    EXPECT_GE(driver_writes.size(), 1);
+}
+
+TEST_F(EepromWriteCacheTest, TestDiscard) {
+    eeprom_write_byte((uint8_t *)0x02, 0x77);
+    eeprom_driver_discard();
+    eeprom_driver_flush();
+    EXPECT_EQ(driver_writes.size(), 0);
+    EXPECT_EQ(eeprom_read_byte((uint8_t *)0x02), 0x02);
+}
@@ -9,11 +9,16 @@ eeprom_stm32_large_DEFS := $(eeprom_stm32_DEFS) \
 	-DMOCK_FLASH_SIZE=65536 \
 	-DFEE_PAGE_SIZE=2048 \
 	-DFEE_PAGE_COUNT=16
+eeprom_stm32_incremental_DEFS := $(eeprom_stm32_large_DEFS) \
+	-DFEE_INCREMENTAL_COMPACTION
 
 eeprom_stm32_INC := \
 	$(PLATFORM_PATH)/chibios/
 eeprom_stm32_tiny_INC := $(eeprom_stm32_INC)
 eeprom_stm32_large_INC := $(eeprom_stm32_INC)
+eeprom_stm32_incremental_INC := \
+	$(eeprom_stm32_INC) \
+	$(TOP_DIR)/drivers/eeprom/
 
 eeprom_stm32_SRC := \
 	$(TOP_DIR)/drivers/eeprom/eeprom_driver.c \
@@ -22,3 +27,35 @@ eeprom_stm32_SRC := \
 	$(PLATFORM_PATH)/chibios/eeprom_stm32.c
 eeprom_stm32_tiny_SRC := $(eeprom_stm32_SRC)
 eeprom_stm32_large_SRC := $(eeprom_stm32_SRC)
+eeprom_stm32_incremental_SRC := \
+	$(TOP_DIR)/drivers/eeprom/eeprom_driver.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/eeprom_stm32_incremental_tests.cpp \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/flash_stm32_mock.c \
+	$(PLATFORM_PATH)/chibios/eeprom_stm32.c
+
+eeprom_write_cache_DEFS := \
+	-DEEPROM_TEST_HARNESS \
+	-DEEPROM_WRITE_CACHE_ENABLE \
+	-DEEPROM_WRITE_CACHE_LINES=2 \
+	-DEEPROM_WRITE_CACHE_LINE_SIZE=16 \
+	-DEEPROM_WRITE_CACHE_TIMEOUT=100 \
+	-DEEPROM_WRITE_CACHE_MAX_DELAY=500
+
+eeprom_write_cache_INC := \
+	$(TOP_DIR)/drivers/eeprom/
+
+eeprom_write_cache_SRC := \
+	$(TOP_DIR)/drivers/eeprom/eeprom_driver.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/eeprom_write_cache_tests.cpp \
+	$(QUANTUM_PATH)/deferred_exec.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
+
+serial_usart_link_INC := \
+	$(PLATFORM_PATH)/chibios/drivers/
+
+serial_usart_link_SRC := \
+	$(QUANTUM_PATH)/crc.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/serial_usart_link_tests.cpp \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/serial_usart_link_mock.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/serial_usart_link_slave.c \
+	$(PLATFORM_PATH)/chibios/drivers/serial_usart_link.c
@@ -0,0 +1,219 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Simulated half-duplex link between two instances of the link state machine.
+ *
+ * Frames sent at speeds above the "reliable" speed get bit errors injected,
+ * frames sent while both halves disagree on the speed arrive as garbage.
+ */
+
+#include <string.h>
+#include "serial_usart_link_mock.h"
+#include "crc.h"
+
+#define QUEUE_SIZE 256
+#define TRANSACTION_TOKEN 0x01
+#define TRANSACTION_SIZE 8
+
+bool usart_link_slave_send(const uint8_t *source, size_t size);
+bool usart_link_slave_react(uint8_t command);
+void usart_link_slave_report(bool success);
+
+typedef struct {
+    uint8_t data[QUEUE_SIZE];
+    size_t  length;
+    size_t  head;
+} queue_t;
+
+static queue_t  to_slave;
+static queue_t  to_master;
+static uint32_t master_speed;
+static uint32_t slave_speed;
+static uint32_t reliable;
+static bool     connected;
+static uint32_t settle_time;
+static uint32_t rng_state;
+
+static uint8_t rng(void) {
+    rng_state = rng_state * 1103515245 + 12345;
+    return (uint8_t)(rng_state >> 16);
+}
+
+static void queue_clear(queue_t *queue) {
+    queue->length = 0;
+    queue->head   = 0;
+}
+
+static void queue_push(queue_t *queue, uint8_t byte) {
+    if (queue->length < QUEUE_SIZE) {
+        queue->data[queue->length++] = byte;
+    }
+}
+
+static bool queue_pop(queue_t *queue, uint8_t *destination, size_t size) {
+    if (queue->length - queue->head < size) {
+        queue_clear(queue);
+        return false;
+    }
+    memcpy(destination, &queue->data[queue->head], size);
+    queue->head += size;
+    if (queue->head == queue->length) {
+        queue_clear(queue);
+    }
+    return true;
+}
+
+static void transfer(queue_t *queue, const uint8_t *source, size_t size, uint32_t tx_speed, uint32_t rx_speed) {
+    if (!connected) {
+        return;
+    }
+
+    if (tx_speed != rx_speed) {
+        /* Mismatched baud rates, the receiver samples garbage. */
+        size_t count = (size * rx_speed) / tx_speed;
+        for (size_t i = 0; i < (count ? count : 1); i++) {
+            queue_push(queue, rng());
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        uint8_t byte = source[i];
+        /* Roughly one corrupted byte in eight above the reliable speed. */
+        if (tx_speed > reliable && (rng() & 0x07) == 0) {
+            byte ^= 1 << (rng() & 0x07);
+        }
+        queue_push(queue, byte);
+    }
+}
+
+/**
+ * @brief Run the slave until it consumed everything the master sent.
+ */
+static void slave_process(void) {
+    uint8_t token;
+
+    while (queue_pop(&to_slave, &token, 1)) {
+        bool success;
+
+        if (usart_link_is_command(token)) {
+            success = usart_link_slave_react(token);
+        } else if (token == TRANSACTION_TOKEN) {
+            uint8_t buffer[TRANSACTION_SIZE + 1];
+            success = queue_pop(&to_slave, buffer, sizeof(buffer)) && buffer[TRANSACTION_SIZE] == crc8(buffer, TRANSACTION_SIZE);
+            if (success) {
+                usart_link_slave_send(buffer, sizeof(buffer));
+            }
+        } else {
+            success = false;
+        }
+
+        usart_link_slave_report(success);
+        if (!success) {
+            queue_clear(&to_slave);
+        }
+    }
+    queue_clear(&to_slave);
+}
+
+bool usart_link_send(const uint8_t *source, size_t size) {
+    transfer(&to_slave, source, size, master_speed, slave_speed);
+    slave_process();
+    return true;
+}
+
+bool usart_link_receive(uint8_t *destination, size_t size) {
+    return queue_pop(&to_master, destination, size);
+}
+
+void usart_link_set_speed(uint32_t speed) {
+    master_speed = speed;
+}
+
+void usart_link_settle(uint16_t timeout_ms) {
+    uint16_t slave_timeout = usart_link_slave_receive_timeout();
+
+    settle_time += timeout_ms;
+    queue_clear(&to_master);
+    if (slave_timeout && timeout_ms >= slave_timeout) {
+        usart_link_slave_idle();
+    }
+}
+
+bool usart_link_slave_send(const uint8_t *source, size_t size) {
+    transfer(&to_master, source, size, slave_speed, master_speed);
+    return true;
+}
+
+bool usart_link_slave_receive(uint8_t *destination, size_t size) {
+    return queue_pop(&to_slave, destination, size);
+}
+
+void usart_link_slave_set_speed(uint32_t speed) {
+    slave_speed = speed;
+}
+
+void usart_link_slave_settle(uint16_t timeout_ms) {}
+
+void mock_link_reset(uint32_t base_speed, uint32_t reliable_speed) {
+    queue_clear(&to_slave);
+    queue_clear(&to_master);
+    master_speed = base_speed;
+    slave_speed  = base_speed;
+    reliable     = reliable_speed;
+    connected    = true;
+    settle_time  = 0;
+    rng_state    = 0x1234;
+    usart_link_init(base_speed, true);
+    usart_link_slave_init(base_speed, false);
+}
+
+void mock_link_set_reliable_speed(uint32_t reliable_speed) {
+    reliable = reliable_speed;
+}
+
+void mock_link_set_connected(bool state) {
+    connected = state;
+}
+
+/**
+ * @brief Run a regular split transaction over the link.
+ */
+bool mock_link_transaction(void) {
+    uint8_t request[TRANSACTION_SIZE + 2] = {TRANSACTION_TOKEN};
+    uint8_t reply[TRANSACTION_SIZE + 1];
+
+    for (uint8_t i = 1; i <= TRANSACTION_SIZE; i++) {
+        request[i] = rng();
+    }
+    request[TRANSACTION_SIZE + 1] = crc8(&request[1], TRANSACTION_SIZE);
+
+    usart_link_send(request, sizeof(request));
+    return usart_link_receive(reply, sizeof(reply)) && memcmp(reply, &request[1], sizeof(reply)) == 0;
+}
+
+uint32_t mock_link_master_speed(void) {
+    return master_speed;
+}
+
+uint32_t mock_link_slave_speed(void) {
+    return slave_speed;
+}
+
+uint32_t mock_link_settle_time(void) {
+    return settle_time;
+}
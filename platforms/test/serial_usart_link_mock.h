@@ -0,0 +1,34 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "serial_usart_link.h"
+
+/* Slave half, see serial_usart_link_slave.c */
+void     usart_link_slave_init(uint32_t base_speed, bool master);
+uint32_t usart_link_slave_speed(void);
+void     usart_link_slave_idle(void);
+uint16_t usart_link_slave_receive_timeout(void);
+
+/* Simulated link */
+void     mock_link_reset(uint32_t base_speed, uint32_t reliable_speed);
+void     mock_link_set_reliable_speed(uint32_t reliable_speed);
+void     mock_link_set_connected(bool connected);
+bool     mock_link_transaction(void);
+uint32_t mock_link_master_speed(void);
+uint32_t mock_link_slave_speed(void);
+uint32_t mock_link_settle_time(void);
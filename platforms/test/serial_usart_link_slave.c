@@ -0,0 +1,34 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Second instance of the link state machine, acting as the slave half of the
+ * simulated link. */
+
+#define usart_link_send usart_link_slave_send
+#define usart_link_receive usart_link_slave_receive
+#define usart_link_set_speed usart_link_slave_set_speed
+#define usart_link_settle usart_link_slave_settle
+#define usart_link_init usart_link_slave_init
+#define usart_link_speed usart_link_slave_speed
+#define usart_link_get_stats usart_link_slave_get_stats
+#define usart_link_needs_training usart_link_slave_needs_training
+#define usart_link_train usart_link_slave_train
+#define usart_link_report usart_link_slave_report
+#define usart_link_react usart_link_slave_react
+#define usart_link_idle usart_link_slave_idle
+#define usart_link_receive_timeout usart_link_slave_receive_timeout
+
+#include "serial_usart_link.c"
@@ -0,0 +1,121 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "serial_usart_link_mock.h"
+}
+
+#define BASE_SPEED 230400
+
+class SerialUsartLinkTest : public testing::Test {
+   protected:
+    void SetUp() override {
+        mock_link_reset(BASE_SPEED, 921600);
+    }
+
+    void expect_speed(uint32_t speed) {
+        EXPECT_EQ(usart_link_speed(), speed);
+        EXPECT_EQ(usart_link_slave_speed(), speed);
+        EXPECT_EQ(mock_link_master_speed(), speed);
+        EXPECT_EQ(mock_link_slave_speed(), speed);
+    }
+};
+
+TEST_F(SerialUsartLinkTest, NeedsTrainingAfterInit) {
+    EXPECT_TRUE(usart_link_needs_training());
+    expect_speed(BASE_SPEED);
+}
+
+TEST_F(SerialUsartLinkTest, NegotiatesHighestReliableSpeed) {
+    EXPECT_TRUE(usart_link_train());
+    EXPECT_FALSE(usart_link_needs_training());
+    expect_speed(921600);
+    EXPECT_TRUE(mock_link_transaction());
+}
+
+TEST_F(SerialUsartLinkTest, CleanLinkUsesFastestSpeed) {
+    mock_link_set_reliable_speed(UINT32_MAX);
+    EXPECT_TRUE(usart_link_train());
+    expect_speed(1843200);
+    EXPECT_EQ(mock_link_settle_time(), 1);
+}
+
+TEST_F(SerialUsartLinkTest, MarginalLinkStaysAtBaseSpeed) {
+    mock_link_set_reliable_speed(BASE_SPEED);
+    EXPECT_TRUE(usart_link_train());
+    expect_speed(BASE_SPEED);
+    EXPECT_TRUE(mock_link_transaction());
+}
+
+TEST_F(SerialUsartLinkTest, MissingSlaveFailsTraining) {
+    mock_link_set_connected(false);
+    EXPECT_FALSE(usart_link_train());
+    EXPECT_TRUE(usart_link_needs_training());
+
+    mock_link_set_connected(true);
+    EXPECT_TRUE(usart_link_train());
+    expect_speed(921600);
+}
+
+TEST_F(SerialUsartLinkTest, SingleErrorsDoNotRetrain) {
+    EXPECT_TRUE(usart_link_train());
+
+    for (int i = 0; i < 10; i++) {
+        for (int j = 0; j < SERIAL_USART_LINK_ERROR_BURST - 1; j++) {
+            usart_link_report(false);
+        }
+        usart_link_report(true);
+    }
+    EXPECT_FALSE(usart_link_needs_training());
+}
+
+TEST_F(SerialUsartLinkTest, RetrainsAfterErrorBurst) {
+    EXPECT_TRUE(usart_link_train());
+    expect_speed(921600);
+
+    /* Link degrades, e.g. because of a long cable and a noisy environment. */
+    mock_link_set_reliable_speed(460800);
+
+    int transactions = 0;
+    while (!usart_link_needs_training() && transactions < 100) {
+        usart_link_report(mock_link_transaction());
+        transactions++;
+    }
+    EXPECT_TRUE(usart_link_needs_training());
+
+    EXPECT_TRUE(usart_link_train());
+    expect_speed(460800);
+    for (int i = 0; i < 20; i++) {
+        EXPECT_TRUE(mock_link_transaction());
+    }
+
+    usart_link_stats_t stats;
+    usart_link_get_stats(&stats);
+    EXPECT_EQ(stats.trainings, 2);
+    EXPECT_EQ(stats.speed, 460800);
+    EXPECT_GE(stats.transaction_errors, SERIAL_USART_LINK_ERROR_BURST);
+}
+
+TEST_F(SerialUsartLinkTest, SlaveFallsBackWhenIdle) {
+    EXPECT_TRUE(usart_link_train());
+    EXPECT_EQ(usart_link_slave_receive_timeout(), SERIAL_USART_LINK_IDLE_TIMEOUT);
+
+    usart_link_slave_idle();
+    EXPECT_EQ(usart_link_slave_speed(), BASE_SPEED);
+    EXPECT_EQ(usart_link_slave_receive_timeout(), 0);
+}
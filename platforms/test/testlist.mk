@@ -1 +1,3 @@
-TEST_LIST += eeprom_stm32_tiny eeprom_stm32_large
+TEST_LIST += eeprom_stm32_tiny eeprom_stm32_large eeprom_stm32_incremental eeprom_write_cache
+
+TEST_LIST += serial_usart_link
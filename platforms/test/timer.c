@@ -38,6 +38,9 @@ uint16_t timer_elapsed(uint16_t last) {
 uint32_t timer_elapsed32(uint32_t last) {
     return TIMER_DIFF_32(timer_read32(), last);
 }
+uint32_t timer_read_us32(void) {
+    return current_time * 1000;
+}
 
 void set_time(uint32_t t) {
     current_time = t;
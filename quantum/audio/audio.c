@@ -18,6 +18,7 @@
 #include "eeconfig.h"
 #include "timer.h"
 #include "wait.h"
+#include "progmem.h"
 
 /* audio system:
  *
@@ -64,6 +65,9 @@
 #ifndef AUDIO_TONE_STACKSIZE
 #    define AUDIO_TONE_STACKSIZE 8
 #endif
+// marks the entries of 'tones' above 'active_tones', apart from 0Hz which is a pause
+#define TONE_UNUSED ((musical_tone_t){.time_started = 0, .pitch = UINT32_MAX, .duration = 0})
+
 uint8_t        active_tones = 0;            // number of tones pushed onto the stack by audio_play_tone - might be more than the hardware is able to reproduce at any single time
 musical_tone_t tones[AUDIO_TONE_STACKSIZE]; // stack of currently active tones
 
@@ -73,7 +77,8 @@ bool state_changed  = false; // global flag, which is set if anything changes wi
 
 // melody/SONG related state variables
 float (*notes_pointer)[][2];                           // SONG, an array of MUSICAL_NOTEs
-uint16_t notes_count;                                  // length of the notes_pointer array
+const song_note_t *compact_notes_pointer = NULL;       // or a compact SONG in PROGMEM, used instead of notes_pointer if set
+uint16_t           notes_count;                        // length of the notes_pointer array
 bool     notes_repeat;                                 // PLAY_SONG or PLAY_LOOP?
 uint16_t melody_current_note_duration = 0;             // duration of the currently playing note from the active melody, in ms
 uint8_t  note_tempo                   = TEMPO_DEFAULT; // beats-per-minute
@@ -95,18 +100,28 @@ extern bool     glissando;
 extern bool     vibrato;
 extern uint16_t voices_timer;
 
-#ifndef STARTUP_SONG
-#    define STARTUP_SONG SONG(STARTUP_SOUND)
-#endif
-#ifndef AUDIO_ON_SONG
-#    define AUDIO_ON_SONG SONG(AUDIO_ON_SOUND)
+// the default songs are compact ones, overriding them with a SONG of float tuples still works
+#ifdef STARTUP_SONG
+float startup_song[][2] = STARTUP_SONG;
+#    define PLAY_STARTUP_SONG() PLAY_SONG(startup_song)
+#else
+static const song_note_t PROGMEM startup_song[] = SONG(STARTUP_SOUND_COMPACT);
+#    define PLAY_STARTUP_SONG() PLAY_COMPACT_SONG(startup_song)
 #endif
-#ifndef AUDIO_OFF_SONG
-#    define AUDIO_OFF_SONG SONG(AUDIO_OFF_SOUND)
+#ifdef AUDIO_ON_SONG
+float audio_on_song[][2] = AUDIO_ON_SONG;
+#    define PLAY_AUDIO_ON_SONG() PLAY_SONG(audio_on_song)
+#else
+static const song_note_t PROGMEM audio_on_song[] = SONG(AUDIO_ON_SOUND_COMPACT);
+#    define PLAY_AUDIO_ON_SONG() PLAY_COMPACT_SONG(audio_on_song)
 #endif
-float startup_song[][2]   = STARTUP_SONG;
-float audio_on_song[][2]  = AUDIO_ON_SONG;
+#ifdef AUDIO_OFF_SONG
 float audio_off_song[][2] = AUDIO_OFF_SONG;
+#    define PLAY_AUDIO_OFF_SONG() PLAY_SONG(audio_off_song)
+#else
+static const song_note_t PROGMEM audio_off_song[] = SONG(AUDIO_OFF_SOUND_COMPACT);
+#    define PLAY_AUDIO_OFF_SONG() PLAY_COMPACT_SONG(audio_off_song)
+#endif
 
 static bool    audio_initialized    = false;
 static bool    audio_driver_stopped = true;
@@ -131,7 +146,7 @@ void audio_init() {
 #endif // EEPROM settings
 
     for (uint8_t i = 0; i < AUDIO_TONE_STACKSIZE; i++) {
-        tones[i] = (musical_tone_t){.time_started = 0, .pitch = -1.0f, .duration = 0};
+        tones[i] = TONE_UNUSED;
     }
 
     if (!audio_initialized) {
@@ -146,7 +161,7 @@ void audio_init() {
 
 void audio_startup(void) {
     if (audio_config.enable) {
-        PLAY_SONG(startup_song);
+        PLAY_STARTUP_SONG();
     }
 
     last_timestamp = timer_read();
@@ -169,11 +184,11 @@ void audio_on(void) {
     audio_config.enable = 1;
     eeconfig_update_audio(audio_config.raw);
     audio_on_user();
-    PLAY_SONG(audio_on_song);
+    PLAY_AUDIO_ON_SONG();
 }
 
 void audio_off(void) {
-    PLAY_SONG(audio_off_song);
+    PLAY_AUDIO_OFF_SONG();
     audio_off_user();
     wait_ms(100);
     audio_stop_all();
@@ -200,17 +215,13 @@ void audio_stop_all() {
     melody_current_note_duration = 0;
 
     for (uint8_t i = 0; i < AUDIO_TONE_STACKSIZE; i++) {
-        tones[i] = (musical_tone_t){.time_started = 0, .pitch = -1.0f, .duration = 0};
+        tones[i] = TONE_UNUSED;
     }
 
     audio_driver_stopped = true;
 }
 
-void audio_stop_tone(float pitch) {
-    if (pitch < 0.0f) {
-        pitch = -1 * pitch;
-    }
-
+static void stop_tone(audio_freq_t pitch) {
     if (playing_note) {
         if (!audio_initialized) {
             audio_init();
@@ -219,10 +230,10 @@ void audio_stop_tone(float pitch) {
         for (int i = AUDIO_TONE_STACKSIZE - 1; i >= 0; i--) {
             found = (tones[i].pitch == pitch);
             if (found) {
-                tones[i] = (musical_tone_t){.time_started = 0, .pitch = -1.0f, .duration = 0};
+                tones[i] = TONE_UNUSED;
                 for (int j = i; (j < AUDIO_TONE_STACKSIZE - 1); j++) {
                     tones[j]     = tones[j + 1];
-                    tones[j + 1] = (musical_tone_t){.time_started = 0, .pitch = -1.0f, .duration = 0};
+                    tones[j + 1] = TONE_UNUSED;
                 }
                 break;
             }
@@ -247,7 +258,15 @@ void audio_stop_tone(float pitch) {
     }
 }
 
-void audio_play_note(float pitch, uint16_t duration) {
+void audio_stop_tone(float pitch) {
+    if (pitch < 0.0f) {
+        pitch = -1 * pitch;
+    }
+
+    stop_tone(audio_freq_from_float(pitch));
+}
+
+static void start_tone(audio_freq_t pitch, uint16_t duration) {
     if (!audio_config.enable) {
         return;
     }
@@ -256,10 +275,6 @@ void audio_play_note(float pitch, uint16_t duration) {
         audio_init();
     }
 
-    if (pitch < 0.0f) {
-        pitch = -1 * pitch;
-    }
-
     // round-robin: shifting out old tones, keeping only unique ones
     // if the new frequency is already amongst the active tones, shift it to the top of the stack
     bool found = false;
@@ -296,11 +311,34 @@ void audio_play_note(float pitch, uint16_t duration) {
     }
 }
 
+void audio_play_note(float pitch, uint16_t duration) {
+    if (pitch < 0.0f) {
+        pitch = -1 * pitch;
+    }
+
+    start_tone(audio_freq_from_float(pitch), duration);
+}
+
 void audio_play_tone(float pitch) {
     audio_play_note(pitch, 0xffff);
 }
 
-void audio_play_melody(float (*np)[][2], uint16_t n_count, bool n_repeat) {
+// pitch and duration of a note of the playing melody
+static audio_freq_t melody_note_pitch(uint16_t index) {
+    if (compact_notes_pointer) {
+        return synth_note_frequency(SONG_NOTE_NUMBER(pgm_read_word(&compact_notes_pointer[index])));
+    }
+    return audio_freq_from_float(fabsf((*notes_pointer)[index][0]));
+}
+
+static uint16_t melody_note_duration(uint16_t index) {
+    if (compact_notes_pointer) {
+        return audio_duration_to_ms(SONG_NOTE_DURATION(pgm_read_word(&compact_notes_pointer[index])));
+    }
+    return audio_duration_to_ms((*notes_pointer)[index][1]);
+}
+
+static void start_melody(float (*np)[][2], const song_note_t *compact_notes, uint16_t n_count, bool n_repeat) {
     if (!audio_config.enable) {
         audio_stop_all();
         return;
@@ -316,17 +354,26 @@ void audio_play_melody(float (*np)[][2], uint16_t n_count, bool n_repeat) {
     playing_melody = true;
     note_resting   = false;
 
-    notes_pointer = np;
-    notes_count   = n_count;
-    notes_repeat  = n_repeat;
+    notes_pointer         = np;
+    compact_notes_pointer = compact_notes;
+    notes_count           = n_count;
+    notes_repeat          = n_repeat;
 
     current_note = 0; // note in the melody-array/list at note_pointer
 
     // start first note manually, which also starts the audio_driver
     // all following/remaining notes are played by 'audio_update_state'
-    audio_play_note((*notes_pointer)[current_note][0], audio_duration_to_ms((*notes_pointer)[current_note][1]));
-    last_timestamp               = timer_read();
-    melody_current_note_duration = audio_duration_to_ms((*notes_pointer)[current_note][1]);
+    melody_current_note_duration = melody_note_duration(current_note);
+    start_tone(melody_note_pitch(current_note), melody_current_note_duration);
+    last_timestamp = timer_read();
+}
+
+void audio_play_melody(float (*np)[][2], uint16_t n_count, bool n_repeat) {
+    start_melody(np, NULL, n_count, n_repeat);
+}
+
+void audio_play_compact_melody(const song_note_t *notes, uint16_t count, bool repeat) {
+    start_melody(NULL, notes, count, repeat);
 }
 
 float click[2][2];
@@ -363,16 +410,20 @@ uint8_t audio_get_number_of_active_tones(void) {
     return active_tones;
 }
 
-float audio_get_frequency(uint8_t tone_index) {
+audio_freq_t audio_get_frequency_fixed(uint8_t tone_index) {
     if (tone_index >= active_tones) {
-        return 0.0f;
+        return 0;
     }
     return tones[active_tones - tone_index - 1].pitch;
 }
 
-float audio_get_processed_frequency(uint8_t tone_index) {
+float audio_get_frequency(uint8_t tone_index) {
+    return audio_freq_to_float(audio_get_frequency_fixed(tone_index));
+}
+
+audio_freq_t audio_get_processed_frequency_fixed(uint8_t tone_index) {
     if (tone_index >= active_tones) {
-        return 0.0f;
+        return 0;
     }
 
     int8_t index = active_tones - tone_index - 1;
@@ -384,13 +435,17 @@ float audio_get_processed_frequency(uint8_t tone_index) {
         index += active_tones;
 #endif
 
-    if (tones[index].pitch <= 0.0f) {
-        return 0.0f;
+    if (tones[index].pitch == 0) {
+        return 0;
     }
 
     return voice_envelope(tones[index].pitch);
 }
 
+float audio_get_processed_frequency(uint8_t tone_index) {
+    return audio_freq_to_float(audio_get_processed_frequency_fixed(tone_index));
+}
+
 bool audio_update_state(void) {
     if (!playing_note && !playing_melody) {
         return false;
@@ -417,12 +472,13 @@ bool audio_update_state(void) {
                 }
             }
 
-            if (!note_resting && (*notes_pointer)[previous_note][0] == (*notes_pointer)[current_note][0]) {
+            audio_freq_t pitch = melody_note_pitch(current_note);
+            if (!note_resting && melody_note_pitch(previous_note) == pitch) {
                 note_resting = true;
 
                 // special handling for successive notes of the same frequency:
                 // insert a short pause to separate them audibly
-                audio_play_note(0.0f, audio_duration_to_ms(2));
+                start_tone(0, audio_duration_to_ms(2));
                 current_note                 = previous_note;
                 melody_current_note_duration = audio_duration_to_ms(2);
 
@@ -441,13 +497,14 @@ bool audio_update_state(void) {
 
                 // '- delta': Skip forward in the next note's length if we've over shot
                 //            the last, so the overall length of the song is the same
-                uint16_t duration = audio_duration_to_ms((*notes_pointer)[current_note][1]);
+                uint16_t duration = melody_note_duration(current_note);
 
                 // Skip forward past any completely missed notes
                 while (delta > duration && current_note < notes_count - 1) {
                     delta -= duration;
                     current_note++;
-                    duration = audio_duration_to_ms((*notes_pointer)[current_note][1]);
+                    duration = melody_note_duration(current_note);
+                    pitch    = melody_note_pitch(current_note);
                 }
 
                 if (delta < duration) {
@@ -458,7 +515,7 @@ bool audio_update_state(void) {
                     duration = 1;
                 }
 
-                audio_play_note((*notes_pointer)[current_note][0], duration);
+                start_tone(pitch, duration);
                 melody_current_note_duration = duration;
             }
         }
@@ -480,7 +537,7 @@ bool audio_update_state(void) {
                 && (tones[i].duration != 0)   // 'uninitialized'
             ) {
                 if (timer_elapsed(tones[i].time_started) >= tones[i].duration) {
-                    audio_stop_tone(tones[i].pitch); // also sets 'state_changed=true'
+                    stop_tone(tones[i].pitch); // also sets 'state_changed=true'
                 }
             }
         }
@@ -542,20 +599,11 @@ void audio_decrease_tempo(uint8_t tempo_change) {
         note_tempo -= tempo_change;
 }
 
-// TODO in the int-math version are some bugs; songs sometimes abruptly end - maybe an issue with the timer/system-tick wrapping around?
 uint16_t audio_duration_to_ms(uint16_t duration_bpm) {
-#if defined(__AVR__)
-    // doing int-math saves us some bytes in the overall firmware size, but the intermediate result is less accurate before being cast to/returned as uint
-    return ((uint32_t)duration_bpm * 60 * 1000) / (64 * note_tempo);
-    // NOTE: beware of uint16_t overflows when note_tempo is low and/or the duration is long
-#else
-    return ((float)duration_bpm * 60) / (64 * note_tempo) * 1000;
-#endif
+    uint32_t duration_ms = ((uint32_t)duration_bpm * 60 * 1000) / (64 * note_tempo);
+    // long notes at a low tempo would overflow, and 0xffff is taken by the indefinite tones of 'audio_play_tone'
+    return duration_ms < 0xffff ? duration_ms : 0xfffe;
 }
 uint16_t audio_ms_to_duration(uint16_t duration_ms) {
-#if defined(__AVR__)
     return ((uint32_t)duration_ms * 64 * note_tempo) / 60 / 1000;
-#else
-    return ((float)duration_ms * 64 * note_tempo) / 60 / 1000;
-#endif
 }
@@ -54,13 +54,23 @@ typedef union {
  * "A musical tone is characterized by its duration, pitch, intensity (or loudness), and timbre (or quality)"
  */
 typedef struct {
-    uint16_t time_started; // timestamp the tone/note was started, system time runs with 1ms resolution -> 16bit timer overflows every ~64 seconds, long enough under normal circumstances; but might be too soon for long-duration notes when the note_tempo is set to a very low value
-    float    pitch;        // aka frequency, in Hz
-    uint16_t duration;     // in ms, converted from the musical_notes.h unit which has 64parts to a beat, factoring in the current tempo in beats-per-minute
-    // float intensity;    // aka volume [0,1] TODO: not used at the moment; pwm drivers can't handle it
-    // uint8_t timbre;     // range: [0,100] TODO: this currently kept track of globally, should we do this per tone instead?
+    uint16_t     time_started; // timestamp the tone/note was started, system time runs with 1ms resolution -> 16bit timer overflows every ~64 seconds, long enough under normal circumstances; but might be too soon for long-duration notes when the note_tempo is set to a very low value
+    audio_freq_t pitch;        // aka frequency, in 1/256 Hz - see synth.h
+    uint16_t     duration;     // in ms, converted from the musical_notes.h unit which has 64parts to a beat, factoring in the current tempo in beats-per-minute
+    // float intensity;        // aka volume [0,1] TODO: not used at the moment; pwm drivers can't handle it
+    // uint8_t timbre;         // range: [0,100] TODO: this currently kept track of globally, should we do this per tone instead?
 } musical_tone_t;
 
+/*
+ * a note of a compact SONG, built with SONG_NOTE from musical_notes.h: note
+ * number and duration packed into one word, a quarter of the size of a
+ * {pitch, duration} float tuple
+ */
+typedef uint16_t song_note_t;
+
+#define SONG_NOTE_NUMBER(song_note) ((uint8_t)((song_note) >> 9))
+#define SONG_NOTE_DURATION(song_note) ((uint16_t)((song_note)&0x1FF))
+
 // public interface
 
 /**
@@ -142,6 +152,18 @@ void audio_stop_tone(float pitch);
  */
 void audio_play_melody(float (*np)[][2], uint16_t n_count, bool n_repeat);
 
+/**
+ * @brief play a compact melody
+ *
+ * @details like audio_play_melody, for a SONG of song_note_t; the notes are read
+ *          from PROGMEM one at a time while playing
+ *
+ * @param[in] notes SONG array in PROGMEM
+ * @param[in] count number of SONG_NOTEs of the SONG
+ * @param[in] repeat false for onetime, true for looped playback
+ */
+void audio_play_compact_melody(const song_note_t *notes, uint16_t count, bool repeat);
+
 /**
  * @brief play a short tone of a specific frequency to emulate a 'click'
  *
@@ -188,6 +210,13 @@ bool audio_is_playing_melody(void);
  */
 #define PLAY_LOOP(note_array) audio_play_melody(&note_array, NOTE_ARRAY_SIZE((note_array)), true)
 
+/**
+ * @brief PLAY_SONG and PLAY_LOOP for a compact SONG, e.g.
+ *        const song_note_t PROGMEM my_song[] = SONG(SONG_NOTE(_C4, 16), SONG_NOTE(_REST, 16));
+ */
+#define PLAY_COMPACT_SONG(song_array) audio_play_compact_melody(song_array, NOTE_ARRAY_SIZE((song_array)), false)
+#define PLAY_COMPACT_LOOP(song_array) audio_play_compact_melody(song_array, NOTE_ARRAY_SIZE((song_array)), true)
+
 // Tone-Multiplexing functions
 // this feature only makes sense for hardware setups which can't do proper
 // audio-wave synthesis = have no DAC and need to use PWM for tone generation
@@ -239,6 +268,8 @@ uint8_t audio_get_number_of_active_tones(void);
  * @return a positive frequency, in Hz; or zero if the tone is a pause
  */
 float audio_get_frequency(uint8_t tone_index);
+// same as above, in 1/256 Hz
+audio_freq_t audio_get_frequency_fixed(uint8_t tone_index);
 
 /**
  * @brief calculate and return the frequency for the requested tone
@@ -251,6 +282,8 @@ float audio_get_frequency(uint8_t tone_index);
  * @return a positive frequency, in Hz; or zero if the tone is a pause
  */
 float audio_get_processed_frequency(uint8_t tone_index);
+// same as above, in 1/256 Hz; the drivers use this one, to keep floats out of their interrupts
+audio_freq_t audio_get_processed_frequency_fixed(uint8_t tone_index);
 
 /**
  * @brief   update audio internal state: currently playing and active tones,...
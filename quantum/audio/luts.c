@@ -16,8 +16,9 @@
 
 #include "luts.h"
 
-const float vibrato_lut[VIBRATO_LUT_LENGTH] = {
-    1.0022336811487, 1.0042529943610, 1.0058584256028, 1.0068905285205, 1.0072464122237, 1.0068905285205, 1.0058584256028, 1.0042529943610, 1.0022336811487, 1.0000000000000, 0.9977712970630, 0.9957650169978, 0.9941756956510, 0.9931566259436, 0.9928057204913, 0.9931566259436, 0.9941756956510, 0.9957650169978, 0.9977712970630, 1.0000000000000,
+// a sine over one period, in 1/65536 octaves: up to 0.0104 octaves (~1/8 semitone) above and below
+const int16_t PROGMEM vibrato_lut[VIBRATO_LUT_LENGTH] = {
+    211, 401, 552, 649, 683, 649, 552, 401, 211, 0, -211, -401, -552, -649, -683, -649, -552, -401, -211, 0,
 };
 
 const uint16_t frequency_lut[FREQUENCY_LUT_LENGTH] = {
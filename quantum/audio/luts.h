@@ -18,10 +18,11 @@
 
 #include <float.h>
 #include <stdint.h>
+#include "progmem.h"
 
 #define VIBRATO_LUT_LENGTH 20
 
 #define FREQUENCY_LUT_LENGTH 349
 
-extern const float    vibrato_lut[VIBRATO_LUT_LENGTH];
+extern const int16_t  vibrato_lut[VIBRATO_LUT_LENGTH];
 extern const uint16_t frequency_lut[FREQUENCY_LUT_LENGTH];
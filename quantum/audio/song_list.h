@@ -51,6 +51,7 @@
 */
 
 #define STARTUP_SOUND E__NOTE(_E6), E__NOTE(_A6), ED_NOTE(_E7),
+#define STARTUP_SOUND_COMPACT SONG_NOTE(_E6, 8), SONG_NOTE(_A6, 8), SONG_NOTE(_E7, 12),
 
 #define GOODBYE_SOUND E__NOTE(_E7), E__NOTE(_A6), ED_NOTE(_E6),
 
@@ -73,8 +74,10 @@
 #define MUSIC_ON_SOUND E__NOTE(_A5), E__NOTE(_B5), E__NOTE(_CS6), E__NOTE(_D6), E__NOTE(_E6), E__NOTE(_FS6), E__NOTE(_GS6), E__NOTE(_A6),
 
 #define AUDIO_ON_SOUND E__NOTE(_A5), E__NOTE(_A6),
+#define AUDIO_ON_SOUND_COMPACT SONG_NOTE(_A5, 8), SONG_NOTE(_A6, 8),
 
 #define AUDIO_OFF_SOUND E__NOTE(_A6), E__NOTE(_A5),
+#define AUDIO_OFF_SOUND_COMPACT SONG_NOTE(_A6, 8), SONG_NOTE(_A5, 8),
 
 #define MUSIC_SCALE_SOUND MUSIC_ON_SOUND
 
@@ -0,0 +1,100 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "synth.h"
+#include "luts.h"
+#include "progmem.h"
+
+#define EXP2_LUT_BITS 5
+
+// 2^(i/32) - 1 over one octave, in 1/65536; interpolated linearly in between, which is off by less than 0.3 cent
+static const uint16_t PROGMEM exp2_lut[1 << EXP2_LUT_BITS] = {
+    0x0000, 0x059B, 0x0B56, 0x1130, 0x172C, 0x1D48, 0x2388, 0x29EA, 0x3070, 0x371A, 0x3DEA, 0x44E1, 0x4BFE, 0x5343, 0x5AB0, 0x6248, 0x6A0A, 0x71F7, 0x7A11, 0x8259, 0x8ACE, 0x9373, 0x9C49, 0xA550, 0xAE8A, 0xB7F7, 0xC19A, 0xCB72, 0xD582, 0xDFC9, 0xEA4B, 0xF507,
+};
+
+// equal temperament frequencies of C9 to B9, in 1/256 Hz; lower octaves are shifted down from these
+static const uint32_t PROGMEM note_lut[12] = {
+    2143237, 2270680, 2405702, 2548752, 2700309, 2860878, 3030994, 3211227, 3402176, 3604480, 3818814, 4045892,
+};
+
+// 440Hz / f / 24 octaves, for f in 1/256 Hz: the step of a glissando
+#define GLISSANDO_STEP(frequency) ((int32_t)(440UL * SYNTH_OCTAVE / 24 * AUDIO_FREQ_ONE_HZ / (frequency)))
+
+// 2^fraction - 1 for a fraction of an octave, both in 1/65536
+static uint16_t exp2_fraction(uint16_t fraction) {
+    uint8_t  index     = fraction >> (16 - EXP2_LUT_BITS);
+    uint16_t remainder = fraction & ((1 << (16 - EXP2_LUT_BITS)) - 1);
+    uint32_t low       = pgm_read_word(&exp2_lut[index]);
+    uint32_t high      = index < (1 << EXP2_LUT_BITS) - 1 ? pgm_read_word(&exp2_lut[index + 1]) : 0x10000;
+
+    return low + (((high - low) * remainder) >> (16 - EXP2_LUT_BITS));
+}
+
+uint32_t synth_phase_increment(audio_freq_t frequency, uint32_t sample_rate) {
+    if (frequency >= (audio_freq_t)sample_rate << AUDIO_FREQ_SHIFT) {
+        return UINT32_MAX;
+    }
+    return ((uint64_t)frequency << (32 - AUDIO_FREQ_SHIFT)) / sample_rate;
+}
+
+audio_freq_t synth_note_frequency(uint8_t note) {
+    if (note == 0 || note > 127) {
+        return 0;
+    }
+
+    uint8_t shift = 10 - note / 12;
+    return (pgm_read_dword(&note_lut[note % 12]) + ((1UL << shift) >> 1)) >> shift;
+}
+
+audio_freq_t synth_transpose(audio_freq_t frequency, int32_t octaves) {
+    int16_t  shift  = octaves >> 16; // rounds towards -inf, leaving a positive fraction
+    uint32_t factor = exp2_fraction(octaves & 0xFFFF);
+
+    // frequency * (1 + factor / 65536), split up to stay within 32bit
+    frequency += (((frequency >> 8) * factor) >> 8) + (((frequency & 0xFF) * factor) >> 16);
+
+    if (shift < 0) {
+        return shift > -32 ? frequency >> -shift : 0;
+    }
+    return (shift < 32 && frequency <= (UINT32_MAX >> shift)) ? frequency << shift : UINT32_MAX;
+}
+
+audio_freq_t synth_vibrato(audio_freq_t frequency, uint8_t step, uint16_t strength) {
+    int16_t offset = pgm_read_word(&vibrato_lut[step % VIBRATO_LUT_LENGTH]);
+    return synth_transpose(frequency, ((int32_t)offset * strength) >> 8);
+}
+
+audio_freq_t synth_glissando(audio_freq_t from, audio_freq_t to) {
+    if (from == 0 || to == 0) {
+        return to;
+    }
+
+    if (from < to && from < synth_transpose(to, -GLISSANDO_STEP(to))) {
+        return synth_transpose(from, GLISSANDO_STEP(from));
+    } else if (from > to && from > synth_transpose(to, GLISSANDO_STEP(to))) {
+        return synth_transpose(from, -GLISSANDO_STEP(from));
+    }
+    return to;
+}
+
+void synth_render(synth_oscillator_t *oscillators, uint8_t count, const uint16_t *table, uint8_t table_bits, uint32_t gain, uint16_t *samples, uint16_t length) {
+    for (uint16_t s = 0; s < length; s++) {
+        uint32_t sum = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            sum += table[synth_oscillator_next(&oscillators[i], table_bits)];
+        }
+        samples[s] = (sum * gain) >> 16;
+    }
+}
@@ -0,0 +1,104 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Integer-only synthesis helpers, shared by audio.c, voices.c and the drivers
+ *
+ * frequencies are fixed point, in 1/256 Hz; pitch offsets are in octaves with
+ * 16 fractional bits, so a semitone is 65536 / 12
+ *
+ * oscillators are 32bit phase accumulators: one period of the waveform spans
+ * the whole range of the phase, the upper bits of which index a wavetable
+ */
+
+typedef uint32_t audio_freq_t;
+
+#define AUDIO_FREQ_SHIFT 8
+#define AUDIO_FREQ_ONE_HZ (1UL << AUDIO_FREQ_SHIFT)
+// for constants in whole Hz
+#define AUDIO_FREQ(hz) ((audio_freq_t)(hz) << AUDIO_FREQ_SHIFT)
+
+#define SYNTH_OCTAVE 65536L
+
+/**
+ * @brief conversion for the float API; meant for the places a frequency enters
+ *        or leaves the audio system, not for anything done per update or sample
+ */
+static inline audio_freq_t audio_freq_from_float(float hz) {
+    return hz > 0.0f ? (audio_freq_t)(hz * AUDIO_FREQ_ONE_HZ + 0.5f) : 0;
+}
+static inline float audio_freq_to_float(audio_freq_t frequency) {
+    return (float)frequency / AUDIO_FREQ_ONE_HZ;
+}
+
+typedef struct {
+    uint32_t phase;
+    uint32_t increment; // phase advance per sample, see 'synth_phase_increment'
+} synth_oscillator_t;
+
+/**
+ * @brief phase advance per sample for a frequency at the given sample rate
+ * @note: does a 64bit division - call it when a tone changes, not per sample
+ */
+uint32_t synth_phase_increment(audio_freq_t frequency, uint32_t sample_rate);
+
+/**
+ * @brief frequency of a note number, as used by SONG_NOTE: 69 is A4 = 440Hz
+ * @return 0 for the rest (0) and invalid note numbers
+ */
+audio_freq_t synth_note_frequency(uint8_t note);
+
+/**
+ * @brief shift a frequency by some octaves (or fractions thereof)
+ * @details for frequencies up to 65535Hz; the result saturates instead of overflowing
+ */
+audio_freq_t synth_transpose(audio_freq_t frequency, int32_t octaves);
+
+/**
+ * @brief frequency shifted by step 'step' of the vibrato_lut
+ * @param[in] strength of the vibrato in 1/256, 256 applies the table as is
+ */
+audio_freq_t synth_vibrato(audio_freq_t frequency, uint8_t step, uint16_t strength);
+
+/**
+ * @brief one step of a slide from 'from' towards 'to'
+ * @details moves by 440Hz/'from' quarter tones at a time, returns 'to' once
+ *          it is less than a step away
+ */
+audio_freq_t synth_glissando(audio_freq_t from, audio_freq_t to);
+
+/**
+ * @brief additive synthesis of a number of oscillators over a wavetable
+ *
+ * @param[in] table with 2^table_bits samples of one period of the waveform
+ * @param[in] gain applied to the sum of the oscillators, in 1/65536; the sum
+ *                 times the gain has to fit 32bit, which it does for 12bit samples
+ * @param[out] samples buffer of 'length' samples
+ */
+void synth_render(synth_oscillator_t *oscillators, uint8_t count, const uint16_t *table, uint8_t table_bits, uint32_t gain, uint16_t *samples, uint16_t length);
+
+/**
+ * @brief advance an oscillator by one sample
+ * @return index into a wavetable of 2^table_bits samples
+ */
+static inline uint16_t synth_oscillator_next(synth_oscillator_t *oscillator, uint8_t table_bits) {
+    uint16_t index = oscillator->phase >> (32 - table_bits);
+    oscillator->phase += oscillator->increment;
+    return index;
+}
@@ -0,0 +1,6 @@
+audio_synth_DEFS := -DNO_DEBUG
+
+audio_synth_SRC := \
+	$(QUANTUM_PATH)/audio/tests/synth_tests.cpp \
+	$(QUANTUM_PATH)/audio/synth.c \
+	$(QUANTUM_PATH)/audio/luts.c
@@ -18,11 +18,11 @@
 #include "audio.h"
 #include <stdlib.h>
 
-uint8_t note_timbre      = TIMBRE_DEFAULT;
-bool    glissando        = false;
-bool    vibrato          = false;
-float   vibrato_strength = 0.5;
-float   vibrato_rate     = 0.125;
+uint8_t  note_timbre      = TIMBRE_DEFAULT;
+bool     glissando        = false;
+bool     vibrato          = false;
+uint16_t vibrato_strength = 128;  // in 1/256
+uint16_t vibrato_period   = 3200; // time per step through the vibrato_lut, in 1/256 ms; 100ms * rate
 
 uint16_t voices_timer = 0;
 
@@ -45,31 +45,20 @@ void voice_deiterate() {
 }
 
 #ifdef AUDIO_VOICES
-float mod(float a, int b) {
-    float r = fmod(a, b);
-    return r < 0 ? r + b : r;
-}
-
 // Effect: 'vibrate' a given target frequency slightly above/below its initial value
-float voice_add_vibrato(float average_freq) {
-    float vibrato_counter = mod(timer_read() / (100 * vibrato_rate), VIBRATO_LUT_LENGTH);
+audio_freq_t voice_add_vibrato(audio_freq_t average_freq) {
+    uint8_t step = (((uint32_t)timer_read() << 8) / (vibrato_period ? vibrato_period : 1)) % VIBRATO_LUT_LENGTH;
 
-    return average_freq * pow(vibrato_lut[(int)vibrato_counter], vibrato_strength);
+    return synth_vibrato(average_freq, step, vibrato_strength);
 }
 
 // Effect: 'slides' the 'frequency' from the starting-point, to the target frequency
-float voice_add_glissando(float from_freq, float to_freq) {
-    if (to_freq != 0 && from_freq < to_freq && from_freq < to_freq * pow(2, -440 / to_freq / 12 / 2)) {
-        return from_freq * pow(2, 440 / from_freq / 12 / 2);
-    } else if (to_freq != 0 && from_freq > to_freq && from_freq > to_freq * pow(2, 440 / to_freq / 12 / 2)) {
-        return from_freq * pow(2, -440 / from_freq / 12 / 2);
-    } else {
-        return to_freq;
-    }
+audio_freq_t voice_add_glissando(audio_freq_t from_freq, audio_freq_t to_freq) {
+    return synth_glissando(from_freq, to_freq);
 }
 #endif
 
-float voice_envelope(float frequency) {
+audio_freq_t voice_envelope(audio_freq_t frequency) {
     // envelope_index ranges from 0 to 0xFFFF, which is preserved at 880.0 Hz
 //    __attribute__((unused)) uint16_t compensated_index = (uint16_t)((float)envelope_index * (880.0 / frequency));
 #ifdef AUDIO_VOICES
@@ -126,10 +115,10 @@ float voice_envelope(float frequency) {
             // }
             // frequency = (rand() % (int)(frequency * 1.2 - frequency)) + (frequency * 0.8);
 
-            if (frequency < 80.0) {
-            } else if (frequency < 160.0) {
+            if (frequency < AUDIO_FREQ(80)) {
+            } else if (frequency < AUDIO_FREQ(160)) {
                 // Bass drum: 60 - 100 Hz
-                frequency = (rand() % (int)(40)) + 60;
+                frequency = AUDIO_FREQ((rand() % 40) + 60);
                 switch (envelope_index) {
                     case 0 ... 10:
                         note_timbre = 50;
@@ -142,9 +131,9 @@ float voice_envelope(float frequency) {
                         break;
                 }
 
-            } else if (frequency < 320.0) {
+            } else if (frequency < AUDIO_FREQ(320)) {
                 // Snare drum: 1 - 2 KHz
-                frequency = (rand() % (int)(1000)) + 1000;
+                frequency = AUDIO_FREQ((rand() % 1000) + 1000);
                 switch (envelope_index) {
                     case 0 ... 5:
                         note_timbre = 50;
@@ -157,9 +146,9 @@ float voice_envelope(float frequency) {
                         break;
                 }
 
-            } else if (frequency < 640.0) {
+            } else if (frequency < AUDIO_FREQ(640)) {
                 // Closed Hi-hat: 3 - 5 KHz
-                frequency = (rand() % (int)(2000)) + 3000;
+                frequency = AUDIO_FREQ((rand() % 2000) + 3000);
                 switch (envelope_index) {
                     case 0 ... 15:
                         note_timbre = 50;
@@ -172,9 +161,9 @@ float voice_envelope(float frequency) {
                         break;
                 }
 
-            } else if (frequency < 1280.0) {
+            } else if (frequency < AUDIO_FREQ(1280)) {
                 // Open Hi-hat: 3 - 5 KHz
-                frequency = (rand() % (int)(2000)) + 3000;
+                frequency = AUDIO_FREQ((rand() % 2000) + 3000);
                 switch (envelope_index) {
                     case 0 ... 35:
                         note_timbre = 50;
@@ -202,7 +191,8 @@ float voice_envelope(float frequency) {
                     break;
 
                 case 20 ... 200:
-                    note_timbre = 12 - (uint8_t)(pow(((float)compensated_index - 20) / (200 - 20), 2) * 12.5);
+                    // falling off quadratically from 12 to 0
+                    note_timbre = 12 - (uint8_t)((uint32_t)(compensated_index - 20) * (compensated_index - 20) * 25 / (2 * (200 - 20) * (200 - 20)));
                     break;
 
                 default:
@@ -239,18 +229,18 @@ float voice_envelope(float frequency) {
             switch (compensated_index) {
                 default:
 #    define OCS_SPEED 10
-#    define OCS_AMP .25
+#    define OCS_AMP 25 // in percent
                     // sine wave is slow
-                    // note_timbre = (sin((float)compensated_index/10000*OCS_SPEED) * OCS_AMP / 2) + .5;
+                    // note_timbre = (sin((float)compensated_index/10000*OCS_SPEED) * OCS_AMP / 200) + .5;
                     // triangle wave is a bit faster
-                    note_timbre = (uint8_t)abs((compensated_index * OCS_SPEED % 3000) - 1500) * (OCS_AMP / 1500) + (1 - OCS_AMP) / 2;
+                    note_timbre = ((uint8_t)abs((compensated_index * OCS_SPEED % 3000) - 1500) * OCS_AMP / 1500 + (100 - OCS_AMP) / 2) / 100;
                     break;
             }
             break;
 
         case duty_octave_down:
             glissando   = true;
-            note_timbre = (uint8_t)(100 * (envelope_index % 2) * .125 + .375 * 2);
+            note_timbre = (uint8_t)((100 * (envelope_index % 2) * 125 + 375 * 2) / 1000);
             if ((envelope_index % 4) == 0) note_timbre = 50;
             if ((envelope_index % 8) == 0) note_timbre = 0;
             break;
@@ -264,7 +254,7 @@ float voice_envelope(float frequency) {
                     break;
                 default:
                     // TODO: merge/replace with voice_add_vibrato above
-                    frequency = frequency * vibrato_lut[(int)fmod((((float)compensated_index - (VOICE_VIBRATO_DELAY + 1)) / 1000 * VOICE_VIBRATO_SPEED), VIBRATO_LUT_LENGTH)];
+                    frequency = synth_vibrato(frequency, ((compensated_index - (VOICE_VIBRATO_DELAY + 1)) * VOICE_VIBRATO_SPEED / 1000) % VIBRATO_LUT_LENGTH, 256);
                     break;
             }
             break;
@@ -332,16 +322,16 @@ float voice_envelope(float frequency) {
 // Vibrato functions
 
 void voice_set_vibrato_rate(float rate) {
-    vibrato_rate = rate;
+    vibrato_period = rate * 100 * 256;
 }
 void voice_increase_vibrato_rate(float change) {
-    vibrato_rate *= change;
+    vibrato_period *= change;
 }
 void voice_decrease_vibrato_rate(float change) {
-    vibrato_rate /= change;
+    vibrato_period /= change;
 }
 void voice_set_vibrato_strength(float strength) {
-    vibrato_strength = strength;
+    vibrato_strength = strength * 256;
 }
 void voice_increase_vibrato_strength(float change) {
     vibrato_strength *= change;
@@ -20,8 +20,9 @@
 #include <stdbool.h>
 #include "wait.h"
 #include "luts.h"
+#include "synth.h"
 
-float voice_envelope(float frequency);
+audio_freq_t voice_envelope(audio_freq_t frequency);
 
 typedef enum {
     default_voice,
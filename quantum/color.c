@@ -18,82 +18,65 @@
 #include "led_tables.h"
 #include "progmem.h"
 
-RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
-    RGB      rgb;
-    uint8_t  region, remainder, p, q, t;
-    uint16_t h, s, v;
+/* Which of v, t, p and q (in that order) make up r, g and b for each sixth of
+ * the hue circle, two bits per channel. Region 6 only holds h = 255, which
+ * wraps around to region 0.
+ */
+static const uint8_t PROGMEM hsv_region_map[7] = {
+#define HSV_REGION(r, g, b) ((r) | (g) << 2 | (b) << 4)
+    HSV_REGION(0, 1, 2), // v, t, p
+    HSV_REGION(3, 0, 2), // q, v, p
+    HSV_REGION(2, 0, 1), // p, v, t
+    HSV_REGION(2, 3, 0), // p, q, v
+    HSV_REGION(1, 2, 0), // t, p, v
+    HSV_REGION(0, 2, 3), // v, p, q
+    HSV_REGION(0, 1, 2), // v, t, p
+#undef HSV_REGION
+};
 
-    if (hsv.s == 0) {
-#ifdef USE_CIE1931_CURVE
-        if (use_cie) {
-            rgb.r = rgb.g = rgb.b = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
-        } else {
-            rgb.r = hsv.v;
-            rgb.g = hsv.v;
-            rgb.b = hsv.v;
-        }
-#else
-        rgb.r = hsv.v;
-        rgb.g = hsv.v;
-        rgb.b = hsv.v;
-#endif
-        return rgb;
-    }
+/* Fixed-point conversion without divisions or data dependent branches, so
+ * converting a whole frame takes the same time whatever the colors are.
+ */
+static inline RGB hsv_to_rgb_fixed(uint8_t h, uint8_t s, uint8_t v) {
+    RGB     rgb;
+    uint8_t c[4];
+
+    // h * 6 / 255, the multiplication is exact for h * 6 <= 1530
+    uint8_t region    = ((uint32_t)h * 6 * 257 + 257) >> 16;
+    uint8_t remainder = (h * 2 - region * 85) * 3;
+
+    // Zero saturation gives plain grey, select v for every channel
+    uint8_t grey = -(uint8_t)(s == 0);
 
-    h = hsv.h;
-    s = hsv.s;
+    c[0] = v;
+    c[1] = ((v * (255 - ((s * (255 - remainder)) >> 8))) >> 8 & ~grey) | (v & grey); // t
+    c[2] = ((v * (255 - s)) >> 8 & ~grey) | (v & grey);                              // p
+    c[3] = ((v * (255 - ((s * remainder) >> 8))) >> 8 & ~grey) | (v & grey);         // q
+
+    uint8_t map = pgm_read_byte(&hsv_region_map[region]);
+    rgb.r       = c[map & 3];
+    rgb.g       = c[(map >> 2) & 3];
+    rgb.b       = c[(map >> 4) & 3];
+    return rgb;
+}
+
+RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
 #ifdef USE_CIE1931_CURVE
     if (use_cie) {
-        v = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
-    } else {
-        v = hsv.v;
+        return hsv_to_rgb_fixed(hsv.h, hsv.s, pgm_read_byte(&CIE1931_CURVE[hsv.v]));
     }
-#else
-    v = hsv.v;
 #endif
+    return hsv_to_rgb_fixed(hsv.h, hsv.s, hsv.v);
+}
 
-    region    = h * 6 / 255;
-    remainder = (h * 2 - region * 85) * 3;
-
-    p = (v * (255 - s)) >> 8;
-    q = (v * (255 - ((s * remainder) >> 8))) >> 8;
-    t = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
-
-    switch (region) {
-        case 6:
-        case 0:
-            rgb.r = v;
-            rgb.g = t;
-            rgb.b = p;
-            break;
-        case 1:
-            rgb.r = q;
-            rgb.g = v;
-            rgb.b = p;
-            break;
-        case 2:
-            rgb.r = p;
-            rgb.g = v;
-            rgb.b = t;
-            break;
-        case 3:
-            rgb.r = p;
-            rgb.g = q;
-            rgb.b = v;
-            break;
-        case 4:
-            rgb.r = t;
-            rgb.g = p;
-            rgb.b = v;
-            break;
-        default:
-            rgb.r = v;
-            rgb.g = p;
-            rgb.b = q;
-            break;
+void hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+#ifdef USE_CIE1931_CURVE
+        rgb[i] = hsv_to_rgb_fixed(hsv[i].h, hsv[i].s, pgm_read_byte(&CIE1931_CURVE[hsv[i].v]));
+#else
+        rgb[i] = hsv_to_rgb_fixed(hsv[i].h, hsv[i].s, hsv[i].v);
+#endif
     }
-
-    return rgb;
 }
 
 RGB hsv_to_rgb(HSV hsv) {
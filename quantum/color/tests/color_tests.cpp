@@ -0,0 +1,120 @@
+/* Copyright 2022 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "color.h"
+}
+
+/* The original division and switch based conversion, the fixed-point one has to match it exactly. */
+static RGB hsv_to_rgb_reference(HSV hsv) {
+    RGB      rgb;
+    uint8_t  region, remainder, p, q, t;
+    uint16_t h = hsv.h, s = hsv.s, v = hsv.v;
+
+    if (hsv.s == 0) {
+        rgb.r = rgb.g = rgb.b = hsv.v;
+        return rgb;
+    }
+
+    region    = h * 6 / 255;
+    remainder = (h * 2 - region * 85) * 3;
+
+    p = (v * (255 - s)) >> 8;
+    q = (v * (255 - ((s * remainder) >> 8))) >> 8;
+    t = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
+
+    switch (region) {
+        case 6:
+        case 0:
+            rgb.r = v, rgb.g = t, rgb.b = p;
+            break;
+        case 1:
+            rgb.r = q, rgb.g = v, rgb.b = p;
+            break;
+        case 2:
+            rgb.r = p, rgb.g = v, rgb.b = t;
+            break;
+        case 3:
+            rgb.r = p, rgb.g = q, rgb.b = v;
+            break;
+        case 4:
+            rgb.r = t, rgb.g = p, rgb.b = v;
+            break;
+        default:
+            rgb.r = v, rgb.g = p, rgb.b = q;
+            break;
+    }
+    return rgb;
+}
+
+class ColorTest : public ::testing::Test {};
+
+TEST_F(ColorTest, TestPrimaryColors) {
+    RGB rgb = hsv_to_rgb_nocie({0, 255, 255});
+    EXPECT_EQ(rgb.r, 255);
+    EXPECT_EQ(rgb.g, 0);
+    EXPECT_EQ(rgb.b, 0);
+
+    rgb = hsv_to_rgb_nocie({85, 255, 255});
+    EXPECT_EQ(rgb.r, 0);
+    EXPECT_EQ(rgb.g, 255);
+    EXPECT_EQ(rgb.b, 0);
+
+    rgb = hsv_to_rgb_nocie({170, 255, 255});
+    EXPECT_EQ(rgb.r, 0);
+    EXPECT_EQ(rgb.g, 0);
+    EXPECT_EQ(rgb.b, 255);
+
+    rgb = hsv_to_rgb_nocie({123, 0, 77});
+    EXPECT_EQ(rgb.r, 77);
+    EXPECT_EQ(rgb.g, 77);
+    EXPECT_EQ(rgb.b, 77);
+}
+
+TEST_F(ColorTest, TestMatchesReference) {
+    for (uint16_t h = 0; h < 256; h++) {
+        for (uint16_t s = 0; s < 256; s++) {
+            for (uint16_t v = 0; v < 256; v++) {
+                HSV hsv      = {(uint8_t)h, (uint8_t)s, (uint8_t)v};
+                RGB expected = hsv_to_rgb_reference(hsv);
+                RGB actual   = hsv_to_rgb_nocie(hsv);
+                ASSERT_EQ(actual.r, expected.r) << "h=" << h << " s=" << s << " v=" << v;
+                ASSERT_EQ(actual.g, expected.g) << "h=" << h << " s=" << s << " v=" << v;
+                ASSERT_EQ(actual.b, expected.b) << "h=" << h << " s=" << s << " v=" << v;
+            }
+        }
+    }
+}
+
+TEST_F(ColorTest, TestBatchMatchesSingle) {
+    HSV hsv[256];
+    RGB rgb[256];
+
+    for (uint16_t s = 0; s < 256; s += 5) {
+        for (uint16_t i = 0; i < 256; i++) {
+            hsv[i] = {(uint8_t)i, (uint8_t)s, (uint8_t)(255 - i)};
+        }
+        hsv_to_rgb_batch(hsv, rgb, 255);
+        for (uint16_t i = 0; i < 255; i++) {
+            RGB expected = hsv_to_rgb(hsv[i]);
+            ASSERT_EQ(rgb[i].r, expected.r);
+            ASSERT_EQ(rgb[i].g, expected.g);
+            ASSERT_EQ(rgb[i].b, expected.b);
+        }
+    }
+}
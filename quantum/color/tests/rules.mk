@@ -0,0 +1,5 @@
+color_DEFS := -DNO_DEBUG
+
+color_SRC := \
+	$(QUANTUM_PATH)/color/tests/color_tests.cpp \
+	$(QUANTUM_PATH)/color.c
@@ -16,7 +16,8 @@
 
 #pragma once
 
-#include "quantum.h"
+#include <stdint.h>
+#include <stddef.h>
 
 /**
  * The type of the CRC values.
@@ -32,7 +33,7 @@ typedef uint_least8_t crc_t;
 /**
  * Initialize crc subsystem.
  */
-__attribute__((weak)) void crc_init(void);
+void crc_init(void);
 
 /**
  * Generate CRC8 value from given data.
@@ -41,4 +42,4 @@ __attribute__((weak)) void crc_init(void);
  * \param[in] data_len Number of bytes in the \a data buffer.
  * \return             The calculated crc value.
  */
-__attribute__((weak)) uint8_t crc8(const void *data, size_t data_len);
\ No newline at end of file
+uint8_t crc8(const void *data, size_t data_len);
\ No newline at end of file
@@ -662,5 +662,9 @@ void keyboard_task(void) {
     programmable_button_send();
 #endif
 
+#ifdef EEPROM_DRIVER
+    eeprom_driver_task();
+#endif
+
     led_task();
 }
@@ -96,6 +96,9 @@ uint8_t g_led_frame_buffer[MATRIX_ROWS][MATRIX_COLS] = {{0}};
 #ifdef LED_MATRIX_KEYREACTIVE_ENABLED
 last_hit_t g_last_hit_tracker;
 #endif // LED_MATRIX_KEYREACTIVE_ENABLED
+#ifdef LED_MATRIX_RENDER_BUDGET
+uint8_t g_led_slice_size = DRIVER_LED_TOTAL;
+#endif // LED_MATRIX_RENDER_BUDGET
 
 // internals
 static bool            suspend_state     = false;
@@ -106,6 +109,12 @@ static led_task_states led_task_state    = SYNCING;
 #if LED_DISABLE_TIMEOUT > 0
 static uint32_t led_anykey_timer;
 #endif // LED_DISABLE_TIMEOUT > 0
+#ifdef LED_MATRIX_RENDER_BUDGET
+static uint16_t led_led_cost; // average render time per LED in 1/16 us
+#endif // LED_MATRIX_RENDER_BUDGET
+static uint16_t led_frame_count;
+static uint16_t led_fps;
+static uint32_t led_fps_timer;
 
 // double buffers
 static uint32_t led_timer_buffer;
@@ -282,6 +291,12 @@ static void led_task_start(void) {
     g_last_hit_tracker = last_hit_buffer;
 #endif // LED_MATRIX_KEYREACTIVE_ENABLED
 
+#ifdef LED_MATRIX_RENDER_BUDGET
+    // size the slices of this frame to the budget, they have to stay the same until the frame is done
+    uint32_t slice   = led_led_cost ? (uint32_t)LED_MATRIX_RENDER_BUDGET * 16 / led_led_cost : DRIVER_LED_TOTAL;
+    g_led_slice_size = slice < 1 ? 1 : (slice > DRIVER_LED_TOTAL ? DRIVER_LED_TOTAL : slice);
+#endif // LED_MATRIX_RENDER_BUDGET
+
     // next task
     led_task_state = RENDERING;
 }
@@ -347,10 +362,37 @@ static void led_task_flush(uint8_t effect) {
     // update pwm buffers
     led_matrix_update_pwm_buffers();
 
+    led_frame_count++;
+    if (timer_elapsed32(led_fps_timer) >= 1000) {
+        led_fps         = led_frame_count;
+        led_frame_count = 0;
+        led_fps_timer   = timer_read32();
+    }
+
     // next task
     led_task_state = SYNCING;
 }
 
+#ifdef LED_MATRIX_RENDER_BUDGET
+static void led_task_measure(uint8_t iter, uint32_t start) {
+    uint8_t first = g_led_slice_size * iter;
+    if (iter == led_effect_params.iter || first >= DRIVER_LED_TOTAL) return;
+
+    uint8_t count = DRIVER_LED_TOTAL - first;
+    if (count > g_led_slice_size) count = g_led_slice_size;
+    uint32_t cost = (timer_read_us32() - start) * 16 / count;
+    if (cost > UINT16_MAX) cost = UINT16_MAX;
+    // average over several slices, a single measurement is only as precise as the timer
+    led_led_cost = ((uint32_t)led_led_cost * 7 + cost) / 8;
+}
+#endif // LED_MATRIX_RENDER_BUDGET
+
+uint16_t led_matrix_get_fps(void) {
+    // nothing has been flushed for a while
+    if (timer_elapsed32(led_fps_timer) >= 2000) return 0;
+    return led_fps;
+}
+
 void led_matrix_task(void) {
     led_task_timers();
 
@@ -368,13 +410,21 @@ void led_matrix_task(void) {
         case STARTING:
             led_task_start();
             break;
-        case RENDERING:
+        case RENDERING: {
+#ifdef LED_MATRIX_RENDER_BUDGET
+            uint8_t  iter  = led_effect_params.iter;
+            uint32_t start = timer_read_us32();
+#endif // LED_MATRIX_RENDER_BUDGET
             led_task_render(effect);
             if (effect) {
                 led_matrix_indicators();
                 led_matrix_indicators_advanced(&led_effect_params);
             }
+#ifdef LED_MATRIX_RENDER_BUDGET
+            led_task_measure(iter, start);
+#endif // LED_MATRIX_RENDER_BUDGET
             break;
+        }
         case FLUSHING:
             led_task_flush(effect);
             break;
@@ -399,9 +449,9 @@ void led_matrix_indicators_advanced(effect_params_t *params) {
      * and not sure which would be better. Otherwise, this should be called from
      * led_task_render, right before the iter++ line.
      */
-#if defined(LED_MATRIX_LED_PROCESS_LIMIT) && LED_MATRIX_LED_PROCESS_LIMIT > 0 && LED_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
-    uint8_t min = LED_MATRIX_LED_PROCESS_LIMIT * (params->iter - 1);
-    uint8_t max = min + LED_MATRIX_LED_PROCESS_LIMIT;
+#ifdef LED_MATRIX_LED_SLICE
+    uint8_t min = LED_MATRIX_LED_SLICE * (params->iter - 1);
+    uint8_t max = min + LED_MATRIX_LED_SLICE;
     if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
 #else
     uint8_t min = 0;
@@ -42,19 +42,25 @@
 #    define LED_MATRIX_LED_PROCESS_LIMIT (DRIVER_LED_TOTAL + 4) / 5
 #endif
 
-#if defined(LED_MATRIX_LED_PROCESS_LIMIT) && LED_MATRIX_LED_PROCESS_LIMIT > 0 && LED_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
+#if defined(LED_MATRIX_RENDER_BUDGET)
+#    define LED_MATRIX_LED_SLICE g_led_slice_size
+#elif defined(LED_MATRIX_LED_PROCESS_LIMIT) && LED_MATRIX_LED_PROCESS_LIMIT > 0 && LED_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
+#    define LED_MATRIX_LED_SLICE LED_MATRIX_LED_PROCESS_LIMIT
+#endif
+
+#ifdef LED_MATRIX_LED_SLICE
 #    if defined(LED_MATRIX_SPLIT)
 #        define LED_MATRIX_USE_LIMITS(min, max)                                                   \
-            uint8_t min = LED_MATRIX_LED_PROCESS_LIMIT * params->iter;                            \
-            uint8_t max = min + LED_MATRIX_LED_PROCESS_LIMIT;                                     \
+            uint8_t min = LED_MATRIX_LED_SLICE * params->iter;                                    \
+            uint8_t max = min + LED_MATRIX_LED_SLICE;                                             \
             if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;                                   \
             uint8_t k_led_matrix_split[2] = LED_MATRIX_SPLIT;                                     \
             if (is_keyboard_left() && (max > k_led_matrix_split[0])) max = k_led_matrix_split[0]; \
             if (!(is_keyboard_left()) && (min < k_led_matrix_split[0])) min = k_led_matrix_split[0];
 #    else
-#        define LED_MATRIX_USE_LIMITS(min, max)                        \
-            uint8_t min = LED_MATRIX_LED_PROCESS_LIMIT * params->iter; \
-            uint8_t max = min + LED_MATRIX_LED_PROCESS_LIMIT;          \
+#        define LED_MATRIX_USE_LIMITS(min, max)                \
+            uint8_t min = LED_MATRIX_LED_SLICE * params->iter; \
+            uint8_t max = min + LED_MATRIX_LED_SLICE;          \
             if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
 #    endif
 #else
@@ -112,7 +118,8 @@ void led_matrix_set_value_all(uint8_t value);
 
 void process_led_matrix(uint8_t row, uint8_t col, bool pressed);
 
-void led_matrix_task(void);
+void     led_matrix_task(void);
+uint16_t led_matrix_get_fps(void);
 
 // This runs after another backlight effect and replaces
 // values already set
@@ -189,6 +196,9 @@ extern led_eeconfig_t led_matrix_eeconfig;
 
 extern uint32_t     g_led_timer;
 extern led_config_t g_led_config;
+#ifdef LED_MATRIX_RENDER_BUDGET
+extern uint8_t g_led_slice_size;
+#endif
 #ifdef LED_MATRIX_KEYREACTIVE_ENABLED
 extern last_hit_t g_last_hit_tracker;
 #endif
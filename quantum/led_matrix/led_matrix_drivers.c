@@ -175,17 +175,27 @@ const led_matrix_driver_t led_matrix_driver = {
 };
 
 #    elif defined(IS31FLCOMMON)
+#        ifdef I2C_ASYNC_SUPPORTED
+// Refresh all drivers in the background, in one queue of I2C writes
+#            define IS31FL_common_flush_pwm_register IS31FL_common_queue_pwm_register
+#        else
+#            define IS31FL_common_flush_pwm_register IS31FL_common_update_pwm_register
+#        endif
+
 static void flush(void) {
-    IS31FL_common_update_pwm_register(DRIVER_ADDR_1, 0);
+    IS31FL_common_flush_pwm_register(DRIVER_ADDR_1, 0);
 #        if defined(LED_DRIVER_ADDR_2)
-    IS31FL_common_update_pwm_register(DRIVER_ADDR_2, 1);
+    IS31FL_common_flush_pwm_register(DRIVER_ADDR_2, 1);
 #            if defined(LED_DRIVER_ADDR_3)
-    IS31FL_common_update_pwm_register(DRIVER_ADDR_3, 2);
+    IS31FL_common_flush_pwm_register(DRIVER_ADDR_3, 2);
 #                if defined(LED_DRIVER_ADDR_4)
-    IS31FL_common_update_pwm_register(DRIVER_ADDR_4, 3);
+    IS31FL_common_flush_pwm_register(DRIVER_ADDR_4, 3);
 #                endif
 #            endif
 #        endif
+#        ifdef I2C_ASYNC_SUPPORTED
+    IS31FL_common_send_queue();
+#        endif
 }
 
 const led_matrix_driver_t led_matrix_driver = {
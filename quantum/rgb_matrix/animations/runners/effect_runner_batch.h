@@ -0,0 +1,26 @@
+#pragma once
+
+// Collects the colors produced by an effect runner, so they are converted from
+// HSV to RGB a batch at a time instead of one LED at a time.
+typedef struct {
+    uint8_t count;
+    uint8_t index[RGB_MATRIX_HSV_BATCH_SIZE];
+    HSV     hsv[RGB_MATRIX_HSV_BATCH_SIZE];
+} effect_batch_t;
+
+static void effect_batch_flush(effect_batch_t* batch) {
+    RGB rgb[RGB_MATRIX_HSV_BATCH_SIZE];
+    rgb_matrix_hsv_to_rgb_batch(batch->hsv, rgb, batch->count);
+    for (uint8_t j = 0; j < batch->count; j++) {
+        rgb_matrix_set_color(batch->index[j], rgb[j].r, rgb[j].g, rgb[j].b);
+    }
+    batch->count = 0;
+}
+
+static inline void effect_batch_add(effect_batch_t* batch, uint8_t i, HSV hsv) {
+    batch->index[batch->count] = i;
+    batch->hsv[batch->count]   = hsv;
+    if (++batch->count == RGB_MATRIX_HSV_BATCH_SIZE) {
+        effect_batch_flush(batch);
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+typedef HSV (*polar_f)(HSV hsv, uint8_t dist, uint8_t angle, uint8_t time);
+
+bool effect_runner_polar(effect_params_t* params, polar_f effect_func) {
+    RGB_MATRIX_USE_LIMITS(led_min, led_max);
+    effect_batch_t batch = {0};
+
+    uint8_t time = scale16by8(g_rgb_timer, rgb_matrix_config.speed / 2);
+    for (uint8_t i = led_min; i < led_max; i++) {
+        RGB_MATRIX_TEST_LED_FLAGS();
+        effect_batch_add(&batch, i, effect_func(rgb_matrix_config.hsv, rgb_matrix_led_dist(i), rgb_matrix_led_angle(i), time));
+    }
+    effect_batch_flush(&batch);
+    return rgb_matrix_check_finished_leds(led_max);
+}
@@ -4,26 +4,75 @@
 
 typedef HSV (*reactive_splash_f)(HSV hsv, int16_t dx, int16_t dy, uint8_t dist, uint16_t tick);
 
-bool effect_runner_reactive_splash(uint8_t start, effect_params_t* params, reactive_splash_f effect_func) {
+// Tells which distances from a hit its wavefront can light up at the given tick.
+// Returns false if it can't reach any LED anymore.
+typedef bool (*reactive_splash_reach_f)(uint16_t tick, uint8_t* near, uint8_t* far);
+
+// Reach of a wavefront travelling outwards by one unit per tick and fading over 255 ticks
+static bool reactive_splash_wavefront_reach(uint16_t tick, uint8_t* near, uint8_t* far) {
+    if (tick > UINT8_MAX + 254) return false;
+    *near = tick > 254 ? tick - 254 : 0;
+    *far  = tick > UINT8_MAX ? UINT8_MAX : tick;
+    return true;
+}
+
+static bool effect_runner_reactive_splash_impl(uint8_t start, effect_params_t* params, reactive_splash_f effect_func, reactive_splash_reach_f reach_func) {
     RGB_MATRIX_USE_LIMITS(led_min, led_max);
+    effect_batch_t batch = {0};
+
+    uint8_t  count = g_last_hit_tracker.count;
+    uint16_t tick[LED_HITS_TO_REMEMBER];
+    uint8_t  near[LED_HITS_TO_REMEMBER];
+    uint8_t  far[LED_HITS_TO_REMEMBER];
+    uint8_t  active[LED_HITS_TO_REMEMBER];
+    uint8_t  active_count = 0;
+
+    // Work out once per frame which hits are still visible and how far their wavefront is spread
+    for (uint8_t j = start; j < count; j++) {
+        tick[j] = scale16by8(g_last_hit_tracker.tick[j], qadd8(rgb_matrix_config.speed, 1));
+        near[j] = 0;
+        far[j]  = UINT8_MAX;
+        if (!reach_func || reach_func(tick[j], &near[j], &far[j])) {
+            active[active_count++] = j;
+        }
+    }
 
-    uint8_t count = g_last_hit_tracker.count;
     for (uint8_t i = led_min; i < led_max; i++) {
         RGB_MATRIX_TEST_LED_FLAGS();
         HSV hsv = rgb_matrix_config.hsv;
         hsv.v   = 0;
-        for (uint8_t j = start; j < count; j++) {
-            int16_t  dx   = g_led_config.point[i].x - g_last_hit_tracker.x[j];
-            int16_t  dy   = g_led_config.point[i].y - g_last_hit_tracker.y[j];
-            uint8_t  dist = sqrt16(dx * dx + dy * dy);
-            uint16_t tick = scale16by8(g_last_hit_tracker.tick[j], qadd8(rgb_matrix_config.speed, 1));
-            hsv           = effect_func(hsv, dx, dy, dist, tick);
+        for (uint8_t k = 0; k < active_count; k++) {
+            uint8_t j  = active[k];
+            int16_t dx = g_led_config.point[i].x - g_last_hit_tracker.x[j];
+            int16_t dy = g_led_config.point[i].y - g_last_hit_tracker.y[j];
+            if (reach_func) {
+                // The distance lies between the larger and the sum of both offsets, skip the square root when out of reach
+                uint8_t adx = abs(dx);
+                uint8_t ady = abs(dy);
+                if ((adx > ady ? adx : ady) > far[j] || adx + ady < near[j]) {
+                    continue;
+                }
+            }
+            uint8_t dist = sqrt16(dx * dx + dy * dy);
+            if (dist < near[j] || dist > far[j]) {
+                continue;
+            }
+            hsv = effect_func(hsv, dx, dy, dist, tick[j]);
         }
-        hsv.v   = scale8(hsv.v, rgb_matrix_config.hsv.v);
-        RGB rgb = rgb_matrix_hsv_to_rgb(hsv);
-        rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
+        hsv.v = scale8(hsv.v, rgb_matrix_config.hsv.v);
+        effect_batch_add(&batch, i, hsv);
     }
+    effect_batch_flush(&batch);
     return rgb_matrix_check_finished_leds(led_max);
 }
 
+bool effect_runner_reactive_splash(uint8_t start, effect_params_t* params, reactive_splash_f effect_func) {
+    return effect_runner_reactive_splash_impl(start, params, effect_func, NULL);
+}
+
+// Like effect_runner_reactive_splash(), but hits are skipped for every LED their wavefront doesn't reach
+bool effect_runner_reactive_splash_reach(uint8_t start, effect_params_t* params, reactive_splash_f effect_func, reactive_splash_reach_f reach_func) {
+    return effect_runner_reactive_splash_impl(start, params, effect_func, reach_func);
+}
+
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
@@ -25,22 +25,80 @@
 
 #include <lib/lib8tion/lib8tion.h>
 
+#ifdef RGB_MATRIX_THREADED
+#    ifndef PROTOCOL_CHIBIOS
+#        error "RGB_MATRIX_THREADED is only supported on ChibiOS"
+#    endif
+#    include <ch.h>
+#    ifdef RGB_MATRIX_RENDER_BUDGET
+#        error "RGB_MATRIX_RENDER_BUDGET can't be used with RGB_MATRIX_THREADED, the render thread always renders whole frames"
+#    endif
+#endif
+
 #ifndef RGB_MATRIX_CENTER
 const led_point_t k_rgb_matrix_center = {112, 32};
 #else
 const led_point_t k_rgb_matrix_center = RGB_MATRIX_CENTER;
 #endif
 
-__attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) {
+static RGB default_hsv_to_rgb(HSV hsv) {
     return hsv_to_rgb(hsv);
 }
 
+RGB rgb_matrix_hsv_to_rgb(HSV hsv) __attribute__((weak, alias("default_hsv_to_rgb")));
+
+// Used by the effect runners. Converts one LED at a time where rgb_matrix_hsv_to_rgb() is overridden.
+__attribute__((weak)) void rgb_matrix_hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+    if (rgb_matrix_hsv_to_rgb != default_hsv_to_rgb) {
+        for (uint8_t i = 0; i < count; i++) {
+            rgb[i] = rgb_matrix_hsv_to_rgb(hsv[i]);
+        }
+        return;
+    }
+    hsv_to_rgb_batch(hsv, rgb, count);
+}
+
+#ifndef RGB_MATRIX_DISABLE_GEOMETRY_CACHE
+// Distance and angle of each LED from the center. They only depend on
+// g_led_config, so they are worked out once instead of on every frame.
+led_polar_t g_led_polar[DRIVER_LED_TOTAL];
+#endif
+
+void rgb_matrix_update_geometry(void) {
+#ifndef RGB_MATRIX_DISABLE_GEOMETRY_CACHE
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        int16_t dx           = g_led_config.point[i].x - k_rgb_matrix_center.x;
+        int16_t dy           = g_led_config.point[i].y - k_rgb_matrix_center.y;
+        g_led_polar[i].dist  = sqrt16(dx * dx + dy * dy);
+        g_led_polar[i].angle = atan2_8(dy, dx);
+    }
+#endif
+}
+
+static inline uint8_t rgb_matrix_led_dist(uint8_t i) {
+#ifndef RGB_MATRIX_DISABLE_GEOMETRY_CACHE
+    return g_led_polar[i].dist;
+#else
+    int16_t dx = g_led_config.point[i].x - k_rgb_matrix_center.x;
+    int16_t dy = g_led_config.point[i].y - k_rgb_matrix_center.y;
+    return sqrt16(dx * dx + dy * dy);
+#endif
+}
+
+static inline uint8_t rgb_matrix_led_angle(uint8_t i) {
+#ifndef RGB_MATRIX_DISABLE_GEOMETRY_CACHE
+    return g_led_polar[i].angle;
+#else
+    return atan2_8(g_led_config.point[i].y - k_rgb_matrix_center.y, g_led_config.point[i].x - k_rgb_matrix_center.x);
+#endif
+}
+
 // Generic effect runners
 #include "rgb_matrix_runners.inc"
 
 // ------------------------------------------
 // -----Begin rgb effect includes macros-----
-#define RGB_MATRIX_EFFECT(name)
+#define RGB_MATRIX_EFFECT(name, ...)
 #define RGB_MATRIX_CUSTOM_EFFECT_IMPLS
 
 #include "rgb_matrix_effects.inc"
@@ -85,6 +143,10 @@ __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) {
 #    define RGB_MATRIX_SPD_STEP 16
 #endif
 
+#if defined(RGB_MATRIX_SKIP_STATIC_FRAMES) && !defined(RGB_MATRIX_INDICATOR_DEPENDS)
+#    define RGB_MATRIX_INDICATOR_DEPENDS (RGB_MATRIX_DEPENDS_MODS | RGB_MATRIX_DEPENDS_LAYER | RGB_MATRIX_DEPENDS_LEDS)
+#endif
+
 #if !defined(RGB_MATRIX_STARTUP_MODE)
 #    ifdef ENABLE_RGB_MATRIX_CYCLE_LEFT_RIGHT
 #        define RGB_MATRIX_STARTUP_MODE RGB_MATRIX_CYCLE_LEFT_RIGHT
@@ -113,12 +175,16 @@ __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) {
 // globals
 rgb_config_t rgb_matrix_config; // TODO: would like to prefix this with g_ for global consistancy, do this in another pr
 uint32_t     g_rgb_timer;
+uint16_t     g_rgb_frame_delta; // time between the previous frame and this one in ms
 #ifdef RGB_MATRIX_FRAMEBUFFER_EFFECTS
 uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS] = {{0}};
 #endif // RGB_MATRIX_FRAMEBUFFER_EFFECTS
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 last_hit_t g_last_hit_tracker;
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
+#ifdef RGB_MATRIX_RENDER_BUDGET
+uint8_t g_rgb_slice_size = DRIVER_LED_TOTAL;
+#endif // RGB_MATRIX_RENDER_BUDGET
 
 // internals
 static bool            suspend_state     = false;
@@ -129,6 +195,29 @@ static rgb_task_states rgb_task_state    = SYNCING;
 #if RGB_DISABLE_TIMEOUT > 0
 static uint32_t rgb_anykey_timer;
 #endif // RGB_DISABLE_TIMEOUT > 0
+#ifdef RGB_MATRIX_RENDER_BUDGET
+static uint16_t rgb_led_cost; // average render time per LED in 1/16 us
+#endif // RGB_MATRIX_RENDER_BUDGET
+static uint32_t                 rgb_frame_due; // time the next frame is scheduled for
+static rgb_matrix_frame_stats_t rgb_frame_stats;
+static uint16_t                 rgb_frame_count;
+static uint16_t                 rgb_fps;
+static uint32_t                 rgb_fps_timer;
+#ifdef RGB_MATRIX_SKIP_STATIC_FRAMES
+// config.raw only covers mode and color, speed and flags are compared on their own
+typedef struct {
+    uint32_t    config;
+    uint32_t    layers;
+    uint8_t     speed;
+    led_flags_t flags;
+    uint8_t     effect;
+    uint8_t     mods;
+    uint8_t     leds;
+} rgb_frame_inputs_t;
+
+static rgb_frame_inputs_t rgb_last_inputs;
+static bool               rgb_refresh = true;
+#endif // RGB_MATRIX_SKIP_STATIC_FRAMES
 
 // double buffers
 static uint32_t rgb_timer_buffer;
@@ -314,22 +403,155 @@ static void rgb_task_timers(void) {
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
 }
 
-static void rgb_task_sync(void) {
+/*
+ * Frames are placed on a fixed grid of RGB_MATRIX_FRAME_INTERVAL, and effects
+ * see the time of the grid slot instead of whenever the task got around to
+ * start the frame, so the animation advances in even steps. Slots that have
+ * already passed are dropped rather than rendered late, which keeps the
+ * animation in step with the wall clock when typing slows down the main loop.
+ */
+static uint32_t rgb_task_slots_missed(void) {
+    uint32_t late = rgb_timer_buffer - rgb_frame_due;
+    if (late >= UINT32_MAX / 2) {
+        // started ahead of schedule, e.g. after a mode change
+        return 0;
+    }
+    return late / RGB_MATRIX_FRAME_INTERVAL;
+}
+
+static uint32_t rgb_task_schedule(void) {
+    uint32_t missed = rgb_task_slots_missed();
+    uint32_t slot   = rgb_frame_due + missed * RGB_MATRIX_FRAME_INTERVAL;
+    rgb_frame_stats.frames++;
+    rgb_frame_stats.dropped += missed;
+    rgb_frame_due = slot + RGB_MATRIX_FRAME_INTERVAL;
+    return slot;
+}
+
+#ifdef RGB_MATRIX_SKIP_STATIC_FRAMES
+// Picks the inputs passed to RGB_MATRIX_EFFECT(), effects that don't declare any are rendered on every frame
+#    define RGB_MATRIX_EFFECT_DEPENDS(...) RGB_MATRIX_EFFECT_DEPENDS_(, ##__VA_ARGS__, RGB_MATRIX_DEPENDS_ALWAYS)
+#    define RGB_MATRIX_EFFECT_DEPENDS_(unused, depends, ...) depends
+
+static uint8_t rgb_effect_depends(uint8_t effect) {
+    switch (effect) {
+        case RGB_MATRIX_NONE:
+            return RGB_MATRIX_DEPENDS_NOTHING;
+
+#    define RGB_MATRIX_EFFECT(name, ...) \
+        case RGB_MATRIX_##name:          \
+            return RGB_MATRIX_EFFECT_DEPENDS(__VA_ARGS__);
+#    include "rgb_matrix_effects.inc"
+#    undef RGB_MATRIX_EFFECT
+
+#    if defined(RGB_MATRIX_CUSTOM_KB) || defined(RGB_MATRIX_CUSTOM_USER)
+#        define RGB_MATRIX_EFFECT(name, ...) \
+            case RGB_MATRIX_CUSTOM_##name:   \
+                return RGB_MATRIX_EFFECT_DEPENDS(__VA_ARGS__);
+#        ifdef RGB_MATRIX_CUSTOM_KB
+#            include "rgb_matrix_kb.inc"
+#        endif
+#        ifdef RGB_MATRIX_CUSTOM_USER
+#            include "rgb_matrix_user.inc"
+#        endif
+#        undef RGB_MATRIX_EFFECT
+#    endif
+
+        default: // factory default test pattern
+            return RGB_MATRIX_DEPENDS_ALWAYS;
+    }
+}
+
+/*
+ * Decides whether the next frame would look any different from the last one.
+ * Only the inputs the effect and the indicators depend on are compared, any
+ * change to the configuration always triggers a new frame.
+ */
+static bool rgb_task_needs_frame(uint8_t effect) {
+    uint8_t depends = rgb_effect_depends(effect);
+    if (effect) {
+        depends |= RGB_MATRIX_INDICATOR_DEPENDS;
+    }
+
+    // compared with memcmp, so the padding has to be zero as well
+    rgb_frame_inputs_t inputs;
+    memset(&inputs, 0, sizeof(inputs));
+    inputs.config = rgb_matrix_config.raw;
+    inputs.speed  = rgb_matrix_config.speed;
+    inputs.flags  = rgb_matrix_config.flags;
+    inputs.effect = effect;
+    if (depends & RGB_MATRIX_DEPENDS_MODS) {
+        inputs.mods = get_mods();
+    }
+    if (depends & RGB_MATRIX_DEPENDS_LAYER) {
+        inputs.layers = layer_state | default_layer_state;
+    }
+    if (depends & RGB_MATRIX_DEPENDS_LEDS) {
+        inputs.leds = host_keyboard_led_state().raw;
+    }
+
+    bool changed = memcmp(&inputs, &rgb_last_inputs, sizeof(inputs)) != 0;
+    memcpy(&rgb_last_inputs, &inputs, sizeof(inputs));
+
+    // an effect that hasn't been flushed yet might still be initializing
+    if (changed || rgb_refresh || effect != rgb_last_effect || rgb_matrix_config.enable != rgb_last_enable) {
+        rgb_refresh = false;
+        return true;
+    }
+
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+    // hits keep aging until they drop out of the tracker
+    if ((depends & RGB_MATRIX_DEPENDS_HITS) && last_hit_buffer.count) {
+        return true;
+    }
+#    endif // RGB_MATRIX_KEYREACTIVE_ENABLED
+
+    return (depends & RGB_MATRIX_DEPENDS_ALWAYS) || ((depends & RGB_MATRIX_DEPENDS_TIME) && rgb_matrix_config.speed);
+}
+
+// Moves the schedule past a frame that wasn't needed
+static void rgb_task_skip(void) {
+    uint32_t slots = rgb_task_slots_missed() + 1;
+    rgb_frame_stats.skipped += slots;
+    rgb_frame_due += slots * RGB_MATRIX_FRAME_INTERVAL;
+}
+#endif // RGB_MATRIX_SKIP_STATIC_FRAMES
+
+#ifndef RGB_MATRIX_THREADED
+static void rgb_task_sync(uint8_t effect) {
     eeconfig_flush_rgb_matrix(false);
     // next task
-    if (sync_timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
+    if (timer_expired32(sync_timer_read32(), rgb_frame_due)) {
+#    ifdef RGB_MATRIX_SKIP_STATIC_FRAMES
+        if (!rgb_task_needs_frame(effect)) {
+            rgb_task_skip();
+            return;
+        }
+#    endif // RGB_MATRIX_SKIP_STATIC_FRAMES
+        rgb_task_state = STARTING;
+    }
 }
+#endif
 
 static void rgb_task_start(void) {
     // reset iter
     rgb_effect_params.iter = 0;
 
     // update double buffers
-    g_rgb_timer = rgb_timer_buffer;
+    uint32_t frame_time = rgb_task_schedule();
+    uint32_t delta      = frame_time - g_rgb_timer;
+    g_rgb_frame_delta   = delta > UINT16_MAX ? UINT16_MAX : delta;
+    g_rgb_timer         = frame_time;
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker = last_hit_buffer;
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
 
+#ifdef RGB_MATRIX_RENDER_BUDGET
+    // size the slices of this frame to the budget, they have to stay the same until the frame is done
+    uint32_t slice   = rgb_led_cost ? (uint32_t)RGB_MATRIX_RENDER_BUDGET * 16 / rgb_led_cost : DRIVER_LED_TOTAL;
+    g_rgb_slice_size = slice < 1 ? 1 : (slice > DRIVER_LED_TOTAL ? DRIVER_LED_TOTAL : slice);
+#endif // RGB_MATRIX_RENDER_BUDGET
+
     // next task
     rgb_task_state = RENDERING;
 }
@@ -402,13 +624,55 @@ static void rgb_task_flush(uint8_t effect) {
     // update pwm buffers
     rgb_matrix_update_pwm_buffers();
 
+    rgb_frame_count++;
+    if (timer_elapsed32(rgb_fps_timer) >= 1000) {
+        rgb_fps         = rgb_frame_count;
+        rgb_frame_count = 0;
+        rgb_fps_timer   = timer_read32();
+    }
+
     // next task
     rgb_task_state = SYNCING;
 }
 
-void rgb_matrix_task(void) {
-    rgb_task_timers();
+#ifdef RGB_MATRIX_RENDER_BUDGET
+static void rgb_task_measure(uint8_t iter, uint32_t start) {
+    uint8_t first = g_rgb_slice_size * iter;
+    if (iter == rgb_effect_params.iter || first >= DRIVER_LED_TOTAL) return;
+
+    uint8_t count = DRIVER_LED_TOTAL - first;
+    if (count > g_rgb_slice_size) count = g_rgb_slice_size;
+    uint32_t cost = (timer_read_us32() - start) * 16 / count;
+    if (cost > UINT16_MAX) cost = UINT16_MAX;
+    // average over several slices, a single measurement is only as precise as the timer
+    rgb_led_cost = ((uint32_t)rgb_led_cost * 7 + cost) / 8;
+}
+#endif // RGB_MATRIX_RENDER_BUDGET
 
+void rgb_matrix_get_frame_stats(rgb_matrix_frame_stats_t *stats) {
+#ifdef RGB_MATRIX_THREADED
+    chSysLock();
+#endif
+    *stats = rgb_frame_stats;
+#ifdef RGB_MATRIX_THREADED
+    chSysUnlock();
+#endif
+}
+
+// Makes sure the next frame is rendered, even if nothing the effect depends on has changed
+void rgb_matrix_refresh(void) {
+#ifdef RGB_MATRIX_SKIP_STATIC_FRAMES
+    rgb_refresh = true;
+#endif // RGB_MATRIX_SKIP_STATIC_FRAMES
+}
+
+uint16_t rgb_matrix_get_fps(void) {
+    // nothing has been flushed for a while
+    if (timer_elapsed32(rgb_fps_timer) >= 2000) return 0;
+    return rgb_fps;
+}
+
+static uint8_t rgb_task_effect(void) {
     // Ideally we would also stop sending zeros to the LED driver PWM buffers
     // while suspended and just do a software shutdown. This is a cheap hack for now.
     bool suspend_backlight = suspend_state ||
@@ -417,27 +681,115 @@ void rgb_matrix_task(void) {
 #endif // RGB_DISABLE_TIMEOUT > 0
                              false;
 
-    uint8_t effect = suspend_backlight || !rgb_matrix_config.enable ? 0 : rgb_matrix_config.mode;
+    return suspend_backlight || !rgb_matrix_config.enable ? 0 : rgb_matrix_config.mode;
+}
+
+#ifdef RGB_MATRIX_THREADED
+static THD_WORKING_AREA(waRgbMatrixThread, RGB_MATRIX_THREAD_STACK_SIZE);
+static rgb_matrix_thread_stats_t rgb_thread_stats;
+
+/*
+ * Renders and flushes whole frames at RGB_MATRIX_FRAME_INTERVAL intervals.
+ * The thread runs below the main thread, so it only gets to work while the
+ * main loop waits, for example during matrix scanning.
+ */
+static THD_FUNCTION(RgbMatrixThread, arg) {
+    (void)arg;
+    chRegSetThreadName("rgb_matrix");
+
+    systime_t frame_start = chVTGetSystemTime();
+    while (true) {
+        // Take over the timer and hits from the main thread in one go
+        chSysLock();
+        uint8_t effect = rgb_task_effect();
+#ifdef RGB_MATRIX_SKIP_STATIC_FRAMES
+        if (!rgb_task_needs_frame(effect)) {
+            rgb_task_skip();
+            chSysUnlock();
+            frame_start = chThdSleepUntilWindowed(frame_start, chTimeAddX(frame_start, TIME_MS2I(RGB_MATRIX_FRAME_INTERVAL)));
+            continue;
+        }
+#endif // RGB_MATRIX_SKIP_STATIC_FRAMES
+        rgb_task_start();
+        chSysUnlock();
+
+        systime_t render_start = chVTGetSystemTime();
+        do {
+            rgb_task_render(effect);
+            if (effect) {
+                rgb_matrix_indicators();
+                rgb_matrix_indicators_advanced(&rgb_effect_params);
+            }
+        } while (rgb_task_state == RENDERING);
+
+        if (rgb_task_state == FLUSHING) {
+            rgb_task_flush(effect);
+        }
+        rgb_task_state = SYNCING;
+
+        systime_t     now        = chVTGetSystemTime();
+        sysinterval_t frame_time = chTimeDiffX(render_start, now);
+        rgb_thread_stats.frames++;
+        rgb_thread_stats.frame_time = TIME_I2US(frame_time);
+        if (rgb_thread_stats.frame_time > rgb_thread_stats.max_frame_time) {
+            rgb_thread_stats.max_frame_time = rgb_thread_stats.frame_time;
+        }
+
+        if (chTimeDiffX(frame_start, now) >= TIME_MS2I(RGB_MATRIX_FRAME_INTERVAL)) {
+            // Over budget, start the next frame right away instead of trying to catch up
+            rgb_thread_stats.overruns++;
+            frame_start = now;
+        } else {
+            frame_start = chThdSleepUntilWindowed(frame_start, chTimeAddX(frame_start, TIME_MS2I(RGB_MATRIX_FRAME_INTERVAL)));
+        }
+    }
+}
+
+void rgb_matrix_get_thread_stats(rgb_matrix_thread_stats_t *stats) {
+    chSysLock();
+    *stats = rgb_thread_stats;
+    chSysUnlock();
+}
+
+void rgb_matrix_task(void) {
+    // The render thread copies these under lock, and it can't interrupt the main thread
+    rgb_task_timers();
+    eeconfig_flush_rgb_matrix(false);
+}
+#else
+void rgb_matrix_task(void) {
+    rgb_task_timers();
+
+    uint8_t effect = rgb_task_effect();
 
     switch (rgb_task_state) {
         case STARTING:
             rgb_task_start();
             break;
-        case RENDERING:
+        case RENDERING: {
+#ifdef RGB_MATRIX_RENDER_BUDGET
+            uint8_t  iter  = rgb_effect_params.iter;
+            uint32_t start = timer_read_us32();
+#endif // RGB_MATRIX_RENDER_BUDGET
             rgb_task_render(effect);
             if (effect) {
                 rgb_matrix_indicators();
                 rgb_matrix_indicators_advanced(&rgb_effect_params);
             }
+#ifdef RGB_MATRIX_RENDER_BUDGET
+            rgb_task_measure(iter, start);
+#endif // RGB_MATRIX_RENDER_BUDGET
             break;
+        }
         case FLUSHING:
             rgb_task_flush(effect);
             break;
         case SYNCING:
-            rgb_task_sync();
+            rgb_task_sync(effect);
             break;
     }
 }
+#endif // RGB_MATRIX_THREADED
 
 void rgb_matrix_indicators(void) {
     rgb_matrix_indicators_kb();
@@ -454,9 +806,9 @@ void rgb_matrix_indicators_advanced(effect_params_t *params) {
      * and not sure which would be better. Otherwise, this should be called from
      * rgb_task_render, right before the iter++ line.
      */
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
-    uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * (params->iter - 1);
-    uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;
+#ifdef RGB_MATRIX_LED_SLICE
+    uint8_t min = RGB_MATRIX_LED_SLICE * (params->iter - 1);
+    uint8_t max = min + RGB_MATRIX_LED_SLICE;
     if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
 #else
     uint8_t min = 0;
@@ -472,6 +824,7 @@ __attribute__((weak)) void rgb_matrix_indicators_advanced_user(uint8_t led_min,
 
 void rgb_matrix_init(void) {
     rgb_matrix_driver.init();
+    rgb_matrix_update_geometry();
 
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker.count = 0;
@@ -497,14 +850,26 @@ void rgb_matrix_init(void) {
         eeconfig_update_rgb_matrix_default();
     }
     eeconfig_debug_rgb_matrix(); // display current eeprom values
+
+    rgb_timer_buffer = sync_timer_read32();
+    rgb_frame_due    = rgb_timer_buffer;
+    g_rgb_timer      = rgb_timer_buffer;
+
+#ifdef RGB_MATRIX_THREADED
+    chThdCreateStatic(waRgbMatrixThread, sizeof(waRgbMatrixThread), RGB_MATRIX_THREAD_PRIORITY, RgbMatrixThread, NULL);
+#endif
 }
 
 void rgb_matrix_set_suspend_state(bool state) {
 #ifdef RGB_DISABLE_WHEN_USB_SUSPENDED
+#    ifdef RGB_MATRIX_THREADED
+    // the render thread turns off all LEDs with its next frame
+#    else
     if (state && !suspend_state) { // only run if turning off, and only once
         rgb_task_render(0);        // turn off all LEDs when suspending
         rgb_task_flush(0);         // and actually flash led state to LEDs
     }
+#    endif
     suspend_state = state;
 #endif
 }
@@ -46,23 +46,55 @@
 #    define RGB_MATRIX_LED_FLUSH_LIMIT 16
 #endif
 
+// Time between two frames in ms, frames are rendered on a fixed schedule
+#ifdef RGB_MATRIX_TARGET_FPS
+#    if RGB_MATRIX_TARGET_FPS < 1 || RGB_MATRIX_TARGET_FPS > 1000
+#        error RGB_MATRIX_TARGET_FPS must be between 1 and 1000
+#    endif
+#    define RGB_MATRIX_FRAME_INTERVAL (1000 / (RGB_MATRIX_TARGET_FPS))
+#else
+#    if RGB_MATRIX_LED_FLUSH_LIMIT < 1
+#        error RGB_MATRIX_LED_FLUSH_LIMIT must be at least 1
+#    endif
+#    define RGB_MATRIX_FRAME_INTERVAL RGB_MATRIX_LED_FLUSH_LIMIT
+#endif
+
+#ifdef RGB_MATRIX_THREADED
+#    ifndef RGB_MATRIX_THREAD_STACK_SIZE
+#        define RGB_MATRIX_THREAD_STACK_SIZE 1024
+#    endif
+#    ifndef RGB_MATRIX_THREAD_PRIORITY
+#        define RGB_MATRIX_THREAD_PRIORITY LOWPRIO
+#    endif
+#endif
+
+#ifndef RGB_MATRIX_HSV_BATCH_SIZE
+#    define RGB_MATRIX_HSV_BATCH_SIZE 16
+#endif
+
 #ifndef RGB_MATRIX_LED_PROCESS_LIMIT
 #    define RGB_MATRIX_LED_PROCESS_LIMIT (DRIVER_LED_TOTAL + 4) / 5
 #endif
 
-#if defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
+#if defined(RGB_MATRIX_RENDER_BUDGET)
+#    define RGB_MATRIX_LED_SLICE g_rgb_slice_size
+#elif defined(RGB_MATRIX_LED_PROCESS_LIMIT) && RGB_MATRIX_LED_PROCESS_LIMIT > 0 && RGB_MATRIX_LED_PROCESS_LIMIT < DRIVER_LED_TOTAL
+#    define RGB_MATRIX_LED_SLICE RGB_MATRIX_LED_PROCESS_LIMIT
+#endif
+
+#ifdef RGB_MATRIX_LED_SLICE
 #    if defined(RGB_MATRIX_SPLIT)
 #        define RGB_MATRIX_USE_LIMITS(min, max)                                                   \
-            uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * params->iter;                            \
-            uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;                                     \
+            uint8_t min = RGB_MATRIX_LED_SLICE * params->iter;                                    \
+            uint8_t max = min + RGB_MATRIX_LED_SLICE;                                             \
             if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;                                   \
             uint8_t k_rgb_matrix_split[2] = RGB_MATRIX_SPLIT;                                     \
             if (is_keyboard_left() && (max > k_rgb_matrix_split[0])) max = k_rgb_matrix_split[0]; \
             if (!(is_keyboard_left()) && (min < k_rgb_matrix_split[0])) min = k_rgb_matrix_split[0];
 #    else
-#        define RGB_MATRIX_USE_LIMITS(min, max)                        \
-            uint8_t min = RGB_MATRIX_LED_PROCESS_LIMIT * params->iter; \
-            uint8_t max = min + RGB_MATRIX_LED_PROCESS_LIMIT;          \
+#        define RGB_MATRIX_USE_LIMITS(min, max)                \
+            uint8_t min = RGB_MATRIX_LED_SLICE * params->iter; \
+            uint8_t max = min + RGB_MATRIX_LED_SLICE;          \
             if (max > DRIVER_LED_TOTAL) max = DRIVER_LED_TOTAL;
 #    endif
 #else
@@ -124,7 +156,28 @@ void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue);
 
 void process_rgb_matrix(uint8_t row, uint8_t col, bool pressed);
 
-void rgb_matrix_task(void);
+void     rgb_matrix_task(void);
+uint16_t rgb_matrix_get_fps(void);
+
+typedef struct {
+    uint32_t frames;  // frames that were started
+    uint32_t dropped; // frames that were skipped because the previous one or the main loop ran late
+    uint32_t skipped; // frames that weren't rendered because they would have been the same as the last one
+} rgb_matrix_frame_stats_t;
+
+void rgb_matrix_get_frame_stats(rgb_matrix_frame_stats_t *stats);
+void rgb_matrix_refresh(void);
+
+#ifdef RGB_MATRIX_THREADED
+typedef struct {
+    uint32_t frames;
+    uint32_t overruns;       // frames that took longer than RGB_MATRIX_FRAME_INTERVAL
+    uint32_t frame_time;     // render and flush time of the last frame in us
+    uint32_t max_frame_time; // in us
+} rgb_matrix_thread_stats_t;
+
+void rgb_matrix_get_thread_stats(rgb_matrix_thread_stats_t *stats);
+#endif
 
 // This runs after another backlight effect and replaces
 // colors already set
@@ -137,6 +190,7 @@ void rgb_matrix_indicators_advanced_kb(uint8_t led_min, uint8_t led_max);
 void rgb_matrix_indicators_advanced_user(uint8_t led_min, uint8_t led_max);
 
 void rgb_matrix_init(void);
+void rgb_matrix_update_geometry(void);
 
 void rgb_matrix_reload_from_eeprom(void);
 
@@ -256,10 +310,17 @@ extern const rgb_matrix_driver_t rgb_matrix_driver;
 extern rgb_config_t rgb_matrix_config;
 
 extern uint32_t     g_rgb_timer;
+extern uint16_t     g_rgb_frame_delta;
 extern led_config_t g_led_config;
+#ifdef RGB_MATRIX_RENDER_BUDGET
+extern uint8_t g_rgb_slice_size;
+#endif
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 extern last_hit_t g_last_hit_tracker;
 #endif
 #ifdef RGB_MATRIX_FRAMEBUFFER_EFFECTS
 extern uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS];
 #endif
+#ifndef RGB_MATRIX_DISABLE_GEOMETRY_CACHE
+extern led_polar_t g_led_polar[DRIVER_LED_TOTAL];
+#endif
@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include "rgb_matrix.h"
 
 /* Each driver needs to define the struct
@@ -210,17 +211,27 @@ const rgb_matrix_driver_t rgb_matrix_driver = {
 };
 
 #    elif defined(IS31FL3733)
+#        ifdef I2C_ASYNC_SUPPORTED
+// Refresh all drivers in the background, in one queue of I2C writes
+#            define IS31FL3733_flush_pwm_buffers IS31FL3733_queue_pwm_buffers
+#        else
+#            define IS31FL3733_flush_pwm_buffers IS31FL3733_update_pwm_buffers
+#        endif
+
 static void flush(void) {
-    IS31FL3733_update_pwm_buffers(DRIVER_ADDR_1, 0);
+    IS31FL3733_flush_pwm_buffers(DRIVER_ADDR_1, 0);
 #        if defined(DRIVER_ADDR_2)
-    IS31FL3733_update_pwm_buffers(DRIVER_ADDR_2, 1);
+    IS31FL3733_flush_pwm_buffers(DRIVER_ADDR_2, 1);
 #            if defined(DRIVER_ADDR_3)
-    IS31FL3733_update_pwm_buffers(DRIVER_ADDR_3, 2);
+    IS31FL3733_flush_pwm_buffers(DRIVER_ADDR_3, 2);
 #                if defined(DRIVER_ADDR_4)
-    IS31FL3733_update_pwm_buffers(DRIVER_ADDR_4, 3);
+    IS31FL3733_flush_pwm_buffers(DRIVER_ADDR_4, 3);
 #                endif
 #            endif
 #        endif
+#        ifdef I2C_ASYNC_SUPPORTED
+    IS31FL3733_send_queue();
+#        endif
 }
 
 const rgb_matrix_driver_t rgb_matrix_driver = {
@@ -261,17 +272,27 @@ const rgb_matrix_driver_t rgb_matrix_driver = {
 };
 
 #    elif defined(IS31FLCOMMON)
+#        ifdef I2C_ASYNC_SUPPORTED
+// Refresh all drivers in the background, in one queue of I2C writes
+#            define IS31FL_common_flush_pwm_register IS31FL_common_queue_pwm_register
+#        else
+#            define IS31FL_common_flush_pwm_register IS31FL_common_update_pwm_register
+#        endif
+
 static void flush(void) {
-    IS31FL_common_update_pwm_register(DRIVER_ADDR_1, 0);
+    IS31FL_common_flush_pwm_register(DRIVER_ADDR_1, 0);
 #        if defined(DRIVER_ADDR_2)
-    IS31FL_common_update_pwm_register(DRIVER_ADDR_2, 1);
+    IS31FL_common_flush_pwm_register(DRIVER_ADDR_2, 1);
 #            if defined(DRIVER_ADDR_3)
-    IS31FL_common_update_pwm_register(DRIVER_ADDR_3, 2);
+    IS31FL_common_flush_pwm_register(DRIVER_ADDR_3, 2);
 #                if defined(DRIVER_ADDR_4)
-    IS31FL_common_update_pwm_register(DRIVER_ADDR_4, 3);
+    IS31FL_common_flush_pwm_register(DRIVER_ADDR_4, 3);
 #                endif
 #            endif
 #        endif
+#        ifdef I2C_ASYNC_SUPPORTED
+    IS31FL_common_send_queue();
+#        endif
 }
 
 const rgb_matrix_driver_t rgb_matrix_driver = {
@@ -317,9 +338,9 @@ static void init(void) {
 
 static void flush(void) {
     AW20216_update_pwm_buffers(DRIVER_1_CS, 0);
-#    if defined(DRIVER_2_CS)
+#        if defined(DRIVER_2_CS)
     AW20216_update_pwm_buffers(DRIVER_2_CS, 1);
-#    endif
+#        endif
 }
 
 const rgb_matrix_driver_t rgb_matrix_driver = {
@@ -337,12 +358,18 @@ const rgb_matrix_driver_t rgb_matrix_driver = {
 
 // LED color buffer
 LED_TYPE rgb_matrix_ws2812_array[DRIVER_LED_TOTAL];
+// The strip holds its colors, so an unchanged frame does not need to be sent again
+static bool ws2812_dirty = true;
 
 static void init(void) {}
 
 static void flush(void) {
+    if (!ws2812_dirty) {
+        return;
+    }
     // Assumes use of RGB_DI_PIN
     ws2812_setleds(rgb_matrix_ws2812_array, DRIVER_LED_TOTAL);
+    ws2812_dirty = false;
 }
 
 // Set an led in the buffer to a color
@@ -360,12 +387,16 @@ static inline void setled(int i, uint8_t r, uint8_t g, uint8_t b) {
     }
 #    endif
 
-    rgb_matrix_ws2812_array[i].r = r;
-    rgb_matrix_ws2812_array[i].g = g;
-    rgb_matrix_ws2812_array[i].b = b;
+    LED_TYPE led = {.r = r, .g = g, .b = b};
 #    ifdef RGBW
-    convert_rgb_to_rgbw(&rgb_matrix_ws2812_array[i]);
+    convert_rgb_to_rgbw(&led);
 #    endif
+    if (memcmp(&rgb_matrix_ws2812_array[i], &led, sizeof(led)) == 0) {
+        return;
+    }
+
+    rgb_matrix_ws2812_array[i] = led;
+    ws2812_dirty               = true;
 }
 
 static void setled_all(uint8_t r, uint8_t g, uint8_t b) {
@@ -64,6 +64,11 @@ typedef struct PACKED {
     uint8_t y;
 } led_point_t;
 
+typedef struct PACKED {
+    uint8_t dist;
+    uint8_t angle;
+} led_polar_t;
+
 #define HAS_FLAGS(bits, flags) ((bits & flags) == flags)
 #define HAS_ANY_FLAGS(bits, flags) ((bits & flags) != 0x00)
 
@@ -74,6 +79,15 @@ typedef struct PACKED {
 #define LED_FLAG_KEYLIGHT 0x04
 #define LED_FLAG_INDICATOR 0x08
 
+// Inputs an effect's output depends on, passed to RGB_MATRIX_EFFECT()
+#define RGB_MATRIX_DEPENDS_NOTHING 0x00
+#define RGB_MATRIX_DEPENDS_TIME 0x01 // g_rgb_timer scaled by the speed, static at speed 0
+#define RGB_MATRIX_DEPENDS_HITS 0x02
+#define RGB_MATRIX_DEPENDS_MODS 0x04
+#define RGB_MATRIX_DEPENDS_LAYER 0x08
+#define RGB_MATRIX_DEPENDS_LEDS 0x10 // host keyboard LED state
+#define RGB_MATRIX_DEPENDS_ALWAYS 0x80
+
 #define NO_LED 255
 
 typedef struct PACKED {
@@ -132,6 +132,10 @@ rgblight_segment_t const *const *rgblight_layers = NULL;
 
 rgblight_ranges_t rgblight_ranges = {0, RGBLED_NUM, 0, RGBLED_NUM, RGBLED_NUM};
 
+// span of led[] changed since the last rgblight_set() or rgblight_flush(), empty if start >= end
+static uint8_t dirty_start = RGBLED_NUM;
+static uint8_t dirty_end   = 0;
+
 void rgblight_set_clipping_range(uint8_t start_pos, uint8_t num_leds) {
     rgblight_ranges.clipping_start_pos = start_pos;
     rgblight_ranges.clipping_num_leds  = num_leds;
@@ -168,6 +172,26 @@ void setrgb(uint8_t r, uint8_t g, uint8_t b, LED_TYPE *led1) {
 #endif
 }
 
+void rgblight_mark_dirty(uint8_t start, uint8_t num_leds) {
+    uint8_t end = MIN(start + num_leds, RGBLED_NUM);
+    if (start >= end) {
+        return;
+    }
+    if (start < dirty_start) {
+        dirty_start = start;
+    }
+    if (end > dirty_end) {
+        dirty_end = end;
+    }
+}
+
+void rgblight_set_led(uint8_t index, LED_TYPE color) {
+    if (memcmp(&led[index], &color, sizeof(LED_TYPE)) != 0) {
+        led[index] = color;
+        rgblight_mark_dirty(index, 1);
+    }
+}
+
 void rgblight_check_config(void) {
     /* Add some out of bound checks for RGB light config */
 
@@ -647,15 +671,12 @@ void rgblight_setrgb(uint8_t r, uint8_t g, uint8_t b) {
         return;
     }
 
+    LED_TYPE color;
+    setrgb(r, g, b, &color);
     for (uint8_t i = rgblight_ranges.effect_start_pos; i < rgblight_ranges.effect_end_pos; i++) {
-        led[i].r = r;
-        led[i].g = g;
-        led[i].b = b;
-#ifdef RGBW
-        led[i].w = 0;
-#endif
+        rgblight_set_led(i, color);
     }
-    rgblight_set();
+    rgblight_flush();
 }
 
 void rgblight_setrgb_at(uint8_t r, uint8_t g, uint8_t b, uint8_t index) {
@@ -663,13 +684,10 @@ void rgblight_setrgb_at(uint8_t r, uint8_t g, uint8_t b, uint8_t index) {
         return;
     }
 
-    led[index].r = r;
-    led[index].g = g;
-    led[index].b = b;
-#ifdef RGBW
-    led[index].w = 0;
-#endif
-    rgblight_set();
+    LED_TYPE color;
+    setrgb(r, g, b, &color);
+    rgblight_set_led(index, color);
+    rgblight_flush();
 }
 
 void rgblight_sethsv_at(uint8_t hue, uint8_t sat, uint8_t val, uint8_t index) {
@@ -699,15 +717,12 @@ void rgblight_setrgb_range(uint8_t r, uint8_t g, uint8_t b, uint8_t start, uint8
         return;
     }
 
+    LED_TYPE color;
+    setrgb(r, g, b, &color);
     for (uint8_t i = start; i < end; i++) {
-        led[i].r = r;
-        led[i].g = g;
-        led[i].b = b;
-#ifdef RGBW
-        led[i].w = 0;
-#endif
+        rgblight_set_led(i, color);
     }
-    rgblight_set();
+    rgblight_flush();
     wait_ms(1);
 }
 
@@ -741,13 +756,18 @@ void rgblight_sethsv_slave(uint8_t hue, uint8_t sat, uint8_t val) {
 
 #ifdef RGBLIGHT_LAYERS
 void rgblight_set_layer_state(uint8_t layer, bool enabled) {
-    rgblight_layer_mask_t mask = (rgblight_layer_mask_t)1 << layer;
+    rgblight_layer_mask_t mask     = (rgblight_layer_mask_t)1 << layer;
+    rgblight_layer_mask_t previous = rgblight_status.enabled_layer_mask;
     if (enabled) {
         rgblight_status.enabled_layer_mask |= mask;
     } else {
         rgblight_status.enabled_layer_mask &= ~mask;
     }
     RGBLIGHT_SPLIT_SET_CHANGE_LAYERS;
+    // The next effect frame may not change any LED itself, the layers (and blinks) still have to show up
+    if (rgblight_status.enabled_layer_mask != previous) {
+        rgblight_mark_dirty(0, RGBLED_NUM);
+    }
     // Static modes don't have a ticker running to update the LEDs
     if (rgblight_status.timer_enabled == false) {
         rgblight_mode_noeeprom(rgblight_config.mode);
@@ -884,11 +904,22 @@ __attribute__((weak)) void rgblight_call_driver(LED_TYPE *start_led, uint8_t num
     ws2812_setleds(start_led, num_leds);
 }
 
+// the WS2812 drivers rebuild their whole frame buffer from what they are given, so they always get the whole chain
+__attribute__((weak)) void rgblight_call_driver_span(LED_TYPE *start_led, uint8_t num_leds, uint8_t span_start, uint8_t span_end) {
+    rgblight_call_driver(start_led, num_leds);
+}
+
 #ifndef RGBLIGHT_CUSTOM_DRIVER
 
-void rgblight_set(void) {
+// sends the clipping range, or with partial, only if part of it is in the dirty span
+static void rgblight_send(bool partial) {
     LED_TYPE *start_led;
-    uint8_t   num_leds = rgblight_ranges.clipping_num_leds;
+    uint8_t   num_leds   = rgblight_ranges.clipping_num_leds;
+    uint8_t   span_start = dirty_start;
+    uint8_t   span_end   = dirty_end;
+
+    dirty_start = RGBLED_NUM;
+    dirty_end   = 0;
 
     if (!rgblight_config.enable) {
         for (uint8_t i = rgblight_ranges.effect_start_pos; i < rgblight_ranges.effect_end_pos; i++) {
@@ -915,10 +946,19 @@ void rgblight_set(void) {
 
 #    ifdef RGBLIGHT_LED_MAP
     LED_TYPE led0[RGBLED_NUM];
+    uint8_t  mapped_start = RGBLED_NUM;
+    uint8_t  mapped_end   = 0;
     for (uint8_t i = 0; i < RGBLED_NUM; i++) {
-        led0[i] = led[pgm_read_byte(&led_map[i])];
+        uint8_t index = pgm_read_byte(&led_map[i]);
+        led0[i]       = led[index];
+        if (index >= span_start && index < span_end) {
+            mapped_start = MIN(mapped_start, i);
+            mapped_end   = i + 1;
+        }
     }
-    start_led = led0 + rgblight_ranges.clipping_start_pos;
+    span_start = mapped_start;
+    span_end   = mapped_end;
+    start_led  = led0 + rgblight_ranges.clipping_start_pos;
 #    else
     start_led = led + rgblight_ranges.clipping_start_pos;
 #    endif
@@ -928,7 +968,44 @@ void rgblight_set(void) {
         convert_rgb_to_rgbw(&start_led[i]);
     }
 #    endif
-    rgblight_call_driver(start_led, num_leds);
+
+    if (!partial) {
+        rgblight_call_driver(start_led, num_leds);
+        return;
+    }
+
+    // clip the span, relative to start_led
+    span_start = MAX(span_start, rgblight_ranges.clipping_start_pos) - rgblight_ranges.clipping_start_pos;
+    span_end   = MIN(span_end, rgblight_ranges.clipping_start_pos + num_leds);
+    if (span_end <= rgblight_ranges.clipping_start_pos + span_start) {
+        return;
+    }
+    rgblight_call_driver_span(start_led, num_leds, span_start, span_end - rgblight_ranges.clipping_start_pos);
+}
+
+void rgblight_set(void) {
+    rgblight_send(false);
+}
+
+void rgblight_flush(void) {
+#    ifdef RGBW
+    // the conversion to RGBW is done in place, so led[] can't be compared to what the effects write
+    rgblight_send(false);
+#    else
+    if (!rgblight_config.enable) {
+        rgblight_send(false);
+    } else if (dirty_start < dirty_end) {
+        rgblight_send(true);
+    }
+#    endif
+}
+#else
+void rgblight_flush(void) {
+    if (dirty_start < dirty_end) {
+        dirty_start = RGBLED_NUM;
+        dirty_end   = 0;
+        rgblight_set();
+    }
 }
 #endif
 
@@ -952,6 +1029,7 @@ void rgblight_update_sync(rgblight_syncinfo_t *syncinfo, bool write_to_eeprom) {
 #    ifdef RGBLIGHT_LAYERS
     if (syncinfo->status.change_flags & RGBLIGHT_STATUS_CHANGE_LAYERS) {
         rgblight_status.enabled_layer_mask = syncinfo->status.enabled_layer_mask;
+        rgblight_mark_dirty(0, RGBLED_NUM);
     }
 #    endif
     if (syncinfo->status.change_flags & RGBLIGHT_STATUS_CHANGE_MODE) {
@@ -1190,14 +1268,15 @@ void rgblight_effect_rainbow_mood(animation_status_t *anim) {
 __attribute__((weak)) const uint8_t RGBLED_RAINBOW_SWIRL_INTERVALS[] PROGMEM = {100, 50, 20};
 
 void rgblight_effect_rainbow_swirl(animation_status_t *anim) {
-    uint8_t hue;
-    uint8_t i;
+    uint8_t  hue  = anim->current_hue;
+    uint8_t  step = RGBLIGHT_RAINBOW_SWIRL_RANGE / rgblight_ranges.effect_num_leds;
+    LED_TYPE color;
 
-    for (i = 0; i < rgblight_ranges.effect_num_leds; i++) {
-        hue = (RGBLIGHT_RAINBOW_SWIRL_RANGE / rgblight_ranges.effect_num_leds * i + anim->current_hue);
-        sethsv(hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[i + rgblight_ranges.effect_start_pos]);
+    for (uint8_t i = rgblight_ranges.effect_start_pos; i < rgblight_ranges.effect_end_pos; i++, hue += step) {
+        sethsv(hue, rgblight_config.sat, rgblight_config.val, &color);
+        rgblight_set_led(i, color);
     }
-    rgblight_set();
+    rgblight_flush();
 
     if (anim->delta % 2) {
         anim->current_hue++;
@@ -1232,13 +1311,7 @@ void rgblight_effect_snake(animation_status_t *anim) {
 #    endif
 
     for (i = 0; i < rgblight_ranges.effect_num_leds; i++) {
-        LED_TYPE *ledp = led + i + rgblight_ranges.effect_start_pos;
-        ledp->r        = 0;
-        ledp->g        = 0;
-        ledp->b        = 0;
-#    ifdef RGBW
-        ledp->w = 0;
-#    endif
+        LED_TYPE color = {0};
         for (j = 0; j < RGBLIGHT_EFFECT_SNAKE_LENGTH; j++) {
             k = pos + j * increment;
             if (k > RGBLED_NUM) {
@@ -1248,11 +1321,12 @@ void rgblight_effect_snake(animation_status_t *anim) {
                 k = k + rgblight_ranges.effect_num_leds;
             }
             if (i == k) {
-                sethsv(rgblight_config.hue, rgblight_config.sat, (uint8_t)(rgblight_config.val * (RGBLIGHT_EFFECT_SNAKE_LENGTH - j) / RGBLIGHT_EFFECT_SNAKE_LENGTH), ledp);
+                sethsv(rgblight_config.hue, rgblight_config.sat, (uint8_t)(rgblight_config.val * (RGBLIGHT_EFFECT_SNAKE_LENGTH - j) / RGBLIGHT_EFFECT_SNAKE_LENGTH), &color);
             }
         }
+        rgblight_set_led(i + rgblight_ranges.effect_start_pos, color);
     }
-    rgblight_set();
+    rgblight_flush();
     if (increment == 1) {
         if (pos - 1 < 0) {
             pos = rgblight_ranges.effect_num_leds - 1;
@@ -1282,6 +1356,7 @@ void rgblight_effect_knight(animation_status_t *anim) {
     static int8_t high_bound = RGBLIGHT_EFFECT_KNIGHT_LENGTH - 1;
     static int8_t increment  = 1;
     uint8_t       i, cur;
+    LED_TYPE      lit, off = {0};
 
 #    if defined(RGBLIGHT_SPLIT) && !defined(RGBLIGHT_SPLIT_NO_ANIMATION_SYNC)
     if (anim->pos == 0) { // restart signal
@@ -1291,31 +1366,16 @@ void rgblight_effect_knight(animation_status_t *anim) {
         increment  = 1;
     }
 #    endif
-    // Set all the LEDs to 0
-    for (i = rgblight_ranges.effect_start_pos; i < rgblight_ranges.effect_end_pos; i++) {
-        led[i].r = 0;
-        led[i].g = 0;
-        led[i].b = 0;
-#    ifdef RGBW
-        led[i].w = 0;
-#    endif
-    }
-    // Determine which LEDs should be lit up
-    for (i = 0; i < RGBLIGHT_EFFECT_KNIGHT_LED_NUM; i++) {
-        cur = (i + RGBLIGHT_EFFECT_KNIGHT_OFFSET) % rgblight_ranges.effect_num_leds + rgblight_ranges.effect_start_pos;
-
-        if (i >= low_bound && i <= high_bound) {
-            sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[cur]);
-        } else {
-            led[cur].r = 0;
-            led[cur].g = 0;
-            led[cur].b = 0;
-#    ifdef RGBW
-            led[cur].w = 0;
-#    endif
+    sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, &lit);
+    // Each LED shows the last knight position that lands on it, or is off if there is none
+    for (cur = 0; cur < rgblight_ranges.effect_num_leds; cur++) {
+        i = (cur + rgblight_ranges.effect_num_leds - RGBLIGHT_EFFECT_KNIGHT_OFFSET % rgblight_ranges.effect_num_leds) % rgblight_ranges.effect_num_leds;
+        if (i < RGBLIGHT_EFFECT_KNIGHT_LED_NUM) {
+            i += (RGBLIGHT_EFFECT_KNIGHT_LED_NUM - 1 - i) / rgblight_ranges.effect_num_leds * rgblight_ranges.effect_num_leds;
         }
+        rgblight_set_led(cur + rgblight_ranges.effect_start_pos, (i < RGBLIGHT_EFFECT_KNIGHT_LED_NUM && i >= low_bound && i <= high_bound) ? lit : off);
     }
-    rgblight_set();
+    rgblight_flush();
 
     // Move from low_bound to high_bound changing the direction we increment each
     // time a boundary is hit.
@@ -1355,11 +1415,13 @@ void rgblight_effect_christmas(animation_status_t *anim) {
     // Additionally, these interpolated colors get shown with a slightly darker value, to make them less prominent than the main colors.
     val = 255 - (3 * (hue < hue_green / 2 ? hue : hue_green - hue) / 2);
 
+    LED_TYPE colors[2];
+    sethsv(hue, rgblight_config.sat, val, &colors[1]);
+    sethsv(hue_green - hue, rgblight_config.sat, val, &colors[0]);
     for (i = 0; i < rgblight_ranges.effect_num_leds; i++) {
-        uint8_t local_hue = (i / RGBLIGHT_EFFECT_CHRISTMAS_STEP) % 2 ? hue : hue_green - hue;
-        sethsv(local_hue, rgblight_config.sat, val, (LED_TYPE *)&led[i + rgblight_ranges.effect_start_pos]);
+        rgblight_set_led(i + rgblight_ranges.effect_start_pos, colors[(i / RGBLIGHT_EFFECT_CHRISTMAS_STEP) % 2]);
     }
-    rgblight_set();
+    rgblight_flush();
 
     if (anim->pos == 0) {
         increment = 1;
@@ -1403,17 +1465,14 @@ void rgblight_effect_rgbtest(animation_status_t *anim) {
 
 #ifdef RGBLIGHT_EFFECT_ALTERNATING
 void rgblight_effect_alternating(animation_status_t *anim) {
+    LED_TYPE on, off;
+    sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, &on);
+    sethsv(rgblight_config.hue, rgblight_config.sat, 0, &off);
     for (int i = 0; i < rgblight_ranges.effect_num_leds; i++) {
-        LED_TYPE *ledp = led + i + rgblight_ranges.effect_start_pos;
-        if (i < rgblight_ranges.effect_num_leds / 2 && anim->pos) {
-            sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, ledp);
-        } else if (i >= rgblight_ranges.effect_num_leds / 2 && !anim->pos) {
-            sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, ledp);
-        } else {
-            sethsv(rgblight_config.hue, rgblight_config.sat, 0, ledp);
-        }
+        bool first_half = i < rgblight_ranges.effect_num_leds / 2;
+        rgblight_set_led(i + rgblight_ranges.effect_start_pos, first_half == (bool)anim->pos ? on : off);
     }
-    rgblight_set();
+    rgblight_flush();
     anim->pos = (anim->pos + 1) % 2;
 }
 #endif
@@ -1475,10 +1534,11 @@ void rgblight_effect_twinkle(animation_status_t *anim) {
             // This LED is off, and was NOT selected to start brightening
         }
 
-        LED_TYPE *ledp = led + i + rgblight_ranges.effect_start_pos;
-        sethsv(c->h, c->s, c->v, ledp);
+        LED_TYPE color;
+        sethsv(c->h, c->s, c->v, &color);
+        rgblight_set_led(i + rgblight_ranges.effect_start_pos, color);
     }
 
-    rgblight_set();
+    rgblight_flush();
 }
 #endif
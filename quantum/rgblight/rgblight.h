@@ -276,6 +276,13 @@ void setrgb(uint8_t r, uint8_t g, uint8_t b, LED_TYPE *led1);
 
 /* === Low level Functions === */
 void rgblight_set(void);
+/*   only sends the LEDs changed through rgblight_set_led since the last send */
+void rgblight_flush(void);
+void rgblight_set_led(uint8_t index, LED_TYPE color);
+void rgblight_mark_dirty(uint8_t start, uint8_t num_leds); // for writes straight to led[]
+/*   driver hooks, span_start and span_end are relative to start_led */
+void rgblight_call_driver(LED_TYPE *start_led, uint8_t num_leds);
+void rgblight_call_driver_span(LED_TYPE *start_led, uint8_t num_leds, uint8_t span_start, uint8_t span_end);
 void rgblight_set_clipping_range(uint8_t start_pos, uint8_t num_leds);
 
 /* === Effects and Animations Functions === */